@@ -0,0 +1,81 @@
+#include <benchmark/benchmark.h>
+
+#include "phylopp/Consensor/bitset.h"
+#include "phylopp/Generator/RandomGenerator.h"
+
+static Consensus::bitset randomBitset(Generator::RandomGenerator& random, size_t size)
+{
+    Consensus::bitset b(size);
+    for (size_t i = 0; i < size; i++)
+    {
+        if (random.nextIndex(2) == 1)
+            b.set(i);
+    }
+    return b;
+}
+
+static void BM_BitsetAnd(benchmark::State& state)
+{
+    Generator::RandomGenerator random;
+    Consensus::bitset a = randomBitset(random, state.range(0));
+    const Consensus::bitset b = randomBitset(random, state.range(0));
+
+    while (state.KeepRunning())
+    {
+        a &= b;
+        benchmark::DoNotOptimize(a);
+    }
+}
+BENCHMARK(BM_BitsetAnd)->Range(64, 1 << 16);
+
+static void BM_BitsetOr(benchmark::State& state)
+{
+    Generator::RandomGenerator random;
+    Consensus::bitset a = randomBitset(random, state.range(0));
+    const Consensus::bitset b = randomBitset(random, state.range(0));
+
+    while (state.KeepRunning())
+    {
+        a |= b;
+        benchmark::DoNotOptimize(a);
+    }
+}
+BENCHMARK(BM_BitsetOr)->Range(64, 1 << 16);
+
+static void BM_BitsetEquals(benchmark::State& state)
+{
+    Generator::RandomGenerator random;
+    const Consensus::bitset a = randomBitset(random, state.range(0));
+    const Consensus::bitset b(a);
+
+    while (state.KeepRunning())
+        benchmark::DoNotOptimize(a == b);
+}
+BENCHMARK(BM_BitsetEquals)->Range(64, 1 << 16);
+
+static void BM_BitsetShift(benchmark::State& state)
+{
+    Generator::RandomGenerator random;
+    Consensus::bitset a = randomBitset(random, state.range(0));
+
+    while (state.KeepRunning())
+    {
+        a <<= 3;
+        a >>= 3;
+        benchmark::DoNotOptimize(a);
+    }
+}
+BENCHMARK(BM_BitsetShift)->Range(64, 1 << 16);
+
+static void BM_BitsetCopy(benchmark::State& state)
+{
+    Generator::RandomGenerator random;
+    const Consensus::bitset a = randomBitset(random, state.range(0));
+
+    while (state.KeepRunning())
+    {
+        Consensus::bitset copy(a);
+        benchmark::DoNotOptimize(copy);
+    }
+}
+BENCHMARK(BM_BitsetCopy)->Range(64, 1 << 16);
@@ -0,0 +1,115 @@
+#include <benchmark/benchmark.h>
+
+#include "phylopp/Domain/ITreeCollection.h"
+#include "phylopp/Domain/LocationAspect.h"
+#include "phylopp/Generator/TreeGenerator.h"
+#include "phylopp/Generator/LocationGenerator.h"
+
+typedef Locations::LocationAspect<Domain::Node> BenchmarkNode;
+
+static const size_t LOOKUPS = 4096;
+
+static void randomIds(Generator::RandomGenerator& random, size_t locations, std::vector<Locations::LocationId>& ids)
+{
+    ids.resize(LOOKUPS);
+    for (size_t i = 0; i < LOOKUPS; i++)
+        ids[i] = Locations::LocationId(random.nextIndex(locations) + 1);
+}
+
+static void BM_DistanceById(benchmark::State& state)
+{
+    const size_t locations = state.range(0);
+    Generator::RandomGenerator random;
+    Locations::LocationManager locationManager;
+    Generator::LocationGenerator().generate(locations, locations, locationManager);
+
+    std::vector<Locations::LocationId> from, to;
+    randomIds(random, locations, from);
+    randomIds(random, locations, to);
+
+    while (state.KeepRunning())
+    {
+        Locations::Distance sum = 0;
+        for (size_t i = 0; i < LOOKUPS; i++)
+            sum += locationManager.distance(from[i], to[i]);
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(state.iterations() * LOOKUPS);
+}
+BENCHMARK(BM_DistanceById)->Range(16, 4096);
+
+static void BM_DistanceBatch(benchmark::State& state)
+{
+    const size_t locations = state.range(0);
+    Generator::RandomGenerator random;
+    Locations::LocationManager locationManager;
+    Generator::LocationGenerator().generate(locations, locations, locationManager);
+
+    std::vector<Locations::LocationId> from, to;
+    randomIds(random, locations, from);
+    randomIds(random, locations, to);
+    std::vector<Locations::Distance> result(LOOKUPS);
+
+    while (state.KeepRunning())
+    {
+        locationManager.distances(&from[0], &to[0], LOOKUPS, &result[0]);
+        benchmark::DoNotOptimize(result[0]);
+    }
+
+    state.SetItemsProcessed(state.iterations() * LOOKUPS);
+}
+BENCHMARK(BM_DistanceBatch)->Range(16, 4096);
+
+// Node lookups resolve the location through the node name
+static void BM_DistanceByNode(benchmark::State& state)
+{
+    const size_t leaves = state.range(0);
+    Locations::LocationManager locationManager;
+    Generator::LocationGenerator().generate(leaves, 100, locationManager);
+
+    Domain::ITreeCollection<BenchmarkNode> trees;
+    Domain::ITree<BenchmarkNode>* const tree = trees.addTree();
+    Generator::TreeGenerator<BenchmarkNode>().generateTree(tree, Generator::YuleModel, leaves);
+    std::vector<const BenchmarkNode*> nodes;
+    tree->getLeaves(nodes);
+
+    while (state.KeepRunning())
+    {
+        Locations::Distance sum = 0;
+        for (size_t i = 1; i < nodes.size(); i++)
+            sum += locationManager.distance(
+                       static_cast<const Domain::Node*>(nodes[i - 1]),
+                       static_cast<const Domain::Node*>(nodes[i]));
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(state.iterations() * (leaves - 1));
+}
+BENCHMARK(BM_DistanceByNode)->Range(1000, 100000);
+
+// Same as above, with the location ids already cached in the nodes
+static void BM_DistanceByCachedNode(benchmark::State& state)
+{
+    const size_t leaves = state.range(0);
+    Locations::LocationManager locationManager;
+    Generator::LocationGenerator().generate(leaves, 100, locationManager);
+
+    Domain::ITreeCollection<BenchmarkNode> trees;
+    Domain::ITree<BenchmarkNode>* const tree = trees.addTree();
+    Generator::TreeGenerator<BenchmarkNode>().generateTree(tree, Generator::YuleModel, leaves);
+    Locations::resolveLocationIds(tree, locationManager);
+    std::vector<const BenchmarkNode*> nodes;
+    tree->getLeaves(nodes);
+
+    while (state.KeepRunning())
+    {
+        Locations::Distance sum = 0;
+        for (size_t i = 1; i < nodes.size(); i++)
+            sum += locationManager.distanceByCachedId(nodes[i - 1], nodes[i]);
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(state.iterations() * (leaves - 1));
+}
+BENCHMARK(BM_DistanceByCachedNode)->Range(1000, 100000);
@@ -0,0 +1,40 @@
+#include <cstdio>
+#include <benchmark/benchmark.h>
+
+#include "phylopp/Domain/ITreeCollection.h"
+#include "phylopp/Domain/LocationAspect.h"
+#include "phylopp/DataSource/NewickParser.h"
+#include "phylopp/Generator/TreeGenerator.h"
+#include "phylopp/Generator/LocationGenerator.h"
+
+typedef Locations::LocationAspect<Domain::Node> BenchmarkNode;
+
+// Load time must depend on the tree only, not on the size of the manager
+static void BM_NewickParserLoad(benchmark::State& state)
+{
+    const size_t leaves = state.range(0);
+    const size_t locations = state.range(1);
+    const std::string fname = "benchmark_tree.nwk";
+
+    Generator::TreeGenerator<BenchmarkNode>().saveTrees(fname, Generator::BalancedModel, leaves, 1);
+
+    Locations::LocationManager locationManager;
+    Generator::LocationGenerator().generate(leaves, locations, locationManager);
+
+    NewickParser<BenchmarkNode> parser;
+
+    while (state.KeepRunning())
+    {
+        Domain::ITreeCollection<BenchmarkNode> trees;
+        parser.loadNewickFile(fname, locationManager, trees);
+        benchmark::DoNotOptimize(trees.elementAt(0));
+    }
+
+    state.SetItemsProcessed(state.iterations() * leaves);
+    std::remove(fname.c_str());
+}
+BENCHMARK(BM_NewickParserLoad)
+->Args({1000, 10})->Args({1000, 1000})
+->Args({10000, 10})->Args({10000, 1000})
+->Args({100000, 1000})
+->Unit(benchmark::kMillisecond);
@@ -0,0 +1,42 @@
+#include <benchmark/benchmark.h>
+
+#include "phylopp/Domain/ITreeCollection.h"
+#include "phylopp/Domain/LocationAspect.h"
+#include "phylopp/Comparison/RobinsonFoulds.h"
+#include "phylopp/Generator/TreeGenerator.h"
+#include "phylopp/Generator/LocationGenerator.h"
+
+typedef Locations::LocationAspect<Domain::Node> BenchmarkNode;
+
+// Replicates share most of their splits, as in a real analysis
+static const size_t SPR_MOVES = 5;
+
+// All the pairwise distances among t trees over the same n taxa
+static void BM_RobinsonFouldsMatrix(benchmark::State& state)
+{
+    const size_t trees = state.range(0);
+    const size_t taxa = state.range(1);
+
+    Locations::LocationManager locationManager;
+    Generator::LocationGenerator().generate(taxa, 10, locationManager);
+
+    Domain::ITreeCollection<BenchmarkNode> collection;
+    Generator::TreeGenerator<BenchmarkNode>().generateTrees(collection, Generator::YuleModel, taxa, trees, SPR_MOVES);
+
+    Comparison::RobinsonFoulds<BenchmarkNode> comparer(locationManager);
+    Locations::DistanceMatrix unweighted;
+    Locations::DistanceMatrix weighted;
+
+    while (state.KeepRunning())
+    {
+        comparer.setTrees(collection);
+        comparer.distances(unweighted, weighted);
+        benchmark::DoNotOptimize(unweighted.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * trees * (trees - 1) / 2);
+}
+BENCHMARK(BM_RobinsonFouldsMatrix)
+->Args({100, 64})->Args({100, 512})
+->Args({1000, 64})->Args({1000, 512})
+->Unit(benchmark::kMillisecond);
@@ -0,0 +1,97 @@
+#include <benchmark/benchmark.h>
+
+#include "phylopp/Domain/ITreeCollection.h"
+#include "phylopp/Domain/LocationAspect.h"
+#include "phylopp/Consensor/ConsensorAspect.h"
+#include "phylopp/Consensor/StrictConsensor.h"
+#include "phylopp/Consensor/IncrementalConsensor.h"
+#include "phylopp/Generator/TreeGenerator.h"
+#include "phylopp/Generator/LocationGenerator.h"
+
+typedef Consensus::ConsensorAspect<Locations::LocationAspect<Domain::Node> > BenchmarkNode;
+
+template <class Node>
+class BenchmarkObserver
+{
+public:
+    void onStart(const Domain::ITreeCollection<Node>& /*trees*/)
+    {}
+    void onInclude(Node* /*node*/, const Consensus::bitset& /*cluster*/)
+    {}
+    void onExclude(Node* /*node*/, const Consensus::bitset& /*cluster*/)
+    {}
+    void onEnd(Domain::ITree<Node>* /*consensed*/)
+    {}
+};
+
+namespace Consensus
+{
+template <class Node>
+struct ObserverTraits<BenchmarkObserver<Node> > : DefaultObserverTraits
+{
+    static const bool wants_cluster_events = false;
+};
+}
+
+// Replicates share most of their clusters, as in a real analysis
+static const size_t SPR_MOVES = 5;
+
+// t trees over the same n taxa
+static void BM_StrictConsensus(benchmark::State& state)
+{
+    const size_t trees = state.range(0);
+    const size_t taxa = state.range(1);
+
+    Locations::LocationManager locationManager;
+    Generator::LocationGenerator().generate(taxa, 10, locationManager);
+
+    Domain::ITreeCollection<BenchmarkNode> collection;
+    Generator::TreeGenerator<BenchmarkNode>().generateTrees(collection, Generator::YuleModel, taxa, trees, SPR_MOVES);
+
+    BenchmarkObserver<BenchmarkNode> observer;
+    Consensus::StrictConsensor<BenchmarkNode, BenchmarkObserver<BenchmarkNode> > consensor;
+
+    while (state.KeepRunning())
+    {
+        Domain::ITree<BenchmarkNode>* const consensed =
+            consensor.consensus(collection, observer, locationManager);
+        benchmark::DoNotOptimize(consensed);
+        delete consensed;
+    }
+
+    state.SetItemsProcessed(state.iterations() * trees * taxa);
+}
+BENCHMARK(BM_StrictConsensus)
+->Args({10, 64})->Args({10, 512})
+->Args({100, 64})->Args({100, 512})
+->Unit(benchmark::kMillisecond);
+
+// Adding t trees over the same n taxa to an incremental consensus
+static void BM_IncrementalConsensus(benchmark::State& state)
+{
+    const size_t trees = state.range(0);
+    const size_t taxa = state.range(1);
+
+    Locations::LocationManager locationManager;
+    Generator::LocationGenerator().generate(taxa, 10, locationManager);
+
+    Domain::ITreeCollection<BenchmarkNode> collection;
+    Generator::TreeGenerator<BenchmarkNode>().generateTrees(collection, Generator::YuleModel, taxa, trees, SPR_MOVES);
+
+    while (state.KeepRunning())
+    {
+        Consensus::IncrementalConsensor<BenchmarkNode> consensor(locationManager, Consensus::MajorityRule);
+        for (Domain::ITreeCollection<BenchmarkNode>::iterator it = collection.getIterator(); !it.end(); it.next())
+            consensor.addTree(it.get());
+
+        Domain::ITree<BenchmarkNode>* const consensed = consensor.majorityConsensus();
+        benchmark::DoNotOptimize(consensed);
+        delete consensed;
+    }
+
+    state.SetItemsProcessed(state.iterations() * trees * taxa);
+}
+BENCHMARK(BM_IncrementalConsensus)
+->Args({10, 64})->Args({10, 512})
+->Args({100, 64})->Args({100, 512})
+->Unit(benchmark::kMillisecond);
@@ -0,0 +1,83 @@
+#include <benchmark/benchmark.h>
+
+#include "phylopp/Domain/ITreeCollection.h"
+#include "phylopp/Traversal/Traverser.h"
+#include "phylopp/Generator/TreeGenerator.h"
+
+typedef Domain::Node BenchmarkNode;
+
+struct AlwaysTruePredicate
+{
+    bool operator()(BenchmarkNode* /*node*/) const
+    {
+        return true;
+    }
+};
+
+class CountAction
+{
+public:
+    CountAction() :
+        count(0)
+    {}
+
+    VisitAction visitNode(BenchmarkNode* /*node*/)
+    {
+        ++count;
+        return ContinueTraversing;
+    }
+
+    size_t count;
+};
+
+typedef Traversal::Traverser<BenchmarkNode, CountAction, AlwaysTruePredicate> BenchmarkTraverser;
+
+static void BM_TraverseDescendants(benchmark::State& state)
+{
+    Domain::ITreeCollection<BenchmarkNode> trees;
+    Domain::ITree<BenchmarkNode>* const tree = trees.addTree();
+    Generator::TreeGenerator<BenchmarkNode>().generateTree(tree, Generator::YuleModel, state.range(0));
+
+    while (state.KeepRunning())
+    {
+        CountAction action;
+        BenchmarkTraverser::traverseDescendants(tree, action);
+        benchmark::DoNotOptimize(action.count);
+    }
+}
+BENCHMARK(BM_TraverseDescendants)->Range(1000, 100000);
+
+static void BM_TraversePostOrder(benchmark::State& state)
+{
+    Domain::ITreeCollection<BenchmarkNode> trees;
+    Domain::ITree<BenchmarkNode>* const tree = trees.addTree();
+    Generator::TreeGenerator<BenchmarkNode>().generateTree(tree, Generator::YuleModel, state.range(0));
+
+    while (state.KeepRunning())
+    {
+        CountAction action;
+        BenchmarkTraverser::traversePostOrder(tree, action);
+        benchmark::DoNotOptimize(action.count);
+    }
+}
+BENCHMARK(BM_TraversePostOrder)->Range(1000, 100000);
+
+// Walks from every leaf up to the root
+static void BM_TraverseAncestors(benchmark::State& state)
+{
+    Domain::ITreeCollection<BenchmarkNode> trees;
+    Domain::ITree<BenchmarkNode>* const tree = trees.addTree();
+    Generator::TreeGenerator<BenchmarkNode>().generateTree(tree, Generator::YuleModel, state.range(0));
+
+    std::vector<const BenchmarkNode*> leaves;
+    tree->getLeaves(leaves);
+
+    while (state.KeepRunning())
+    {
+        CountAction action;
+        for (size_t i = 0; i < leaves.size(); i++)
+            BenchmarkTraverser::traverseAncestors(const_cast<BenchmarkNode*>(leaves[i]), action);
+        benchmark::DoNotOptimize(action.count);
+    }
+}
+BENCHMARK(BM_TraverseAncestors)->Range(1000, 100000);
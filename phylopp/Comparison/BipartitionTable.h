@@ -0,0 +1,351 @@
+/*
+    Copyright (C) 2011 Emmanuel Teisaire, Nicolás Bombau, Carlos Castro, Damián Domé, FuDePAN
+
+    This file is part of the Phyloloc project.
+
+    Phyloloc is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Phyloloc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef BIPARTITION_TABLE_H
+#define BIPARTITION_TABLE_H
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <mili/mili.h>
+#include "phylopp/Domain/ITreeCollection.h"
+#include "phylopp/Domain/LocationManager.h"
+#include "phylopp/Domain/ParallelFor.h"
+#include "phylopp/DataSource/FileBuffer.h"
+#include "phylopp/Comparison/Bipartitions.h"
+
+namespace Comparison
+{
+
+/**
+* BipartitionTableFileNotFound
+* --------------------
+* Description: Exception used when a table file is missing.
+*/
+DEFINE_SPECIFIC_EXCEPTION_TEXT(BipartitionTableFileNotFound,
+                               ComparisonExceptionHierarchy,
+                               "The bipartition table file does not exist.");
+
+/**
+* MalformedBipartitionTableFile
+* --------------------
+* Description: Exception used when a table file is not correctly formed.
+*/
+DEFINE_SPECIFIC_EXCEPTION_TEXT(MalformedBipartitionTableFile,
+                               ComparisonExceptionHierarchy,
+                               "The bipartition table file is not correctly formed");
+
+/**
+* DifferentLeafSetsException
+* --------------------
+* Description: Exception used when the trees of a table do not all have
+* the same leaves.
+*/
+DEFINE_SPECIFIC_EXCEPTION_TEXT(DifferentLeafSetsException,
+                               ComparisonExceptionHierarchy,
+                               "The trees of a bipartition table must have the same leaves");
+
+// Returned by BipartitionTable::find for splits that are not in the table
+static const size_t SPLIT_NOT_FOUND = static_cast<size_t>(-1);
+
+/**
+* Namespace: BipartitionTableFormat
+* ---------------------------------
+* Description: A bipartition table file holds, in host byte order:
+*   - MAGIC, BYTE_ORDER_MARK, VERSION, the taxon count, the words per
+*     split, the splits count and the trees count (uint32)
+*   - the leaves of the collection, as words (uint64)
+*   - the hash of every split (uint64)
+*   - the words of every split, one split after the other (uint64)
+*   - the frequency of every split (uint32)
+*   - the mean branch length of every split (float)
+* Every section starts on a DATA_ALIGNMENT boundary, so that the table
+* can be used in place once the file is mapped.
+*/
+namespace BipartitionTableFormat
+{
+static const char MAGIC[] = "PHYLOBT";
+static const size_t MAGIC_SIZE = sizeof(MAGIC);
+static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+static const uint32_t VERSION = 1;
+static const size_t DATA_ALIGNMENT = 64;
+}
+
+/**
+* Class: SplitCounts
+* ------------------
+* Description: Frequency and total branch length of a set of splits of
+* the same width, kept in flat arrays sorted by hash and words. Splits
+* are appended unsorted and sorted in batches, so adding a tree does
+* not need to walk the whole set.
+*/
+class SplitCounts
+{
+public:
+    typedef Consensus::bitset::Word Word;
+
+    SplitCounts();
+
+    void setTaxonCount(size_t taxa);
+
+    /**
+    * Method: add
+    * -----------
+    * Description: Counts once every split of a tree
+    * @param bipartitions the bipartitions of the tree, from getBipartitions
+    * @param leaves the leaves of the tree
+    */
+    void add(const std::vector<Bipartition>& bipartitions, const Consensus::bitset& leaves);
+
+    /**
+    * Method: merge
+    * -------------
+    * Description: Adds the counts of other, which is left empty
+    */
+    void merge(SplitCounts& other);
+
+    /**
+    * Method: compact
+    * ---------------
+    * Description: Sorts the pending splits and merges the equal ones
+    */
+    void compact();
+
+    size_t getTaxonCount() const;
+    size_t getStride() const;
+    size_t getTreeCount() const;
+
+    /**
+    * Method: hasSameLeaves
+    * ---------------------
+    * Returns: Whether every tree counted so far has the same leaves
+    */
+    bool hasSameLeaves() const;
+
+    // These are valid after compact()
+    size_t size() const;
+    const std::vector<uint64_t>& getHashes() const;
+    const std::vector<Word>& getWords() const;
+    const std::vector<uint32_t>& getFrequencies() const;
+    const std::vector<double>& getLengthSums() const;
+    const std::vector<Word>& getLeaves() const;
+
+private:
+    size_t taxa;
+    size_t stride;
+    size_t trees;
+    //splits before this one are sorted and unique
+    size_t sorted;
+    bool sameLeaves;
+    std::vector<uint64_t> hashes;
+    std::vector<Word> words;
+    std::vector<uint32_t> frequencies;
+    std::vector<double> lengthSums;
+    std::vector<Word> leaves;
+
+    void append(uint64_t hash, const Word* splitWords, uint32_t frequency, double lengthSum);
+};
+
+/**
+* Class: BipartitionTable
+* -----------------------
+* Description: Every split of a tree collection with the amount of trees
+* that have it and its mean branch length among them. Splits are
+* canonicalized as in getBipartitions, and leaf bits are node name ids - 1.
+* Every tree of the collection must have the same leaves, since splits
+* are canonicalized against them.
+* A table is built once from a collection, saved, and later loaded by
+* mapping the file, so it can be queried without rebuilding it.
+*/
+class BipartitionTable
+{
+public:
+    typedef Consensus::bitset::Word Word;
+
+    BipartitionTable();
+
+    /**
+    * Method: build
+    * -------------
+    * Description: Counts the splits of every tree of a collection, in a
+    * single parallel pass. Throws DifferentLeafSetsException when the
+    * trees do not all have the same leaves.
+    */
+    template <class T>
+    void build(const Domain::ITreeCollection<T>& trees, const Locations::LocationManager& locationManager)
+    {
+        std::vector<const Domain::ITree<T>*> treeList;
+        typename Domain::ITreeCollection<T>::iterator it = trees.getIterator();
+
+        for (; !it.end(); it.next())
+            treeList.push_back(it.get());
+
+        const size_t blocks = std::max<size_t>(1, std::min(treeList.size(), Domain::hardwareThreads() * BLOCKS_PER_THREAD));
+        std::vector<SplitCounts> counts(blocks);
+        std::vector<std::string> errors(blocks);
+
+        for (size_t b = 0; b < blocks; b++)
+            counts[b].setTaxonCount(locationManager.getNodeNameCount());
+
+        Domain::parallelFor(0, blocks, BlockCounts<T>(treeList, locationManager, counts, errors), 1);
+
+        for (size_t b = 0; b < blocks; b++)
+        {
+            if (!errors[b].empty())
+                throw ComparisonException(errors[b]);
+        }
+
+        for (size_t b = 1; b < blocks; b++)
+            counts[0].merge(counts[b]);
+        counts[0].compact();
+
+        if (!counts[0].hasSameLeaves())
+            throw DifferentLeafSetsException();
+
+        assign(counts[0]);
+    }
+
+    /**
+    * Method: save
+    * ------------
+    * Description: Saves the table. Files named "*.gz" or "*.zst" are
+    * compressed, and are read back into memory instead of mapped.
+    */
+    void save(const std::string& fname) const;
+
+    /**
+    * Method: load
+    * ------------
+    * Description: Maps a saved table, replacing the current one
+    */
+    void load(const std::string& fname);
+
+    size_t size() const;
+    size_t getTaxonCount() const;
+    size_t getTreeCount() const;
+
+    /**
+    * Method: find
+    * ------------
+    * Description: Looks up a split, or either of its sides
+    * @param split a set of leaves, getTaxonCount() bits wide
+    * @return the index of the split, or SPLIT_NOT_FOUND
+    */
+    size_t find(const Consensus::bitset& split) const;
+
+    void getSplit(size_t index, Consensus::bitset& split) const;
+    void getLeaves(Consensus::bitset& leaves) const;
+    size_t getFrequency(size_t index) const;
+
+    /**
+    * Method: getSupport
+    * ------------------
+    * Returns: The fraction of the trees that have the split
+    */
+    double getSupport(size_t index) const;
+
+    Domain::BranchLength getMeanLength(size_t index) const;
+
+private:
+
+    // Trees are counted in this many blocks per processor
+    static const size_t BLOCKS_PER_THREAD = 4;
+
+    size_t taxa;
+    size_t stride;
+    size_t count;
+    size_t trees;
+
+    //the table, either in the vectors below or in the mapped file
+    const Word* leaves;
+    const uint64_t* hashes;
+    const Word* words;
+    const uint32_t* frequencies;
+    const Domain::BranchLength* lengths;
+
+    std::vector<Word> ownLeaves;
+    std::vector<uint64_t> ownHashes;
+    std::vector<Word> ownWords;
+    std::vector<uint32_t> ownFrequencies;
+    std::vector<Domain::BranchLength> ownLengths;
+    DataSource::FileBuffer file;
+
+    void assign(const SplitCounts& counts);
+    void swap(BipartitionTable& other);
+
+    /**
+    * Class: BlockCounts
+    * ------------------
+    * Description: Counts the splits of a range of blocks of trees
+    */
+    template <class T>
+    class BlockCounts
+    {
+    public:
+        BlockCounts(const std::vector<const Domain::ITree<T>*>& trees, const Locations::LocationManager& locationManager,
+                    std::vector<SplitCounts>& counts, std::vector<std::string>& errors) :
+            trees(trees),
+            locationManager(locationManager),
+            counts(counts),
+            errors(errors)
+        {}
+
+        void operator()(size_t begin, size_t end) const
+        {
+            std::vector<Bipartition> bipartitions;
+            Consensus::bitset treeLeaves;
+
+            for (size_t b = begin; b < end; b++)
+            {
+                const size_t first = trees.size() * b / counts.size();
+                const size_t last = trees.size() * (b + 1) / counts.size();
+
+                //exceptions can not leave a thread, so they are rethrown by build
+                try
+                {
+                    for (size_t i = first; i < last; i++)
+                    {
+                        getBipartitions(trees[i], locationManager, bipartitions, treeLeaves);
+                        counts[b].add(bipartitions, treeLeaves);
+                    }
+                    counts[b].compact();
+                }
+                catch (const UnknownTaxonException& e)
+                {
+                    errors[b] = e.what();
+                }
+            }
+        }
+
+    private:
+        const std::vector<const Domain::ITree<T>*>& trees;
+        const Locations::LocationManager& locationManager;
+        std::vector<SplitCounts>& counts;
+        std::vector<std::string>& errors;
+    };
+
+    BipartitionTable(const BipartitionTable&);
+    BipartitionTable& operator=(const BipartitionTable&);
+};
+
+} // End of Namespace Comparison
+
+#endif
@@ -0,0 +1,225 @@
+/*
+    Copyright (C) 2011 Emmanuel Teisaire, Nicolás Bombau, Carlos Castro, Damián Domé, FuDePAN
+
+    This file is part of the Phyloloc project.
+
+    Phyloloc is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Phyloloc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef BIPARTITIONS_H
+#define BIPARTITIONS_H
+
+#include <vector>
+#include <utility>
+#include <stdint.h>
+#include <mili/mili.h>
+#include "phylopp/Domain/ITree.h"
+#include "phylopp/Domain/LocationManager.h"
+#include "phylopp/Consensor/bitset.h"
+
+namespace Comparison
+{
+
+class ComparisonExceptionHierarchy {};
+
+typedef mili::GenericException<ComparisonExceptionHierarchy> ComparisonException;
+
+/**
+* UnknownTaxonException
+* --------------------
+* Description: Exception used when a leaf name is not known by the
+* location manager, so it has no bit in the bipartitions.
+*/
+DEFINE_SPECIFIC_EXCEPTION_TEXT(UnknownTaxonException,
+                               ComparisonExceptionHierarchy,
+                               "A leaf name is not known by the location manager");
+
+/**
+* Struct: Bipartition
+* -------------------
+* Description: Split of the leaves of a tree made by one of its branches.
+* Leaf bits are node name ids - 1, as in ClusterTree.
+*/
+struct Bipartition
+{
+    Consensus::bitset split;
+    Domain::BranchLength length;
+};
+
+/**
+* Method: canonicalize
+* --------------------
+* Description: Turns a split of leaves into the side with fewer leaves,
+* or the side without the lowest leaf when both sides are even, so
+* that both sides of a branch give the same bitset
+*/
+void canonicalize(Consensus::bitset& split, const Consensus::bitset& leaves);
+
+/**
+* Method: compareSplitKeys
+* ------------------------
+* Description: Orders splits of the same width by hash, then by their
+* words as numbers. This is the order of mergeDuplicates.
+* Returns: <0, 0 or >0 as split a sorts before, with or after split b
+*/
+int compareSplitKeys(uint64_t hashA, const Consensus::bitset::Word* wordsA,
+                     uint64_t hashB, const Consensus::bitset::Word* wordsB, size_t stride);
+
+/**
+* Method: mergeDuplicates
+* -----------------------
+* Description: Sorts the bipartitions and merges the equal ones,
+* adding up their lengths
+*/
+void mergeDuplicates(std::vector<Bipartition>& bipartitions);
+
+/**
+* Method: getClusters
+* -------------------
+* Description: Gets the leaves below every node of a tree, without
+* recursion. Nodes are listed in preorder, so the root comes first.
+* Type Parameter T: T is the underlying node class
+* Type Parameter Node: T or const T
+* @param nodes receives the nodes of the tree
+* @param clusters receives at i the leaves below nodes[i]
+*/
+template <class T, class Node>
+void getClusters(Node* root, const Locations::LocationManager& locationManager,
+                 std::vector<Node*>& nodes, std::vector<Consensus::bitset>& clusters)
+{
+    typedef std::pair<Node*, size_t> PendingNode;
+    static const size_t NO_PARENT = static_cast<size_t>(-1);
+
+    const size_t taxa = locationManager.getNodeNameCount();
+    std::vector<size_t> parents;
+    std::vector<PendingNode> pending(1, PendingNode(root, NO_PARENT));
+
+    //preorder, so that every parent comes before its children
+    nodes.clear();
+    while (!pending.empty())
+    {
+        const PendingNode current = pending.back();
+        pending.pop_back();
+
+        const size_t index = nodes.size();
+        nodes.push_back(current.first);
+        parents.push_back(current.second);
+
+        Domain::ListIterator<T, Domain::Node> it = current.first->template getChildrenIterator<T>();
+        for (; !it.end(); it.next())
+            pending.push_back(PendingNode(it.get(), index));
+    }
+
+    clusters.assign(nodes.size(), Consensus::bitset(taxa));
+    for (size_t i = nodes.size(); i > 0; i--)
+    {
+        const size_t index = i - 1;
+        if (nodes[index]->isLeaf())
+        {
+            const Locations::NodeNameId id = locationManager.getNodeNameId(nodes[index]->getName());
+            if (id == Locations::NAME_NOT_FOUND)
+                throw UnknownTaxonException(nodes[index]->getName());
+            clusters[index].set(id - 1);
+        }
+        if (parents[index] != NO_PARENT)
+            clusters[parents[index]] |= clusters[index];
+    }
+}
+
+/**
+* Method: getBipartitions
+* -----------------------
+* Description: Gets the canonical bipartition of every branch of a tree,
+* without recursion. Branches that give the same split, like the two
+* below a binary root, are reported once with their lengths added up.
+* Trivial splits, which separate a single leaf, are included; splits
+* with an empty side are not.
+* @param leaves receives the leaves of the tree
+*/
+template <class T>
+void getBipartitions(const Domain::ITree<T>* tree, const Locations::LocationManager& locationManager,
+                     std::vector<Bipartition>& bipartitions, Consensus::bitset& leaves)
+{
+    std::vector<const T*> nodes;
+    std::vector<Consensus::bitset> clusters;
+    getClusters<T>(tree->getRoot(), locationManager, nodes, clusters);
+
+    leaves.swap(clusters[0]);
+    bipartitions.clear();
+    for (size_t i = 1; i < nodes.size(); i++)
+    {
+        canonicalize(clusters[i], leaves);
+        if (clusters[i].count() > 0)
+        {
+            bipartitions.push_back(Bipartition());
+            bipartitions.back().split.swap(clusters[i]);
+            bipartitions.back().length = nodes[i]->getBranchLength();
+        }
+    }
+    mergeDuplicates(bipartitions);
+}
+
+template <class T>
+void getBipartitions(const Domain::ITree<T>* tree, const Locations::LocationManager& locationManager,
+                     std::vector<Bipartition>& bipartitions)
+{
+    Consensus::bitset leaves;
+    getBipartitions(tree, locationManager, bipartitions, leaves);
+}
+
+/**
+* Class: SplitSignature
+* ---------------------
+* Description: The bipartitions of a tree packed for fast comparison:
+* sorted by hash, with the words of every split stored contiguously.
+*/
+class SplitSignature
+{
+public:
+
+    SplitSignature();
+
+    void assign(const std::vector<Bipartition>& bipartitions);
+
+    size_t size() const;
+
+    /**
+    * Method: compare
+    * ---------------
+    * Description: Compares the splits of two trees in a single merge
+    * @param different receives the amount of non trivial splits that are
+    * in only one of the trees, that is, their Robinson-Foulds distance
+    * @param weighted receives the sum over all splits of the difference
+    * of their lengths, taking missing splits as of length 0
+    */
+    static void compare(const SplitSignature& a, const SplitSignature& b,
+                        size_t& different, Locations::Distance& weighted);
+
+private:
+
+    //words of each split
+    size_t stride;
+    std::vector<size_t> hashes;
+    std::vector<Consensus::bitset::Word> words;
+    std::vector<Domain::BranchLength> lengths;
+    std::vector<bool> trivial;
+
+    // Returns <0, 0 or >0 as split i of a sorts before, with or after split j of b
+    static int compareSplits(const SplitSignature& a, size_t i, const SplitSignature& b, size_t j);
+};
+
+} // End of Namespace Comparison
+
+#endif
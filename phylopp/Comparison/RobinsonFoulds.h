@@ -0,0 +1,252 @@
+/*
+    Copyright (C) 2011 Emmanuel Teisaire, Nicolás Bombau, Carlos Castro, Damián Domé, FuDePAN
+
+    This file is part of the Phyloloc project.
+
+    Phyloloc is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Phyloloc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef ROBINSON_FOULDS_H
+#define ROBINSON_FOULDS_H
+
+#include <string>
+#include <vector>
+#include "phylopp/Domain/ITreeCollection.h"
+#include "phylopp/Domain/LocationManager.h"
+#include "phylopp/Domain/DistanceMatrix.h"
+#include "phylopp/Domain/ParallelFor.h"
+#include "phylopp/Comparison/Bipartitions.h"
+
+namespace Comparison
+{
+
+/**
+* Class: RobinsonFoulds
+* ---------------------
+* Description: Robinson-Foulds distances among the trees of a collection.
+* The bipartitions of every tree are hashed once, when the trees are set,
+* and every pair of trees is then compared with a single merge of their
+* sorted splits. Leaves are identified by their node name ids in the
+* location manager.
+* Type Parameter T: T is the underlying node class
+*/
+template <class T>
+class RobinsonFoulds
+{
+public:
+
+    // Trees are compared in square tiles of this many trees per side
+    static const size_t TILE_TREES = 32;
+
+    RobinsonFoulds(const Locations::LocationManager& locationManager) :
+        locationManager(locationManager)
+    {}
+
+    /**
+    * Method: setTrees
+    * ----------------
+    * Description: Extracts the bipartitions of every tree of the
+    * collection, in parallel. Trees are numbered in iteration order.
+    */
+    void setTrees(const Domain::ITreeCollection<T>& trees)
+    {
+        std::vector<const Domain::ITree<T>*> treeList;
+        typename Domain::ITreeCollection<T>::iterator it = trees.getIterator();
+
+        for (; !it.end(); it.next())
+            treeList.push_back(it.get());
+
+        std::vector<std::string> errors(treeList.size());
+
+        signatures.clear();
+        signatures.resize(treeList.size());
+        Domain::parallelFor(0, treeList.size(), SignatureRange(*this, treeList, errors), PARALLEL_SIGNATURES);
+
+        for (size_t i = 0; i < errors.size(); i++)
+        {
+            if (!errors[i].empty())
+            {
+                signatures.clear();
+                throw ComparisonException(errors[i]);
+            }
+        }
+    }
+
+    size_t getTreeCount() const
+    {
+        return signatures.size();
+    }
+
+    /**
+    * Method: distance
+    * ----------------
+    * Returns: The amount of non trivial splits that are in only one of
+    * the trees i and j
+    */
+    size_t distance(size_t i, size_t j) const
+    {
+        size_t different;
+        Locations::Distance weighted;
+        SplitSignature::compare(signatures[i], signatures[j], different, weighted);
+        return different;
+    }
+
+    /**
+    * Method: weightedDistance
+    * ------------------------
+    * Returns: The sum, over every split of the trees i and j, of the
+    * difference of its branch lengths, missing splits being of length 0
+    */
+    Locations::Distance weightedDistance(size_t i, size_t j) const
+    {
+        size_t different;
+        Locations::Distance weighted;
+        SplitSignature::compare(signatures[i], signatures[j], different, weighted);
+        return weighted;
+    }
+
+    /**
+    * Method: distances
+    * -----------------
+    * Description: Compares every pair of trees. Only the upper triangle
+    * is computed, in tiles of TILE_TREES x TILE_TREES trees so that the
+    * signatures of a tile stay in cache, and tiles run in parallel.
+    * @param unweighted receives at row i and column j the Robinson-Foulds
+    * distance between trees i and j
+    * @param weighted receives the weighted distance between them
+    */
+    void distances(Locations::DistanceMatrix& unweighted, Locations::DistanceMatrix& weighted) const
+    {
+        const size_t count = signatures.size();
+        const size_t blocks = (count + TILE_TREES - 1) / TILE_TREES;
+        std::vector<Tile> tiles;
+
+        for (size_t row = 0; row < blocks; row++)
+            for (size_t column = row; column < blocks; column++)
+                tiles.push_back(Tile(row * TILE_TREES, column * TILE_TREES));
+
+        unweighted.clear();
+        unweighted.resize(count);
+        weighted.clear();
+        weighted.resize(count);
+
+        Domain::parallelFor(0, tiles.size(), TileRange(*this, tiles, unweighted, weighted), 1);
+    }
+
+private:
+
+    typedef std::pair<size_t, size_t> Tile;
+
+    // Smaller collections get their bipartitions from a single thread
+    static const size_t PARALLEL_SIGNATURES = 16;
+
+    const Locations::LocationManager& locationManager;
+    std::vector<SplitSignature> signatures;
+
+    /**
+    * Class: SignatureRange
+    * ---------------------
+    * Description: Extracts the split signatures of a range of trees
+    */
+    class SignatureRange
+    {
+    public:
+        SignatureRange(RobinsonFoulds& owner, const std::vector<const Domain::ITree<T>*>& trees,
+                       std::vector<std::string>& errors) :
+            owner(owner),
+            trees(trees),
+            errors(errors)
+        {}
+
+        void operator()(size_t begin, size_t end) const
+        {
+            std::vector<Bipartition> bipartitions;
+
+            for (size_t i = begin; i < end; i++)
+            {
+                //exceptions can not leave a thread, so they are rethrown by setTrees
+                try
+                {
+                    getBipartitions(trees[i], owner.locationManager, bipartitions);
+                    owner.signatures[i].assign(bipartitions);
+                }
+                catch (const UnknownTaxonException& e)
+                {
+                    errors[i] = e.what();
+                }
+            }
+        }
+
+    private:
+        RobinsonFoulds& owner;
+        const std::vector<const Domain::ITree<T>*>& trees;
+        std::vector<std::string>& errors;
+    };
+
+    /**
+    * Class: TileRange
+    * ----------------
+    * Description: Compares the pairs of trees of a range of tiles,
+    * filling both halves of the matrices
+    */
+    class TileRange
+    {
+    public:
+        TileRange(const RobinsonFoulds& owner, const std::vector<Tile>& tiles,
+                  Locations::DistanceMatrix& unweighted, Locations::DistanceMatrix& weighted) :
+            owner(owner),
+            tiles(tiles),
+            unweighted(unweighted),
+            weighted(weighted)
+        {}
+
+        void operator()(size_t begin, size_t end) const
+        {
+            const size_t count = owner.signatures.size();
+
+            for (size_t t = begin; t < end; t++)
+            {
+                const size_t rowEnd = std::min(tiles[t].first + TILE_TREES, count);
+                const size_t columnEnd = std::min(tiles[t].second + TILE_TREES, count);
+
+                for (size_t i = tiles[t].first; i < rowEnd; i++)
+                {
+                    //diagonal tiles only hold the pairs above the diagonal
+                    const size_t columnBegin = std::max(tiles[t].second, i + 1);
+
+                    for (size_t j = columnBegin; j < columnEnd; j++)
+                    {
+                        size_t different;
+                        Locations::Distance distance;
+                        SplitSignature::compare(owner.signatures[i], owner.signatures[j], different, distance);
+
+                        unweighted(i, j) = unweighted(j, i) = static_cast<Locations::Distance>(different);
+                        weighted(i, j) = weighted(j, i) = distance;
+                    }
+                }
+            }
+        }
+
+    private:
+        const RobinsonFoulds& owner;
+        const std::vector<Tile>& tiles;
+        Locations::DistanceMatrix& unweighted;
+        Locations::DistanceMatrix& weighted;
+    };
+};
+
+} // End of Namespace Comparison
+
+#endif
@@ -0,0 +1,291 @@
+/*
+    Copyright (C) 2011 Emmanuel Teisaire, Nicolás Bombau, Carlos Castro, Damián Domé, FuDePAN
+
+    This file is part of the Phyloloc project.
+
+    Phyloloc is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Phyloloc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef SUPPORT_ANNOTATOR_H
+#define SUPPORT_ANNOTATOR_H
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "phylopp/Domain/ITreeCollection.h"
+#include "phylopp/Domain/LocationManager.h"
+#include "phylopp/Domain/ParallelFor.h"
+#include "phylopp/Domain/SupportAspect.h"
+#include "phylopp/Comparison/Bipartitions.h"
+#include "phylopp/Comparison/BipartitionTable.h"
+
+namespace Comparison
+{
+
+/**
+* Class: SupportAnnotator
+* -----------------------
+* Description: Annotates the internal nodes of a reference tree with the
+* fraction of the trees of a collection that have their split, that is,
+* their bootstrap or posterior support. The splits of the reference are
+* hashed and sorted once; every tree of the collection is then matched
+* against them with a single merge of its sorted splits.
+* Type Parameter T: the node class of the reference, derived from
+* SupportAspect
+*/
+template <class T>
+class SupportAnnotator
+{
+public:
+
+    SupportAnnotator(const Locations::LocationManager& locationManager) :
+        locationManager(locationManager),
+        stride(0)
+    {}
+
+    /**
+    * Method: annotate
+    * ----------------
+    * Description: Sets the support of every internal node of the
+    * reference, other than the root, streaming the collection through
+    * the splits of the reference in parallel
+    * Type Parameter U: the node class of the collection
+    */
+    template <class U>
+    void annotate(Domain::ITree<T>* reference, const Domain::ITreeCollection<U>& trees)
+    {
+        setReference(reference);
+
+        std::vector<const Domain::ITree<U>*> treeList;
+        typename Domain::ITreeCollection<U>::iterator it = trees.getIterator();
+
+        for (; !it.end(); it.next())
+            treeList.push_back(it.get());
+
+        const size_t blocks = std::max<size_t>(1, std::min(treeList.size(), Domain::hardwareThreads() * BLOCKS_PER_THREAD));
+        std::vector<std::vector<size_t> > counts(blocks, std::vector<size_t>(hashes.size(), 0));
+        std::vector<std::string> errors(blocks);
+
+        Domain::parallelFor(0, blocks, BlockMatches<U>(*this, treeList, counts, errors), 1);
+
+        for (size_t b = 0; b < blocks; b++)
+        {
+            if (!errors[b].empty())
+                throw ComparisonException(errors[b]);
+        }
+
+        for (size_t b = 1; b < blocks; b++)
+            for (size_t k = 0; k < hashes.size(); k++)
+                counts[0][k] += counts[b][k];
+
+        for (size_t i = 0; i < nodeKeys.size(); i++)
+        {
+            const double support = treeList.empty() ? 0.0 : double(counts[0][nodeKeys[i].second]) / treeList.size();
+            nodeKeys[i].first->setSupport(static_cast<Domain::Support>(support));
+        }
+    }
+
+    /**
+    * Method: annotate
+    * ----------------
+    * Description: Sets the support of every internal node of the
+    * reference, other than the root, from a table of the splits of a
+    * collection
+    */
+    void annotate(Domain::ITree<T>* reference, const BipartitionTable& table)
+    {
+        std::vector<T*> nodes;
+        std::vector<Consensus::bitset> clusters;
+        getClusters<T>(reference->getRoot(), locationManager, nodes, clusters);
+
+        for (size_t i = 1; i < nodes.size(); i++)
+        {
+            canonicalize(clusters[i], clusters[0]);
+            if (!nodes[i]->isLeaf() && clusters[i].count() > 0)
+            {
+                const size_t index = table.find(clusters[i]);
+                nodes[i]->setSupport(index == SPLIT_NOT_FOUND ? 0.0f : static_cast<Domain::Support>(table.getSupport(index)));
+            }
+            else if (!nodes[i]->isLeaf())
+            {
+                nodes[i]->setSupport(Domain::NO_SUPPORT);
+            }
+        }
+    }
+
+private:
+
+    typedef Consensus::bitset::Word Word;
+    typedef std::pair<T*, size_t> NodeKey;
+
+    // Trees are matched in this many blocks per processor
+    static const size_t BLOCKS_PER_THREAD = 4;
+
+    const Locations::LocationManager& locationManager;
+    //splits of the reference, sorted as by mergeDuplicates
+    size_t stride;
+    std::vector<uint64_t> hashes;
+    std::vector<Word> words;
+    //every annotated node with the index of its split
+    std::vector<NodeKey> nodeKeys;
+
+    void setReference(Domain::ITree<T>* reference)
+    {
+        std::vector<T*> nodes;
+        std::vector<Consensus::bitset> clusters;
+        getClusters<T>(reference->getRoot(), locationManager, nodes, clusters);
+
+        std::vector<Bipartition> splits;
+        std::vector<T*> annotated;
+        for (size_t i = 1; i < nodes.size(); i++)
+        {
+            canonicalize(clusters[i], clusters[0]);
+            //the root and the nodes that hold every leaf have no split
+            if (!nodes[i]->isLeaf() && clusters[i].count() > 0)
+            {
+                splits.push_back(Bipartition());
+                splits.back().split = clusters[i];
+                splits.back().length = 0;
+                annotated.push_back(nodes[i]);
+            }
+            else if (!nodes[i]->isLeaf())
+            {
+                nodes[i]->setSupport(Domain::NO_SUPPORT);
+            }
+        }
+
+        std::vector<Bipartition> keys(splits);
+        mergeDuplicates(keys);
+
+        stride = clusters[0].wordCount();
+        hashes.resize(keys.size());
+        words.resize(keys.size() * stride);
+        for (size_t k = 0; k < keys.size(); k++)
+        {
+            hashes[k] = keys[k].split.hash();
+            for (size_t w = 0; w < stride; w++)
+                words[k * stride + w] = keys[k].split.getWord(w);
+        }
+
+        nodeKeys.clear();
+        for (size_t i = 0; i < splits.size(); i++)
+            nodeKeys.push_back(NodeKey(annotated[i], find(splits[i].split)));
+    }
+
+    // Index of a split of the reference
+    size_t find(const Consensus::bitset& split) const
+    {
+        std::vector<Word> key(stride);
+        for (size_t w = 0; w < stride; w++)
+            key[w] = split.getWord(w);
+
+        size_t first = 0;
+        size_t last = hashes.size();
+        while (first < last)
+        {
+            const size_t middle = first + (last - first) / 2;
+            if (compareSplitKeys(hashes[middle], &words[middle * stride], split.hash(), &key[0], stride) < 0)
+                first = middle + 1;
+            else
+                last = middle;
+        }
+        return first;
+    }
+
+    /**
+    * Class: BlockMatches
+    * -------------------
+    * Description: Counts, for a range of blocks of trees, how many trees
+    * have each split of the reference
+    */
+    template <class U>
+    class BlockMatches
+    {
+    public:
+        BlockMatches(const SupportAnnotator& owner, const std::vector<const Domain::ITree<U>*>& trees,
+                     std::vector<std::vector<size_t> >& counts, std::vector<std::string>& errors) :
+            owner(owner),
+            trees(trees),
+            counts(counts),
+            errors(errors)
+        {}
+
+        void operator()(size_t begin, size_t end) const
+        {
+            std::vector<Bipartition> bipartitions;
+            std::vector<Word> splitWords(owner.stride);
+
+            for (size_t b = begin; b < end; b++)
+            {
+                const size_t first = trees.size() * b / counts.size();
+                const size_t last = trees.size() * (b + 1) / counts.size();
+
+                //exceptions can not leave a thread, so they are rethrown by annotate
+                try
+                {
+                    for (size_t i = first; i < last; i++)
+                    {
+                        getBipartitions(trees[i], owner.locationManager, bipartitions);
+                        match(bipartitions, splitWords, counts[b]);
+                    }
+                }
+                catch (const UnknownTaxonException& e)
+                {
+                    errors[b] = e.what();
+                }
+            }
+        }
+
+    private:
+        const SupportAnnotator& owner;
+        const std::vector<const Domain::ITree<U>*>& trees;
+        std::vector<std::vector<size_t> >& counts;
+        std::vector<std::string>& errors;
+
+        // Both the bipartitions and the reference splits are sorted, so they are merged
+        void match(const std::vector<Bipartition>& bipartitions, std::vector<Word>& splitWords,
+                   std::vector<size_t>& blockCounts) const
+        {
+            const size_t stride = owner.stride;
+            size_t i = 0;
+            size_t k = 0;
+
+            while (i < bipartitions.size() && k < owner.hashes.size())
+            {
+                const Consensus::bitset& split = bipartitions[i].split;
+                const uint64_t hash = split.hash();
+                for (size_t w = 0; w < stride; w++)
+                    splitWords[w] = split.getWord(w);
+
+                //skip the reference splits that sort before this one
+                int order = -1;
+                while (k < owner.hashes.size()
+                        && (order = compareSplitKeys(owner.hashes[k], &owner.words[k * stride], hash, &splitWords[0], stride)) < 0)
+                    k++;
+
+                if (order == 0)
+                {
+                    blockCounts[k]++;
+                    k++;
+                }
+                i++;
+            }
+        }
+    };
+};
+
+} // End of Namespace Comparison
+
+#endif
@@ -0,0 +1,190 @@
+/*
+    Copyright (C) 2011 Emmanuel Teisaire, Nicolás Bombau, Carlos Castro, Damián Domé, FuDePAN
+
+    This file is part of the Phyloloc project.
+
+    Phyloloc is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Phyloloc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef CLUSTER_TABLE_H
+#define CLUSTER_TABLE_H
+
+#include <vector>
+#include "phylopp/Consensor/bitset.h"
+
+namespace Consensus
+{
+
+static const unsigned int CLUSTER_NOT_FOUND = 0;
+
+/**
+* Class: ClusterTable
+* -------------------
+* Description: Interns clusters of the same width into consecutive ids
+* starting at one, as NameTable does with names. Clusters are stored as
+* packed words and looked up by hash in an open-addressing table.
+* Id zero (CLUSTER_NOT_FOUND) is never assigned.
+*/
+class ClusterTable
+{
+public:
+
+    typedef unsigned int Id;
+    typedef bitset::Word Word;
+
+    ClusterTable() :
+        width(0),
+        stride(0),
+        mask(0)
+    {}
+
+    /**
+    * Method: find
+    * ------------
+    * Returns: The id of the cluster or CLUSTER_NOT_FOUND
+    */
+    Id find(const bitset& cluster) const
+    {
+        return find(cluster, cluster.hash());
+    }
+
+    /**
+    * Method: insert
+    * --------------
+    * Description: Interns a cluster. The first cluster sets the width
+    * of the table.
+    * Returns: The id of the cluster, which is new if the cluster was not
+    * already in the table
+    */
+    Id insert(const bitset& cluster)
+    {
+        if (hashes.empty())
+        {
+            width = cluster.size();
+            stride = cluster.wordCount();
+        }
+
+        const size_t hashValue = cluster.hash();
+        Id id = find(cluster, hashValue);
+
+        if (id == CLUSTER_NOT_FOUND)
+        {
+            // keep the load factor at or below one half
+            if (2 * (hashes.size() + 1) > slots.size())
+                rehash(slots.empty() ? INITIAL_CAPACITY : 2 * slots.size());
+
+            for (size_t w = 0; w < stride; w++)
+                words.push_back(cluster.getWord(w));
+            hashes.push_back(hashValue);
+            id = Id(hashes.size());
+            place(id);
+        }
+
+        return id;
+    }
+
+    /**
+    * Method: getCluster
+    * ------------------
+    * Description: Gets the cluster interned as id, which must be a valid id
+    */
+    void getCluster(Id id, bitset& cluster) const
+    {
+        cluster = bitset(width);
+        for (size_t w = 0; w < stride; w++)
+            cluster.setWord(w, words[(id - 1) * stride + w]);
+    }
+
+    size_t size() const
+    {
+        return hashes.size();
+    }
+
+    void clear()
+    {
+        words.clear();
+        hashes.clear();
+        slots.clear();
+        width = stride = mask = 0;
+    }
+
+private:
+
+    // Must be a power of two
+    static const size_t INITIAL_CAPACITY = 16;
+
+    size_t width;
+    size_t stride;
+    std::vector<Word> words;
+    std::vector<size_t> hashes;
+    std::vector<Id> slots;
+    size_t mask;
+
+    Id find(const bitset& cluster, size_t hashValue) const
+    {
+        Id id = CLUSTER_NOT_FOUND;
+
+        if (!slots.empty() && cluster.size() == width)
+        {
+            size_t slot = hashValue & mask;
+            bool found = false;
+
+            while (!found && slots[slot] != CLUSTER_NOT_FOUND)
+            {
+                const Id candidate = slots[slot];
+
+                found = hashes[candidate - 1] == hashValue && sameWords(candidate, cluster);
+
+                if (found)
+                    id = candidate;
+                else
+                    slot = (slot + 1) & mask;
+            }
+        }
+
+        return id;
+    }
+
+    bool sameWords(Id id, const bitset& cluster) const
+    {
+        const Word* const stored = &words[(id - 1) * stride];
+        bool same = true;
+
+        for (size_t w = 0; w < stride && same; w++)
+            same = stored[w] == cluster.getWord(w);
+
+        return same;
+    }
+
+    void place(Id id)
+    {
+        size_t slot = hashes[id - 1] & mask;
+        while (slots[slot] != CLUSTER_NOT_FOUND)
+            slot = (slot + 1) & mask;
+        slots[slot] = id;
+    }
+
+    void rehash(size_t capacity)
+    {
+        slots.assign(capacity, CLUSTER_NOT_FOUND);
+        mask = capacity - 1;
+        for (size_t i = 0; i < hashes.size(); i++)
+            place(Id(i + 1));
+    }
+};
+
+} // End of Namespace Consensus
+
+#endif
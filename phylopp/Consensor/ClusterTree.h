@@ -22,6 +22,9 @@ along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <list>
 #include "phylopp/Consensor/bitset.h"
+#include "phylopp/Consensor/ObserverTraits.h"
+#include "phylopp/Consensor/ClusterTable.h"
+#include "phylopp/Consensor/TaxonIndex.h"
 #include "phylopp/Domain/INode.h"
 #include "phylopp/Domain/LocationAspect.h"
 #include "phylopp/Domain/ITree.h"
@@ -70,17 +73,48 @@ private:
     ClusterList clusters;
     bool isConsensusTree;
     Locations::LocationManager& locationManager;
+    //when set, clusters are over its taxa and restricted to its common leaves
+    const TaxonIndex* taxonIndex;
+    size_t taxonCount;
 
     void calculateClusters(Domain::ITree<Node>* tree)
     {
-        bitset b(locationManager.getNodeNameCount());
+        bitset b(taxonCount);
         buildCluster(tree->getRoot(), b);
+
+        if (taxonIndex != NULL)
+            restrictToCommonLeaves();
+    }
+
+    /**
+    * Method: restrictToCommonLeaves
+    * ------------------------------
+    * Description: Removes from every cluster the leaves that are not in
+    * every tree. Clusters left empty are dropped, and so are repeated
+    * ones, keeping the first, deepest node, so that a leaf keeps its
+    * own node rather than the node of its removed sibling.
+    */
+    void restrictToCommonLeaves()
+    {
+        const bitset& common = taxonIndex->getCommonLeaves();
+        ClusterTable seen;
+
+        for (ClusterIterator it = clusters.begin(); it != clusters.end();)
+        {
+            it->cluster &= common;
+            const size_t previous = seen.size();
+
+            if (it->cluster.count() > 0 && seen.insert(it->cluster) > previous)
+                ++it;
+            else
+                it = clusters.erase(it);
+        }
     }
 
 public:
     bitset& buildCluster(Node* node, bitset& set)
     {
-        bitset nodeCluster(locationManager.getNodeNameCount());
+        bitset nodeCluster(taxonCount);
         if (!node->isLeaf())
         {
             Domain::ListIterator<Node, Domain::Node> it = node->template getChildrenIterator<Node>();
@@ -103,12 +137,21 @@ public:
     void buildLeafCluster(const Node* const leaf, bitset& b) const
     {
         b.reset();
-        b.set(locationManager.getNodeNameId(leaf->getName()) - 1);
+        if (taxonIndex == NULL)
+        {
+            b.set(locationManager.getNodeNameId(leaf->getName()) - 1);
+        }
+        else
+        {
+            const size_t taxon = taxonIndex->getTaxon(locationManager.getNodeNameId(leaf->getName()));
+            if (taxon != NO_TAXON)
+                b.set(taxon);
+        }
     }
 
     bitset getConsensedRoot() const
     {
-        bitset aux(locationManager.getNodeNameCount());
+        bitset aux(taxonCount);
 
         for (ClusterConstIterator it = clusters.begin(); it != clusters.end(); ++it)
             aux |= it->cluster;
@@ -128,7 +171,7 @@ public:
 
     static bool areParentAndChild(NodeCluster<Node>& parent, NodeCluster<Node>& child)
     {
-        return (parent.cluster & child.cluster) == child.cluster;
+        return child.cluster.isSubsetOf(parent.cluster);
     }
 
     static Node* nodeFromCluster(const NodeCluster<Node>& n, Node* parent)
@@ -191,18 +234,23 @@ public:
 
         static size_t countTrueBits(Consensus::bitset& bs)
         {
-            size_t count = 0;
-            //TODO: use std::count_if, but before shouldn't bitset provide bit iterator?
-            for (unsigned int i = 0; i < bs.size(); ++i)
-                count += (bs[i] == bitset::bit::true_bit) ? 1 : 0;
-            return count;
+            return bs.count();
         }
     };
 
 
 
-    ClusterTree(Domain::ITree<Node>* t, Observer& observer, Locations::LocationManager& locMgr)
-        : obs(observer), isConsensusTree(false), locationManager(locMgr)
+    /**
+    * Constructor
+    * -----------
+    * Description: Gets the clusters of a tree
+    * @param index when given, clusters are over its taxa and only hold
+    * the leaves common to every tree it indexes
+    */
+    ClusterTree(Domain::ITree<Node>* t, Observer& observer, Locations::LocationManager& locMgr,
+                const TaxonIndex* index = NULL)
+        : obs(observer), isConsensusTree(false), locationManager(locMgr), taxonIndex(index),
+          taxonCount(index != NULL ? index->getTaxonCount() : locMgr.getNodeNameCount())
     {
         calculateClusters(t);
     }
@@ -210,7 +258,9 @@ public:
     ClusterTree(const ClusterTree<Node, Observer>& other, Observer& observer, Locations::LocationManager& locMgr) : 
         obs(observer), 
         isConsensusTree(true), 
-        locationManager(locMgr)
+        locationManager(locMgr),
+        taxonIndex(other.taxonIndex),
+        taxonCount(other.taxonCount)
     {
         ClusterConstIterator it = other.getClusterIterator();
 
@@ -219,7 +269,7 @@ public:
             bitset newCluster(it->cluster);
             NodeCluster<Node> n(newCluster, it->node);
             clusters.push_back(n);
-            obs.onInclude(it->node, newCluster);
+            ClusterEvents<Observer>::include(obs, it->node, newCluster);
         }
     }
 
@@ -229,6 +279,11 @@ public:
         return it;
     }
 
+    size_t getClusterCount() const
+    {
+        return clusters.size();
+    }
+
     bool containsCluster(const bitset& bits) const
     {
         ClusterConstIterator it = clusters.begin();
@@ -263,7 +318,7 @@ public:
             --itExtern;
             if (isPresent)
             {
-                obs.onInclude(itExtern->node, itLocal->cluster);
+                ClusterEvents<Observer>::include(obs, itExtern->node, itLocal->cluster);
                 if (itLocal->node->getBranchLength() > itExtern->node->getBranchLength())
                 {
                     itLocal->node = itExtern->node;
@@ -272,7 +327,7 @@ public:
             }
             else
             {
-                obs.onExclude(itExtern->node, itLocal->cluster);
+                ClusterEvents<Observer>::exclude(obs, itExtern->node, itLocal->cluster);
                 itLocal = clusters.erase(itLocal);
                 --itLocal;
             }
@@ -286,7 +341,11 @@ public:
 
         //Sort the clusters in descending order, so that the root cluster is first, and
         //the leaves at the end
+        PhaseEvents<Observer>::begin(obs, SortPhase);
         clusters.sort(BitsetComparator());
+        PhaseEvents<Observer>::end(obs, SortPhase, *this);
+
+        PhaseEvents<Observer>::begin(obs, TreeBuildPhase);
 
         //If the trees have disjoint terminals, we can't create consensus tree
         if (treesAreDisjoint())
@@ -298,8 +357,6 @@ public:
         nodes[0] = tree->getRoot();
         nodes[0]->cluster = clusters.front().cluster;
 
-        if (clusters.size() == 1) return tree;
-
         it = clusters.begin();
         ++it;
 
@@ -311,6 +368,8 @@ public:
             nodes[nextChildIndex] = bindClusterToConsensus(it, nodes, nextChildIndex);
         }
 
+        PhaseEvents<Observer>::end(obs, TreeBuildPhase, *this);
+
         return tree;
     }
 
@@ -0,0 +1,300 @@
+/*
+    Copyright (C) 2011 Emmanuel Teisaire, Nicolás Bombau, Carlos Castro, Damián Domé, FuDePAN
+
+    This file is part of the Phyloloc project.
+
+    Phyloloc is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Phyloloc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef INCREMENTAL_CONSENSOR_H
+#define INCREMENTAL_CONSENSOR_H
+
+#include <algorithm>
+#include <vector>
+#include <mili/mili.h>
+#include "phylopp/Domain/ITree.h"
+#include "phylopp/Domain/LocationManager.h"
+#include "phylopp/Consensor/ClusterTable.h"
+#include "phylopp/Consensor/ClusterTree.h"
+#include "phylopp/Consensor/StrictConsensor.h"
+#include "phylopp/Comparison/Bipartitions.h"
+
+/**
+* MissingFrequenciesException
+* ------------------------
+* Description: Exception thrown when a majority consensus is asked to a
+* consensor that does not count every cluster
+*/
+DEFINE_SPECIFIC_EXCEPTION_TEXT(MissingFrequenciesException,
+                               ConsensorExceptionHierarchy,
+                               "Majority consensus needs the frequencies of every cluster");
+
+namespace Consensus
+{
+
+enum ConsensusRule
+{
+    // Only the clusters of the strict consensus are kept
+    StrictRule,
+    // Every cluster is counted, for strict and majority consensus
+    MajorityRule
+};
+
+/**
+* Class: IncrementalConsensor
+* ---------------------------
+* Description: Consensus of a growing set of trees. Every added tree is
+* intersected with the clusters in all the previous ones, and optionally
+* counted into a table of every cluster seen, so the consensus can be
+* built at any time without visiting the previous trees again. Like
+* StrictConsensor, each consensus cluster keeps the name and branch
+* length of its node with the smallest branch length.
+* Type Parameter Node2: the node class, derived from ConsensorAspect
+*/
+template <class Node2>
+class IncrementalConsensor
+{
+public:
+
+    IncrementalConsensor(const Locations::LocationManager& locationManager, ConsensusRule rule = StrictRule) :
+        locationManager(locationManager),
+        rule(rule),
+        trees(0)
+    {}
+
+    /**
+    * Method: addTree
+    * ---------------
+    * Description: Adds the clusters of a tree. The tree is not kept, and
+    * nothing changes if it can not be added.
+    * Throws: DuplicateNameException if two leaves have the same name,
+    * DisjointTerminalsException if its leaves differ from the previous ones
+    */
+    void addTree(const Domain::ITree<Node2>* tree)
+    {
+        std::vector<const Node2*> nodes;
+        std::vector<bitset> clusters;
+        Comparison::getClusters<Node2>(tree->getRoot(), locationManager, nodes, clusters);
+
+        validateTree(nodes, clusters);
+
+        //a strict consensor only needs the clusters of the first tree
+        const bool counting = rule == MajorityRule || trees == 0;
+        for (size_t i = 0; i < nodes.size(); i++)
+        {
+            const ClusterTable::Id id = counting ? table.insert(clusters[i]) : table.find(clusters[i]);
+            if (id != CLUSTER_NOT_FOUND)
+                record(id, nodes[i]);
+        }
+        trees++;
+
+        //keep the clusters that are also in this tree
+        std::vector<ClusterTable::Id> kept;
+        for (size_t i = 0; i < strict.size(); i++)
+        {
+            if (lastTrees[strict[i] - 1] == trees)
+                kept.push_back(strict[i]);
+        }
+        strict.swap(kept);
+    }
+
+    size_t getTreeCount() const
+    {
+        return trees;
+    }
+
+    /**
+    * Method: strictConsensus
+    * -----------------------
+    * Returns: A new tree with the clusters that are in every added tree
+    */
+    Domain::ITree<Node2>* strictConsensus() const
+    {
+        return buildTree(strict);
+    }
+
+    /**
+    * Method: majorityConsensus
+    * -------------------------
+    * Returns: A new tree with the clusters that are in more than a
+    * fraction of the added trees
+    * @param threshold the fraction, at least one half so that the
+    * clusters are compatible
+    */
+    Domain::ITree<Node2>* majorityConsensus(double threshold = 0.5) const
+    {
+        if (rule != MajorityRule)
+            throw MissingFrequenciesException();
+
+        //the root cluster, the first one, is always kept
+        std::vector<ClusterTable::Id> ids;
+        for (size_t i = 0; i < counts.size(); i++)
+        {
+            if (i == 0 || counts[i] > threshold * trees)
+                ids.push_back(ClusterTable::Id(i + 1));
+        }
+        return buildTree(ids);
+    }
+
+    /**
+    * Method: getFrequency
+    * --------------------
+    * Returns: The amount of added trees that have a cluster
+    */
+    size_t getFrequency(const bitset& cluster) const
+    {
+        const ClusterTable::Id id = table.find(cluster);
+        return id == CLUSTER_NOT_FOUND ? 0 : counts[id - 1];
+    }
+
+    void clear()
+    {
+        table.clear();
+        counts.clear();
+        lastTrees.clear();
+        names.clear();
+        lengths.clear();
+        strict.clear();
+        trees = 0;
+    }
+
+private:
+
+    const Locations::LocationManager& locationManager;
+    const ConsensusRule rule;
+    size_t trees;
+    ClusterTable table;
+    //per cluster id - 1: trees that have it, last of them, and representative node
+    std::vector<size_t> counts;
+    std::vector<size_t> lastTrees;
+    std::vector<Domain::NodeName> names;
+    std::vector<Domain::BranchLength> lengths;
+    //clusters in every tree, in the order of the first one
+    std::vector<ClusterTable::Id> strict;
+
+    void validateTree(const std::vector<const Node2*>& nodes, const std::vector<bitset>& clusters) const
+    {
+        size_t leaves = 0;
+        for (size_t i = 0; i < nodes.size(); i++)
+            leaves += nodes[i]->isLeaf() ? 1 : 0;
+
+        if (leaves != clusters[0].count())
+            throw DuplicateNameException();
+
+        //the root cluster is the first one interned
+        if (trees > 0)
+        {
+            bitset root;
+            table.getCluster(1, root);
+            if (root != clusters[0])
+                throw DisjointTerminalsException();
+        }
+    }
+
+    void record(ClusterTable::Id id, const Node2* node)
+    {
+        if (id > counts.size())
+        {
+            counts.push_back(0);
+            lastTrees.push_back(0);
+            names.push_back(node->getName());
+            lengths.push_back(node->getBranchLength());
+            if (trees == 0)
+                strict.push_back(id);
+        }
+
+        const size_t index = id - 1;
+        //unary nodes repeat the cluster of their child
+        if (lastTrees[index] != trees + 1)
+        {
+            lastTrees[index] = trees + 1;
+            counts[index]++;
+        }
+
+        if (node->getBranchLength() < lengths[index])
+        {
+            names[index] = node->getName();
+            lengths[index] = node->getBranchLength();
+        }
+    }
+
+    /**
+    * Class: LargerCluster
+    * --------------------
+    * Description: Orders clusters by descending size, so that every
+    * cluster comes after its ancestors
+    */
+    class LargerCluster
+    {
+    public:
+        LargerCluster(const std::vector<size_t>& sizes) :
+            sizes(sizes)
+        {}
+
+        bool operator()(size_t a, size_t b) const
+        {
+            return sizes[a] > sizes[b];
+        }
+
+    private:
+        const std::vector<size_t>& sizes;
+    };
+
+    Domain::ITree<Node2>* buildTree(const std::vector<ClusterTable::Id>& ids) const
+    {
+        if (trees == 0)
+            throw EmptyTreeCollectionException();
+
+        std::vector<bitset> clusters(ids.size());
+        std::vector<size_t> sizes(ids.size());
+        std::vector<size_t> order(ids.size());
+        for (size_t i = 0; i < ids.size(); i++)
+        {
+            table.getCluster(ids[i], clusters[i]);
+            sizes[i] = clusters[i].count();
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), LargerCluster(sizes));
+
+        Domain::ITree<Node2>* const tree = new Domain::ITree<Node2>();
+        std::vector<Node2*> nodes(ids.size(), NULL);
+
+        //the root cluster is in every tree
+        nodes[0] = tree->getRoot();
+        nodes[0]->cluster = clusters[order[0]];
+
+        for (size_t k = 1; k < order.size(); k++)
+        {
+            const bitset& cluster = clusters[order[k]];
+
+            //the parent is the closest larger cluster that holds this one
+            size_t parent = k - 1;
+            while (!cluster.isSubsetOf(clusters[order[parent]]))
+                parent--;
+
+            const size_t index = ids[order[k]] - 1;
+            nodes[k] = nodes[parent]->template addChild<Node2>();
+            nodes[k]->setName(names[index]);
+            nodes[k]->setBranchLength(lengths[index]);
+            nodes[k]->cluster = cluster;
+        }
+
+        return tree;
+    }
+};
+
+} // End of Namespace Consensus
+
+#endif
@@ -17,61 +17,282 @@
     along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+
 #ifndef MACRO_CONSENSOR_OBSERVER_H
 #define MACRO_CONSENSOR_OBSERVER_H
 
+#include <stddef.h>
+#include "phylopp/Domain/ITree.h"
+#include "phylopp/Domain/ITreeCollection.h"
 #include "phylopp/Consensor/bitset.h"
-#include "phylopp/Consensor/IConsensorObserver.h"
+#include "phylopp/Consensor/ObserverTraits.h"
 
 namespace Consensus
 {
+
+// Cluster events per batch
+static const size_t OBSERVER_BATCH_SIZE = 64;
+
+/**
+ * Class: NoObserver
+ * ----------------------
+ * Description: Fills the observer slots of a MacroConsensorObserver
+ * that are not used.
+ */
+class NoObserver
+{
+public:
+    template <class Collection>
+    void onStart(const Collection& /*trees*/)
+    {}
+
+    template <class Tree>
+    void onEnd(Tree* /*consensed*/)
+    {}
+};
+
+template <>
+struct ObserverTraits<NoObserver> : DefaultObserverTraits
+{
+    static const bool wants_cluster_events = false;
+};
+
+/**
+ * Struct: UnusedObserver
+ * ----------------------
+ * Description: Default argument for the slots of a MacroConsensorObserver
+ * that are left out. Only NoObserver slots may be left out.
+ */
+template <class Observer>
+struct UnusedObserver;
+
+template <>
+struct UnusedObserver<NoObserver>
+{
+    static NoObserver& get()
+    {
+        static NoObserver instance;
+        return instance;
+    }
+};
+
 /**
  * Class: MacroConsensorObserver
  * ----------------------
  * Description: Macro observer to be used when multiple consensor
- * observers are needed.
- * Type Parameter T: T is the underlying node class
+ * observers are needed. Events are sent to up to four observers, chosen
+ * at compile time, without virtual calls nor heap allocations per event;
+ * each observer only gets the events its ObserverTraits ask for.
+ * Cluster events for observers that want batches are copied into
+ * arrays of OBSERVER_BATCH_SIZE events, which are sent when full, at the
+ * end of each phase and at the end of the consensus. The arrays are part
+ * of the macro observer, and their clusters reuse their memory once it
+ * has grown to the cluster size.
+ * Type Parameter Node: Node is the underlying node class
+ * Type Parameters Observer1..4: observer classes, NoObserver when unused
  */
-//TODO: DO
-/* template <class T>
- class MacroConsensorObserver : public IConsensorObserver<T>
- {
- private:
+template <class Node, class Observer1, class Observer2 = NoObserver,
+          class Observer3 = NoObserver, class Observer4 = NoObserver>
+class MacroConsensorObserver
+{
+public:
 
-     std::vector<IConsensorObserver>
+    static const bool wants_cluster_events =
+        ObserverTraits<Observer1>::wants_cluster_events ||
+        ObserverTraits<Observer2>::wants_cluster_events ||
+        ObserverTraits<Observer3>::wants_cluster_events ||
+        ObserverTraits<Observer4>::wants_cluster_events;
 
- public:
+    static const bool batches_cluster_events =
+        WantsClusterBatches<Observer1>::value ||
+        WantsClusterBatches<Observer2>::value ||
+        WantsClusterBatches<Observer3>::value ||
+        WantsClusterBatches<Observer4>::value;
 
+    //phase ends are needed to send the batches
+    static const bool wants_phase_events =
+        ObserverTraits<Observer1>::wants_phase_events ||
+        ObserverTraits<Observer2>::wants_phase_events ||
+        ObserverTraits<Observer3>::wants_phase_events ||
+        ObserverTraits<Observer4>::wants_phase_events ||
+        batches_cluster_events;
 
-     virtual void onStart(const ITreeCollection<Node>& trees)
-     {}
+    MacroConsensorObserver(Observer1& observer1,
+                           Observer2& observer2 = UnusedObserver<Observer2>::get(),
+                           Observer3& observer3 = UnusedObserver<Observer3>::get(),
+                           Observer4& observer4 = UnusedObserver<Observer4>::get()) :
+        observer1(observer1),
+        observer2(observer2),
+        observer3(observer3),
+        observer4(observer4)
+    {}
 
-     /**
-      * Method: notifyInclude
-      * ---------------
-      * Description: Notifies when a node is included in the consensed tree.
-      * @param node node that has been included in the consensed tree
-      */
-/*virtual void onInclude(Node* node, const bitset& cluster)
-{
+    void onStart(const Domain::ITreeCollection<Node>& trees)
+    {
+        observer1.onStart(trees);
+        observer2.onStart(trees);
+        observer3.onStart(trees);
+        observer4.onStart(trees);
+    }
 
-}
+    /**
+     * Method: onInclude
+     * ---------------
+     * Description: Sends the event to the observers that want it one by
+     * one, and adds it to the batch of the rest.
+     */
+    void onInclude(Node* node, const bitset& cluster)
+    {
+        SingleEvents<Observer1>::include(observer1, node, cluster);
+        SingleEvents<Observer2>::include(observer2, node, cluster);
+        SingleEvents<Observer3>::include(observer3, node, cluster);
+        SingleEvents<Observer4>::include(observer4, node, cluster);
 
-/**
- * Method: notifyExclude
- * ---------------
- * Description: Notifies when a node is excluded in the consensed tree.
- * @param node node that has been excluded in the consensed tree
- */
-/* virtual void onExclude(Node* node, const bitset& cluster)
- {
+        if (batches_cluster_events && included.add(node, cluster))
+            flushIncluded();
+    }
+
+    void onExclude(Node* node, const bitset& cluster)
+    {
+        SingleEvents<Observer1>::exclude(observer1, node, cluster);
+        SingleEvents<Observer2>::exclude(observer2, node, cluster);
+        SingleEvents<Observer3>::exclude(observer3, node, cluster);
+        SingleEvents<Observer4>::exclude(observer4, node, cluster);
+
+        if (batches_cluster_events && excluded.add(node, cluster))
+            flushExcluded();
+    }
+
+    void onPhaseBegin(ConsensusPhase phase)
+    {
+        PhaseEvents<Observer1>::begin(observer1, phase);
+        PhaseEvents<Observer2>::begin(observer2, phase);
+        PhaseEvents<Observer3>::begin(observer3, phase);
+        PhaseEvents<Observer4>::begin(observer4, phase);
+    }
+
+    void onPhaseEnd(ConsensusPhase phase, size_t clusters)
+    {
+        const ClusterCount count(clusters);
+
+        flush();
+        PhaseEvents<Observer1>::end(observer1, phase, count);
+        PhaseEvents<Observer2>::end(observer2, phase, count);
+        PhaseEvents<Observer3>::end(observer3, phase, count);
+        PhaseEvents<Observer4>::end(observer4, phase, count);
+    }
+
+    void onEnd(Domain::ITree<Node>* consensed)
+    {
+        flush();
+        observer1.onEnd(consensed);
+        observer2.onEnd(consensed);
+        observer3.onEnd(consensed);
+        observer4.onEnd(consensed);
+    }
+
+    /**
+     * Method: flush
+     * ---------------
+     * Description: Sends the pending batches
+     */
+    void flush()
+    {
+        if (batches_cluster_events)
+        {
+            flushIncluded();
+            flushExcluded();
+        }
+    }
+
+private:
+
+    template <class Observer>
+    struct SingleEvents :
+        ClusterEvents<Observer, ObserverTraits<Observer>::wants_cluster_events && !WantsClusterBatches<Observer>::value>
+    {};
+
+    template <class Observer>
+    struct Batches :
+        BatchEvents<Observer, WantsClusterBatches<Observer>::value>
+    {};
 
- }
+    struct EventBatch
+    {
+        Node* nodes[OBSERVER_BATCH_SIZE];
+        bitset clusters[OBSERVER_BATCH_SIZE];
+        size_t count;
 
- virtual void onEnd(const ITree<Node>& consensed)
- {
+        EventBatch() :
+            count(0)
+        {}
 
- }*/
+        // Returns true when the batch gets full
+        bool add(Node* node, const bitset& cluster)
+        {
+            nodes[count] = node;
+            clusters[count] = cluster;
+            ++count;
+            return count == OBSERVER_BATCH_SIZE;
+        }
+    };
 
+    struct ClusterCount
+    {
+        size_t count;
+
+        explicit ClusterCount(size_t c) :
+            count(c)
+        {}
+
+        size_t getClusterCount() const
+        {
+            return count;
+        }
+    };
+
+    Observer1& observer1;
+    Observer2& observer2;
+    Observer3& observer3;
+    Observer4& observer4;
+    EventBatch included;
+    EventBatch excluded;
+
+    void flushIncluded()
+    {
+        if (included.count > 0)
+        {
+            Batches<Observer1>::include(observer1, included.nodes, included.clusters, included.count);
+            Batches<Observer2>::include(observer2, included.nodes, included.clusters, included.count);
+            Batches<Observer3>::include(observer3, included.nodes, included.clusters, included.count);
+            Batches<Observer4>::include(observer4, included.nodes, included.clusters, included.count);
+            included.count = 0;
+        }
+    }
+
+    void flushExcluded()
+    {
+        if (excluded.count > 0)
+        {
+            Batches<Observer1>::exclude(observer1, excluded.nodes, excluded.clusters, excluded.count);
+            Batches<Observer2>::exclude(observer2, excluded.nodes, excluded.clusters, excluded.count);
+            Batches<Observer3>::exclude(observer3, excluded.nodes, excluded.clusters, excluded.count);
+            Batches<Observer4>::exclude(observer4, excluded.nodes, excluded.clusters, excluded.count);
+            excluded.count = 0;
+        }
+    }
 };
-}
+
+template <class Node, class Observer1, class Observer2, class Observer3, class Observer4>
+struct ObserverTraits<MacroConsensorObserver<Node, Observer1, Observer2, Observer3, Observer4> > :
+    DefaultObserverTraits
+{
+    typedef MacroConsensorObserver<Node, Observer1, Observer2, Observer3, Observer4> Macro;
+
+    static const bool wants_cluster_events = Macro::wants_cluster_events;
+    static const bool wants_phase_events = Macro::wants_phase_events;
+};
+
+} // End of Namespace Consensus
+
+#endif
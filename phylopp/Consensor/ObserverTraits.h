@@ -0,0 +1,193 @@
+/*
+    Copyright (C) 2011 Emmanuel Teisaire, Nicolás Bombau, Carlos Castro, Damián Domé, FuDePAN
+
+    This file is part of the Phyloloc project.
+
+    Phyloloc is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Phyloloc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef OBSERVER_TRAITS_H
+#define OBSERVER_TRAITS_H
+
+#include <stddef.h>
+
+namespace Consensus
+{
+
+/**
+* Enum: ConsensusPhase
+* --------------------
+* Description: Steps of a consensus run. ClusterExtractionPhase happens
+* once per tree, IntersectionPhase once per tree after the first one.
+*/
+enum ConsensusPhase
+{
+    ClusterExtractionPhase,
+    IntersectionPhase,
+    SortPhase,
+    TreeBuildPhase
+};
+
+static const size_t CONSENSUS_PHASES = TreeBuildPhase + 1;
+
+/**
+* Struct: DefaultObserverTraits
+* -----------------------------
+* Description: Compile time properties of a consensor observer.
+* wants_cluster_events: the observer gets onInclude and onExclude for
+* every cluster. Observers that ignore them should set it to false, so
+* that the per cluster calls are compiled away.
+* wants_phase_events: the observer gets onPhaseBegin(phase) and
+* onPhaseEnd(phase, clusters) around each phase, where clusters is the
+* size of the cluster list at the end of the phase.
+* wants_cluster_batches: when the observer is part of a
+* MacroConsensorObserver, it gets its cluster events in arrays, through
+* onIncludeBatch(nodes, clusters, count) and onExcludeBatch(nodes,
+* clusters, count), instead of one call per cluster.
+* Observers do not need the methods of the events they do not want.
+*/
+struct DefaultObserverTraits
+{
+    static const bool wants_cluster_events = true;
+    static const bool wants_phase_events = false;
+    static const bool wants_cluster_batches = false;
+};
+
+/**
+* Struct: ObserverTraits
+* ----------------------
+* Description: Traits of each observer. Specialize it deriving from
+* DefaultObserverTraits, and redefine the properties that differ.
+*/
+template <class Observer>
+struct ObserverTraits : DefaultObserverTraits
+{};
+
+/**
+* Struct: ClusterEvents
+* ---------------------
+* Description: Sends the cluster events to the observers that want them,
+* and compiles to nothing for the rest.
+*/
+template <class Observer, bool Wanted = ObserverTraits<Observer>::wants_cluster_events>
+struct ClusterEvents
+{
+    template <class Node, class Cluster>
+    static void include(Observer& /*observer*/, Node* /*node*/, const Cluster& /*cluster*/)
+    {}
+
+    template <class Node, class Cluster>
+    static void exclude(Observer& /*observer*/, Node* /*node*/, const Cluster& /*cluster*/)
+    {}
+};
+
+template <class Observer>
+struct ClusterEvents<Observer, true>
+{
+    template <class Node, class Cluster>
+    static void include(Observer& observer, Node* node, const Cluster& cluster)
+    {
+        observer.onInclude(node, cluster);
+    }
+
+    template <class Node, class Cluster>
+    static void exclude(Observer& observer, Node* node, const Cluster& cluster)
+    {
+        observer.onExclude(node, cluster);
+    }
+};
+
+/**
+* Struct: PhaseEvents
+* -------------------
+* Description: Sends the phase events to the observers that want them,
+* and compiles to nothing for the rest. The clusters are only counted
+* when the event is sent.
+*/
+template <class Observer, bool Wanted = ObserverTraits<Observer>::wants_phase_events>
+struct PhaseEvents
+{
+    static void begin(Observer& /*observer*/, ConsensusPhase /*phase*/)
+    {}
+
+    template <class Clusters>
+    static void end(Observer& /*observer*/, ConsensusPhase /*phase*/, const Clusters& /*clusters*/)
+    {}
+};
+
+template <class Observer>
+struct PhaseEvents<Observer, true>
+{
+    static void begin(Observer& observer, ConsensusPhase phase)
+    {
+        observer.onPhaseBegin(phase);
+    }
+
+    template <class Clusters>
+    static void end(Observer& observer, ConsensusPhase phase, const Clusters& clusters)
+    {
+        observer.onPhaseEnd(phase, clusters.getClusterCount());
+    }
+};
+
+/**
+* Struct: WantsClusterBatches
+* ---------------------------
+* Description: Whether the observer gets its cluster events in batches
+*/
+template <class Observer>
+struct WantsClusterBatches
+{
+    static const bool value = ObserverTraits<Observer>::wants_cluster_events &&
+                              ObserverTraits<Observer>::wants_cluster_batches;
+};
+
+/**
+* Struct: BatchEvents
+* -------------------
+* Description: Sends arrays of cluster events to the observers that want
+* batches, and compiles to nothing for the rest.
+*/
+template <class Observer, bool Wanted = WantsClusterBatches<Observer>::value>
+struct BatchEvents
+{
+    template <class Node, class Cluster>
+    static void include(Observer& /*observer*/, Node* const* /*nodes*/, const Cluster* /*clusters*/, size_t /*count*/)
+    {}
+
+    template <class Node, class Cluster>
+    static void exclude(Observer& /*observer*/, Node* const* /*nodes*/, const Cluster* /*clusters*/, size_t /*count*/)
+    {}
+};
+
+template <class Observer>
+struct BatchEvents<Observer, true>
+{
+    template <class Node, class Cluster>
+    static void include(Observer& observer, Node* const* nodes, const Cluster* clusters, size_t count)
+    {
+        observer.onIncludeBatch(nodes, clusters, count);
+    }
+
+    template <class Node, class Cluster>
+    static void exclude(Observer& observer, Node* const* nodes, const Cluster* clusters, size_t count)
+    {
+        observer.onExcludeBatch(nodes, clusters, count);
+    }
+};
+
+} // End of Namespace Consensus
+
+#endif
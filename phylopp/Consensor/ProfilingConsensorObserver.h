@@ -0,0 +1,314 @@
+/*
+    Copyright (C) 2011 Emmanuel Teisaire, Nicolás Bombau, Carlos Castro, Damián Domé, FuDePAN
+
+    This file is part of the Phyloloc project.
+
+    Phyloloc is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Phyloloc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef PROFILING_CONSENSOR_OBSERVER_H
+#define PROFILING_CONSENSOR_OBSERVER_H
+
+#include <time.h>
+#include <pthread.h>
+#include <vector>
+#include <ostream>
+#include "phylopp/Domain/ITree.h"
+#include "phylopp/Domain/ITreeCollection.h"
+#include "phylopp/Consensor/bitset.h"
+#include "phylopp/Consensor/ObserverTraits.h"
+
+namespace Consensus
+{
+
+/**
+* Class: ProfilingConsensorObserver
+* ---------------------------------
+* Description: Observer that measures a consensus run: the wall time of
+* each phase, the extraction time of every tree, the amount of included
+* and excluded clusters and the peak size of the cluster list. Every
+* thread counts in its own block, so one observer can be shared by
+* consensus runs in several threads; the blocks are added up when read.
+* Type Parameter Node: Node is the underlying node class
+*/
+template <class Node>
+class ProfilingConsensorObserver
+{
+public:
+
+    ProfilingConsensorObserver()
+    {
+        pthread_key_create(&countersKey, NULL);
+        pthread_mutex_init(&mutex, NULL);
+    }
+
+    ~ProfilingConsensorObserver()
+    {
+        for (size_t i = 0; i < allCounters.size(); i++)
+            delete allCounters[i];
+        pthread_key_delete(countersKey);
+        pthread_mutex_destroy(&mutex);
+    }
+
+    void onStart(const Domain::ITreeCollection<Node>& collection)
+    {
+        Counters& counters = getCounters();
+        counters.trees += collection.getIterator().count();
+        clock_gettime(CLOCK_MONOTONIC, &counters.runStart);
+    }
+
+    void onInclude(const Node* const /*node*/, const bitset& /*cluster*/)
+    {
+        ++getCounters().included;
+    }
+
+    void onExclude(const Node* const /*node*/, const bitset& /*cluster*/)
+    {
+        ++getCounters().excluded;
+    }
+
+    void onEnd(Domain::ITree<Node>* /*consensed*/)
+    {
+        timespec end;
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        Counters& counters = getCounters();
+        counters.totalTime += elapsed(counters.runStart, end);
+    }
+
+    void onPhaseBegin(ConsensusPhase phase)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &getCounters().phaseStarts[phase]);
+    }
+
+    void onPhaseEnd(ConsensusPhase phase, size_t clusters)
+    {
+        timespec end;
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        Counters& counters = getCounters();
+        const double time = elapsed(counters.phaseStarts[phase], end);
+
+        counters.phaseTimes[phase] += time;
+        if (phase == ClusterExtractionPhase)
+            counters.extractionTimes.push_back(time);
+        if (clusters > counters.peakClusters)
+            counters.peakClusters = clusters;
+    }
+
+    /**
+    * Method: getPhaseTime
+    * --------------------
+    * Returns: The seconds spent in the phase, over all runs and threads
+    */
+    double getPhaseTime(ConsensusPhase phase) const
+    {
+        double time = 0.0;
+        lock();
+        for (size_t i = 0; i < allCounters.size(); i++)
+            time += allCounters[i]->phaseTimes[phase];
+        unlock();
+        return time;
+    }
+
+    /**
+    * Method: getExtractionTimes
+    * --------------------------
+    * Description: Gets the seconds spent extracting the clusters of each
+    * tree, in the order the trees were processed by each thread
+    */
+    void getExtractionTimes(std::vector<double>& times) const
+    {
+        times.clear();
+        lock();
+        for (size_t i = 0; i < allCounters.size(); i++)
+            times.insert(times.end(), allCounters[i]->extractionTimes.begin(), allCounters[i]->extractionTimes.end());
+        unlock();
+    }
+
+    size_t getIncludedCount() const
+    {
+        size_t count = 0;
+        lock();
+        for (size_t i = 0; i < allCounters.size(); i++)
+            count += allCounters[i]->included;
+        unlock();
+        return count;
+    }
+
+    size_t getExcludedCount() const
+    {
+        size_t count = 0;
+        lock();
+        for (size_t i = 0; i < allCounters.size(); i++)
+            count += allCounters[i]->excluded;
+        unlock();
+        return count;
+    }
+
+    size_t getPeakClusterCount() const
+    {
+        size_t peak = 0;
+        lock();
+        for (size_t i = 0; i < allCounters.size(); i++)
+        {
+            if (allCounters[i]->peakClusters > peak)
+                peak = allCounters[i]->peakClusters;
+        }
+        unlock();
+        return peak;
+    }
+
+    /**
+    * Method: getTotalTime
+    * --------------------
+    * Returns: The seconds from onStart to onEnd, over all runs
+    */
+    double getTotalTime() const
+    {
+        double time = 0.0;
+        lock();
+        for (size_t i = 0; i < allCounters.size(); i++)
+            time += allCounters[i]->totalTime;
+        unlock();
+        return time;
+    }
+
+    /**
+    * Method: getTreeCount
+    * --------------------
+    * Returns: The amount of trees consensed, over all runs
+    */
+    size_t getTreeCount() const
+    {
+        size_t count = 0;
+        lock();
+        for (size_t i = 0; i < allCounters.size(); i++)
+            count += allCounters[i]->trees;
+        unlock();
+        return count;
+    }
+
+    /**
+    * Method: writeReport
+    * -------------------
+    * Description: Writes the measures as a JSON object. Times are in
+    * seconds.
+    */
+    void writeReport(std::ostream& os) const
+    {
+        static const char* const PHASE_NAMES[CONSENSUS_PHASES] =
+        {
+            "extraction", "intersection", "sort", "build"
+        };
+        std::vector<double> extractionTimes;
+        getExtractionTimes(extractionTimes);
+
+        os << "{\n  \"trees\": " << getTreeCount()
+           << ",\n  \"total\": " << getTotalTime()
+           << ",\n  \"phases\": {";
+        for (size_t phase = 0; phase < CONSENSUS_PHASES; phase++)
+        {
+            os << (phase == 0 ? "" : ", ") << '"' << PHASE_NAMES[phase] << "\": "
+               << getPhaseTime(ConsensusPhase(phase));
+        }
+        os << "},\n  \"extraction_per_tree\": [";
+        for (size_t i = 0; i < extractionTimes.size(); i++)
+            os << (i == 0 ? "" : ", ") << extractionTimes[i];
+        os << "],\n  \"included_clusters\": " << getIncludedCount()
+           << ",\n  \"excluded_clusters\": " << getExcludedCount()
+           << ",\n  \"peak_clusters\": " << getPeakClusterCount()
+           << "\n}\n";
+    }
+
+private:
+
+    struct Counters
+    {
+        size_t trees;
+        double totalTime;
+        timespec runStart;
+        size_t included;
+        size_t excluded;
+        size_t peakClusters;
+        double phaseTimes[CONSENSUS_PHASES];
+        timespec phaseStarts[CONSENSUS_PHASES];
+        std::vector<double> extractionTimes;
+
+        Counters() :
+            trees(0),
+            totalTime(0.0),
+            included(0),
+            excluded(0),
+            peakClusters(0)
+        {
+            for (size_t i = 0; i < CONSENSUS_PHASES; i++)
+                phaseTimes[i] = 0.0;
+        }
+    };
+
+    pthread_key_t countersKey;
+    mutable pthread_mutex_t mutex;
+    //the blocks of every thread, deleted with the observer
+    std::vector<Counters*> allCounters;
+
+    ProfilingConsensorObserver(const ProfilingConsensorObserver&);
+    ProfilingConsensorObserver& operator=(const ProfilingConsensorObserver&);
+
+    /**
+    * Method: getCounters
+    * -------------------
+    * Returns: The block of the calling thread, created on its first event
+    */
+    Counters& getCounters()
+    {
+        Counters* counters = static_cast<Counters*>(pthread_getspecific(countersKey));
+
+        if (counters == NULL)
+        {
+            counters = new Counters;
+            lock();
+            allCounters.push_back(counters);
+            unlock();
+            pthread_setspecific(countersKey, counters);
+        }
+        return *counters;
+    }
+
+    void lock() const
+    {
+        pthread_mutex_lock(&mutex);
+    }
+
+    void unlock() const
+    {
+        pthread_mutex_unlock(&mutex);
+    }
+
+    static double elapsed(const timespec& from, const timespec& to)
+    {
+        return double(to.tv_sec - from.tv_sec) + double(to.tv_nsec - from.tv_nsec) * 1e-9;
+    }
+};
+
+template <class Node>
+struct ObserverTraits<ProfilingConsensorObserver<Node> > : DefaultObserverTraits
+{
+    static const bool wants_phase_events = true;
+};
+
+} // End of Namespace Consensus
+
+#endif
@@ -25,7 +25,9 @@
 #include "phylopp/Domain/ITreeCollection.h"
 #include "phylopp/Traversal/NodeVisitor.h"
 #include "phylopp/Traversal/Traverser.h"
+#include "phylopp/Consensor/ObserverTraits.h"
 #include "phylopp/Consensor/ClusterTree.h"
+#include "phylopp/Consensor/TaxonIndex.h"
 
 class StrictConsensorExceptionHierarchy {};
 typedef mili::GenericException<StrictConsensorExceptionHierarchy> StrictConsensorException;
@@ -106,6 +108,40 @@ public:
     Domain::ITree<Node2>* consensus(Domain::ITreeCollection<Node2>& trees,
                                     Observer& observer,
                                     Locations::LocationManager& locManager)
+    {
+        return consense(trees, observer, locManager, NULL);
+    }
+
+    /**
+    * Method: commonLeavesConsensus
+    * -----------------------------
+    * Description: Consensus of trees over overlapping sets of taxa,
+    * restricted to the leaves that are in every tree. Clusters are only
+    * as wide as the amount of taxa in the collection.
+    * @param taxonIndex receives the index of the taxa of the collection,
+    * which numbers the bits of the clusters of the consensus
+    * @return the consensus, or throws DisjointTerminalsException if no
+    * leaf is in every tree
+    */
+    Domain::ITree<Node2>* commonLeavesConsensus(Domain::ITreeCollection<Node2>& trees,
+                                                Observer& observer,
+                                                Locations::LocationManager& locManager,
+                                                TaxonIndex& taxonIndex)
+    {
+        taxonIndex.build(trees, locManager);
+
+        if (taxonIndex.getCommonLeaves().count() == 0 && trees.getIterator().count() > 0)
+            throw DisjointTerminalsException();
+
+        return consense(trees, observer, locManager, &taxonIndex);
+    }
+
+private:
+
+    Domain::ITree<Node2>* consense(Domain::ITreeCollection<Node2>& trees,
+                                   Observer& observer,
+                                   Locations::LocationManager& locManager,
+                                   const TaxonIndex* taxonIndex)
     {
         unsigned int i = 0;
         observer.onStart(trees);
@@ -113,7 +149,9 @@ public:
 
         validateCollection(trees);
 
-        ClusterTree<Node2, Observer> first(trees.elementAt(i), observer, locManager);
+        PhaseEvents<Observer>::begin(observer, ClusterExtractionPhase);
+        ClusterTree<Node2, Observer> first(trees.elementAt(i), observer, locManager, taxonIndex);
+        PhaseEvents<Observer>::end(observer, ClusterExtractionPhase, first);
 
         ClusterTree<Node2, Observer> consensusCluster(first, observer, locManager);
 
@@ -123,8 +161,13 @@ public:
             i++;
             for (; i < it.count() && !it.end(); ++i, it.next())
             {
-                ClusterTree<Node2, Observer> current(trees.elementAt(i), observer, locManager);
+                PhaseEvents<Observer>::begin(observer, ClusterExtractionPhase);
+                ClusterTree<Node2, Observer> current(trees.elementAt(i), observer, locManager, taxonIndex);
+                PhaseEvents<Observer>::end(observer, ClusterExtractionPhase, current);
+
+                PhaseEvents<Observer>::begin(observer, IntersectionPhase);
                 consensusCluster.intersectWith(current);
+                PhaseEvents<Observer>::end(observer, IntersectionPhase, consensusCluster);
             }
         }
 
@@ -134,8 +177,6 @@ public:
         return consensedTree;
     }
 
-private:
-
     static void validateCollection(const Domain::ITreeCollection<Node2>& trees)
     {
         Domain::ListIterator<Domain::ITree<Node2> > treesIter = trees.getIterator();
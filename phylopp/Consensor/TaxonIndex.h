@@ -0,0 +1,161 @@
+/*
+    Copyright (C) 2011 Emmanuel Teisaire, Nicolás Bombau, Carlos Castro, Damián Domé, FuDePAN
+
+    This file is part of the Phyloloc project.
+
+    Phyloloc is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Phyloloc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef TAXON_INDEX_H
+#define TAXON_INDEX_H
+
+#include <vector>
+#include "phylopp/Domain/ITree.h"
+#include "phylopp/Domain/ITreeCollection.h"
+#include "phylopp/Domain/LocationManager.h"
+#include "phylopp/Consensor/bitset.h"
+
+namespace Consensus
+{
+
+// Taxon of the node names that are not in any tree of the index
+static const size_t NO_TAXON = static_cast<size_t>(-1);
+
+/**
+* Class: TaxonIndex
+* -----------------
+* Description: Numbers the leaf names that appear in a tree collection
+* with consecutive taxa starting at zero, in node name id order, so that
+* clusters over the collection need only as many bits as it has taxa
+* rather than one per name of the location manager. It also holds the
+* leaves of every tree as a mask over those taxa, and the leaves common
+* to every tree. Names unknown to the location manager are not indexed.
+*/
+class TaxonIndex
+{
+public:
+
+    /**
+    * Method: build
+    * -------------
+    * Description: Indexes the leaves of every tree of a collection
+    */
+    template <class T>
+    void build(const Domain::ITreeCollection<T>& trees, const Locations::LocationManager& locationManager)
+    {
+        std::vector<std::vector<Locations::NodeNameId> > treeLeaves;
+        std::vector<const T*> leaves;
+
+        taxa.assign(locationManager.getNodeNameCount() + 1, NO_TAXON);
+        nameIds.clear();
+
+        for (typename Domain::ITreeCollection<T>::iterator it = trees.getIterator(); !it.end(); it.next())
+        {
+            it.get()->getLeaves(leaves);
+            treeLeaves.push_back(std::vector<Locations::NodeNameId>());
+            for (size_t i = 0; i < leaves.size(); i++)
+            {
+                const Locations::NodeNameId id = locationManager.getNodeNameId(leaves[i]->getName());
+                treeLeaves.back().push_back(id);
+                if (id != Locations::NAME_NOT_FOUND)
+                    taxa[id] = 0;
+            }
+        }
+
+        for (Locations::NodeNameId id = 1; id < taxa.size(); id++)
+        {
+            if (taxa[id] != NO_TAXON)
+            {
+                taxa[id] = nameIds.size();
+                nameIds.push_back(id);
+            }
+        }
+
+        masks.assign(treeLeaves.size(), bitset(nameIds.size()));
+        common = bitset(nameIds.size());
+        common.set();
+        for (size_t t = 0; t < treeLeaves.size(); t++)
+        {
+            for (size_t i = 0; i < treeLeaves[t].size(); i++)
+            {
+                if (treeLeaves[t][i] != Locations::NAME_NOT_FOUND)
+                    masks[t].set(taxa[treeLeaves[t][i]]);
+            }
+            common &= masks[t];
+        }
+    }
+
+    /**
+    * Method: getTaxonCount
+    * ---------------------
+    * Returns: The amount of taxa, that is, the width of the masks
+    */
+    size_t getTaxonCount() const
+    {
+        return nameIds.size();
+    }
+
+    /**
+    * Method: getTaxon
+    * ----------------
+    * Returns: The taxon of a node name id, or NO_TAXON
+    */
+    size_t getTaxon(Locations::NodeNameId id) const
+    {
+        return id < taxa.size() ? taxa[id] : NO_TAXON;
+    }
+
+    /**
+    * Method: getNodeNameId
+    * ---------------------
+    * Returns: The node name id of a taxon
+    */
+    Locations::NodeNameId getNodeNameId(size_t taxon) const
+    {
+        return nameIds[taxon];
+    }
+
+    /**
+    * Method: getLeafMask
+    * -------------------
+    * Returns: The leaves of a tree, by its position in the collection
+    */
+    const bitset& getLeafMask(size_t tree) const
+    {
+        return masks[tree];
+    }
+
+    /**
+    * Method: getCommonLeaves
+    * -----------------------
+    * Returns: The leaves that are in every tree
+    */
+    const bitset& getCommonLeaves() const
+    {
+        return common;
+    }
+
+private:
+    //taxon of each node name id
+    std::vector<size_t> taxa;
+    //node name id of each taxon
+    std::vector<Locations::NodeNameId> nameIds;
+    std::vector<bitset> masks;
+    bitset common;
+};
+
+} // End of Namespace Consensus
+
+#endif
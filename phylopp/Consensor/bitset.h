@@ -21,14 +21,23 @@
 #define BITSET_H
 
 #include <cstdlib>
+#include <stdint.h>
 #include <vector>
 
 namespace Consensus
 {
+/**
+* Class: bitset
+* -------------
+* Description: Dynamically sized set of bits, packed in 64 bit words.
+* Bits past the size are always kept clear.
+*/
 class bitset
 {
 public:
 
+    typedef uint64_t Word;
+
     class bit
     {
     private:
@@ -65,6 +74,7 @@ public:
 
     void resize(size_t n, const bit& value = bit::false_bit);
     void clear();
+    void swap(bitset& b);
 
     bitset& operator&=(const bitset& b);
     bitset& operator|=(const bitset& b);
@@ -94,10 +104,45 @@ public:
 
     size_t size() const;
     bool empty() const;
+
+    /**
+    * Method: count
+    * -------------
+    * Returns: The amount of bits set
+    */
+    size_t count() const;
+
+    /**
+    * Method: isSubsetOf
+    * ------------------
+    * Returns: Whether every bit set is also set in b, of the same size
+    */
+    bool isSubsetOf(const bitset& b) const;
+
+    /**
+    * Method: hash
+    * ------------
+    * Returns: A hash of the bits, equal for equal bitsets
+    */
+    size_t hash() const;
+
+    /**
+    * Method: getWord
+    * ---------------
+    * Description: Raw access to the words, for serialization. Bit i is
+    * bit i % 64 of word i / 64.
+    */
+    size_t wordCount() const;
+    Word getWord(size_t index) const;
+    void setWord(size_t index, Word word);
+
     void print();
 
 private:
-    std::vector<bitset::bit> bits;
+    std::vector<Word> words;
+    size_t bitCount;
+
+    void clearUnusedBits();
 };
 
 bool operator==(const bitset& a, const bitset& b);
@@ -0,0 +1,289 @@
+/*
+    Copyright (C) 2011 Emmanuel Teisaire, Nicolás Bombau, Carlos Castro, Damián Domé, FuDePAN
+
+    This file is part of the Phyloloc project.
+
+    Phyloloc is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Phyloloc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DELIMITED_TEXT_SCANNER_H
+#define DELIMITED_TEXT_SCANNER_H
+
+#include <cstring>
+#include <cstdlib>
+#include <string>
+
+namespace DataSource
+{
+
+/**
+* Class: FieldView
+* ----------------
+* Description: A field of a delimited text line. It points into the
+* scanned buffer, so it is only valid while the buffer is.
+*/
+struct FieldView
+{
+    const char* begin;
+    const char* end;
+
+    FieldView() :
+        begin(NULL),
+        end(NULL)
+    {}
+
+    size_t size() const
+    {
+        return end - begin;
+    }
+
+    bool empty() const
+    {
+        return begin == end;
+    }
+
+    /**
+    * Method: assignTo
+    * ----------------
+    * Description: Copies the field into a string, reusing its storage
+    */
+    void assignTo(std::string& s) const
+    {
+        s.assign(begin, end);
+    }
+
+    std::string str() const
+    {
+        return std::string(begin, end);
+    }
+};
+
+/**
+* Class: DelimitedTextScanner
+* ---------------------------
+* Description: Splits an in-memory text buffer in lines, and lines in
+* whitespace-trimmed fields, without allocating. Lines and delimiters
+* are searched with memchr, which the C library implements with
+* vector instructions.
+*/
+class DelimitedTextScanner
+{
+public:
+
+    // Fields beyond this count are counted but not stored
+    static const size_t MAX_FIELDS = 8;
+
+    DelimitedTextScanner(const char* begin, const char* end, char delimiter) :
+        cursor(begin),
+        bufferEnd(end),
+        delimiter(delimiter),
+        fieldsCount(0),
+        currentLineNumber(0)
+    {}
+
+    /**
+    * Method: nextLine
+    * ----------------
+    * Description: Moves to the next line and splits it in fields.
+    * An empty line has a single empty field.
+    * @return false when there are no more lines
+    */
+    bool nextLine()
+    {
+        if (cursor == NULL || cursor >= bufferEnd)
+            return false;
+
+        const char* lineEnd = static_cast<const char*>(memchr(cursor, '\n', bufferEnd - cursor));
+        const char* next = (lineEnd == NULL) ? bufferEnd : lineEnd + 1;
+        if (lineEnd == NULL)
+            lineEnd = bufferEnd;
+
+        splitLine(cursor, lineEnd);
+
+        cursor = next;
+        currentLineNumber++;
+        return true;
+    }
+
+    size_t fieldCount() const
+    {
+        return fieldsCount;
+    }
+
+    const FieldView& field(size_t index) const
+    {
+        return fields[index];
+    }
+
+    unsigned int lineNumber() const
+    {
+        return currentLineNumber;
+    }
+
+private:
+    const char* cursor;
+    const char* bufferEnd;
+    char delimiter;
+    FieldView fields[MAX_FIELDS];
+    size_t fieldsCount;
+    unsigned int currentLineNumber;
+
+    static bool isBlank(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    void splitLine(const char* begin, const char* end)
+    {
+        fieldsCount = 0;
+        const char* fieldBegin = begin;
+        bool moreFields = true;
+
+        while (moreFields)
+        {
+            const char* fieldEnd = static_cast<const char*>(memchr(fieldBegin, delimiter, end - fieldBegin));
+            moreFields = (fieldEnd != NULL);
+            if (!moreFields)
+                fieldEnd = end;
+
+            if (fieldsCount < MAX_FIELDS)
+                storeField(fieldBegin, fieldEnd);
+            fieldsCount++;
+
+            fieldBegin = fieldEnd + 1;
+        }
+    }
+
+    void storeField(const char* begin, const char* end)
+    {
+        while (begin < end && isBlank(*begin))
+            ++begin;
+        while (end > begin && isBlank(end[-1]))
+            --end;
+
+        fields[fieldsCount].begin = begin;
+        fields[fieldsCount].end = end;
+    }
+};
+
+/**
+* Method: parseFloat
+* ------------------
+* Description: Parses a decimal number that spans the whole field,
+* independently of the process locale.
+* @param field text to be parsed
+* @param value parsed number
+* @return false if the field is not a number
+*/
+inline bool parseFloat(const FieldView& field, float& value)
+{
+    // digits that fit in the mantissa accumulator without overflow
+    static const unsigned int MAX_MANTISSA_DIGITS = 18;
+    static const int MAX_EXPONENT = 300;
+
+    const char* c = field.begin;
+    const char* const end = field.end;
+
+    bool negative = false;
+    if (c < end && (*c == '-' || *c == '+'))
+    {
+        negative = (*c == '-');
+        ++c;
+    }
+
+    unsigned long long mantissa = 0;
+    unsigned int mantissaDigits = 0;
+    int exponent = 0;
+    unsigned int digits = 0;
+
+    for (; c < end && *c >= '0' && *c <= '9'; ++c, ++digits)
+    {
+        if (mantissaDigits < MAX_MANTISSA_DIGITS)
+        {
+            mantissa = mantissa * 10 + (*c - '0');
+            mantissaDigits += (mantissa != 0) ? 1 : 0;
+        }
+        else
+            exponent++;
+    }
+
+    if (c < end && *c == '.')
+    {
+        for (++c; c < end && *c >= '0' && *c <= '9'; ++c, ++digits)
+        {
+            if (mantissaDigits < MAX_MANTISSA_DIGITS)
+            {
+                mantissa = mantissa * 10 + (*c - '0');
+                mantissaDigits += (mantissa != 0) ? 1 : 0;
+                exponent--;
+            }
+        }
+    }
+
+    if (digits == 0)
+        return false;
+
+    if (c < end && (*c == 'e' || *c == 'E'))
+    {
+        ++c;
+        bool negativeExponent = false;
+        if (c < end && (*c == '-' || *c == '+'))
+        {
+            negativeExponent = (*c == '-');
+            ++c;
+        }
+
+        if (c == end)
+            return false;
+
+        int e = 0;
+        for (; c < end && *c >= '0' && *c <= '9'; ++c)
+        {
+            if (e < MAX_EXPONENT)
+                e = e * 10 + (*c - '0');
+        }
+        exponent += negativeExponent ? -e : e;
+    }
+
+    if (c != end)
+        return false;
+
+    static const double POWERS_OF_TEN[] =
+    {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    static const int MAX_EXACT_POWER = 22;
+
+    double result = static_cast<double>(mantissa);
+    if (mantissa != 0)
+    {
+        int magnitude = (exponent < 0) ? -exponent : exponent;
+        double scale = 1.0;
+        while (magnitude > MAX_EXACT_POWER)
+        {
+            scale *= POWERS_OF_TEN[MAX_EXACT_POWER];
+            magnitude -= MAX_EXACT_POWER;
+        }
+        scale *= POWERS_OF_TEN[magnitude];
+
+        result = (exponent < 0) ? result / scale : result * scale;
+    }
+    value = static_cast<float>(negative ? -result : result);
+    return true;
+}
+
+}
+
+#endif
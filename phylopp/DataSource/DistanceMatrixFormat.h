@@ -0,0 +1,62 @@
+/*
+    DistanceMatrixFormat: layout of the binary dense distance matrix files
+
+    Copyright (C) 2011 Emmanuel Teisaire, Nicolás Bombau, Carlos Castro, Damián Domé, FuDePAN
+
+    This file is part of the Phyloloc project.
+
+    Phyloloc is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Phyloloc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DISTANCE_MATRIX_FORMAT_H
+#define DISTANCE_MATRIX_FORMAT_H
+
+#include <stdint.h>
+#include <cstring>
+
+namespace DataSource
+{
+
+/**
+* Namespace: DistanceMatrixFormat
+* -------------------------------
+* Description: A distance matrix file holds, in host byte order:
+*   - MAGIC, BYTE_ORDER_MARK, VERSION and the locations count n (uint32)
+*   - n location names, each one as a uint32 length followed by its bytes
+*   - zero padding up to the next DATA_ALIGNMENT boundary
+*   - n x n float distances, row-major, rows and columns in name order
+* so that the distances can be used in place once the file is mapped.
+*/
+namespace DistanceMatrixFormat
+{
+static const char MAGIC[] = "PHYLODM";
+static const size_t MAGIC_SIZE = sizeof(MAGIC);
+static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+static const uint32_t VERSION = 1;
+static const size_t DATA_ALIGNMENT = 64;
+
+inline size_t alignedOffset(size_t offset)
+{
+    return (offset + DATA_ALIGNMENT - 1) / DATA_ALIGNMENT * DATA_ALIGNMENT;
+}
+
+inline bool hasMagic(const char* data, size_t size)
+{
+    return size >= MAGIC_SIZE && memcmp(data, MAGIC, MAGIC_SIZE) == 0;
+}
+}
+
+}
+
+#endif
@@ -0,0 +1,169 @@
+/*
+    DistanceMatrixParser: a parser for loading binary dense distance matrices
+
+    Copyright (C) 2011 Emmanuel Teisaire, Nicolás Bombau, Carlos Castro, Damián Domé, FuDePAN
+
+    This file is part of the Phyloloc project.
+
+    Phyloloc is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Phyloloc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef DISTANCE_MATRIX_PARSER_H
+#define DISTANCE_MATRIX_PARSER_H
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <mili/mili.h>
+#include "phylopp/Domain/LocationManager.h"
+#include "phylopp/DataSource/FileBuffer.h"
+#include "phylopp/DataSource/FileStreams.h"
+#include "phylopp/DataSource/DistanceMatrixFormat.h"
+
+class DistanceMatrixFileExceptionHierarchy {};
+
+typedef mili::GenericException<DistanceMatrixFileExceptionHierarchy> DistanceMatrixFileException;
+
+/**
+* DistanceMatrixFileNotFound
+* --------------------
+* Description: Exception used when the input file is missing.
+*/
+DEFINE_SPECIFIC_EXCEPTION_TEXT(DistanceMatrixFileNotFound,
+                               DistanceMatrixFileExceptionHierarchy,
+                               "The input distance matrix file does not exist.");
+
+/**
+* MalformedDistanceMatrixFile
+* --------------------
+* Description: Exception used when the input file is not correctly formed.
+*/
+DEFINE_SPECIFIC_EXCEPTION_TEXT(MalformedDistanceMatrixFile,
+                               DistanceMatrixFileExceptionHierarchy,
+                               "The input distance matrix is not correctly formed");
+
+class DistanceMatrixParser
+{
+public:
+
+    /**
+     * Tells whether a file is a binary distance matrix, by its magic bytes
+     *
+     * @param fname File name
+     * @return true if the file is a distance matrix
+     */
+    static bool isDistanceMatrixFile(const std::string& fname)
+    {
+        char magic[DataSource::DistanceMatrixFormat::MAGIC_SIZE];
+        DataSource::InputFileStream f(fname);
+
+        f.read(magic, sizeof(magic));
+        return DataSource::DistanceMatrixFormat::hasMagic(magic, f.gcount());
+    }
+
+    /**
+     * Loads a dense distance matrix from a file. Every location in the
+     * file must have been already added to the location manager.
+     *
+     * @param fname File name
+     * @param locationManager Manager of locations and distances between locations
+     */
+    void loadDistanceMatrixFile(const std::string& fname, Locations::LocationManager& locationManager)
+    {
+        DataSource::FileBuffer file;
+
+        if (!file.open(fname))
+            throw DistanceMatrixFileNotFound();
+
+        begin = cursor = file.data();
+        end = file.end();
+
+        if (!DataSource::DistanceMatrixFormat::hasMagic(cursor, file.size()))
+            throw MalformedDistanceMatrixFile("bad magic");
+        cursor += DataSource::DistanceMatrixFormat::MAGIC_SIZE;
+
+        if (readUInt() != DataSource::DistanceMatrixFormat::BYTE_ORDER_MARK)
+            throw MalformedDistanceMatrixFile("byte order mismatch");
+
+        if (readUInt() != DataSource::DistanceMatrixFormat::VERSION)
+            throw MalformedDistanceMatrixFile("unknown version");
+
+        const size_t count = readUInt();
+        checkCount(count, file.size());
+        std::vector<Locations::LocationId> ids(count);
+        Locations::Location location;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            const size_t length = readUInt();
+            require(length);
+            location.assign(cursor, length);
+            cursor += length;
+
+            ids[i] = locationManager.getLocationId(location);
+            if (ids[i] == Locations::LOCATION_NOT_FOUND)
+                throw Locations::InvalidLocation(location);
+        }
+
+        cursor = begin + DataSource::DistanceMatrixFormat::alignedOffset(cursor - begin);
+        if (cursor > end || static_cast<size_t>(end - cursor) != count * count * sizeof(Locations::Distance))
+            throw MalformedDistanceMatrixFile("wrong matrix size");
+
+        locationManager.addDistances(ids, reinterpret_cast<const Locations::Distance*>(cursor));
+    }
+
+private:
+    const char* begin;
+    const char* cursor;
+    const char* end;
+
+    void require(size_t bytes) const
+    {
+        if (static_cast<size_t>(end - cursor) < bytes)
+            throw MalformedDistanceMatrixFile("unexpected end of file");
+    }
+
+    /**
+     * Checks that the file is large enough for the names and the
+     * matrix of count locations, before anything is allocated for them.
+     *
+     * @param count Amount of locations stated in the header
+     * @param size Size of the file
+     */
+    void checkCount(size_t count, size_t size) const
+    {
+        const size_t namesOffset = cursor - begin;
+        const size_t distances = size / sizeof(Locations::Distance);
+
+        if (count > (size - namesOffset) / sizeof(uint32_t)
+                || (count > 0 && count > distances / count))
+            throw MalformedDistanceMatrixFile("wrong matrix size");
+
+        const size_t dataOffset = DataSource::DistanceMatrixFormat::alignedOffset(namesOffset + count * sizeof(uint32_t));
+        if (dataOffset > size || count * count * sizeof(Locations::Distance) > size - dataOffset)
+            throw MalformedDistanceMatrixFile("wrong matrix size");
+    }
+
+    uint32_t readUInt()
+    {
+        uint32_t value;
+        require(sizeof(value));
+        memcpy(&value, cursor, sizeof(value));
+        cursor += sizeof(value);
+        return value;
+    }
+};
+
+#endif
@@ -0,0 +1,83 @@
+/*
+    DistanceMatrixWriter: a class for saving distances as a binary dense matrix
+
+    Copyright (C) 2011 Emmanuel Teisaire, Nicolás Bombau, Carlos Castro, Damián Domé, FuDePAN
+
+    This file is part of the Phyloloc project.
+
+    Phyloloc is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Phyloloc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef DISTANCE_MATRIX_WRITER_H
+#define DISTANCE_MATRIX_WRITER_H
+
+#include <string>
+#include <vector>
+#include "phylopp/Domain/LocationManager.h"
+#include "phylopp/DataSource/FileStreams.h"
+#include "phylopp/DataSource/DistanceMatrixFormat.h"
+
+class DistanceMatrixWriter
+{
+public:
+
+    /**
+     * Saves the distances between every pair of locations of a location
+     * manager. Files named "*.gz" or "*.zst" are compressed.
+     *
+     * @param fname File name
+     * @param locationManager Manager of locations and distances between locations
+     */
+    void saveDistanceMatrixFile(const std::string& fname, const Locations::LocationManager& locationManager)
+    {
+        DataSource::OutputFileStream os(fname);
+        const uint32_t count = static_cast<uint32_t>(locationManager.getLocationsCount());
+
+        os.write(DataSource::DistanceMatrixFormat::MAGIC, DataSource::DistanceMatrixFormat::MAGIC_SIZE);
+        writeUInt(os, DataSource::DistanceMatrixFormat::BYTE_ORDER_MARK);
+        writeUInt(os, DataSource::DistanceMatrixFormat::VERSION);
+        writeUInt(os, count);
+        size_t offset = DataSource::DistanceMatrixFormat::MAGIC_SIZE + 3 * sizeof(uint32_t);
+
+        for (Locations::LocationId id = 1; id <= count; id++)
+        {
+            const Locations::Location& location = locationManager.getLocationName(id);
+            writeUInt(os, static_cast<uint32_t>(location.size()));
+            os.write(location.data(), location.size());
+            offset += sizeof(uint32_t) + location.size();
+        }
+
+        const std::vector<char> padding(DataSource::DistanceMatrixFormat::alignedOffset(offset) - offset, 0);
+        os.write(padding.empty() ? NULL : &padding[0], padding.size());
+
+        std::vector<Locations::Distance> row(count);
+        for (Locations::LocationId from = 1; from <= count; from++)
+        {
+            for (Locations::LocationId to = 1; to <= count; to++)
+                row[to - 1] = locationManager.distance(from, to);
+
+            os.write(reinterpret_cast<const char*>(row.empty() ? NULL : &row[0]), row.size() * sizeof(Locations::Distance));
+        }
+    }
+
+private:
+
+    static void writeUInt(std::ostream& os, uint32_t value)
+    {
+        os.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+};
+
+#endif
@@ -29,6 +29,8 @@
 #include <mili/mili.h>
 #include "phylopp/Domain/INode.h"
 #include "phylopp/Domain/LocationManager.h"
+#include "phylopp/DataSource/FileBuffer.h"
+#include "phylopp/DataSource/DelimitedTextScanner.h"
 
 using namespace Locations;
 
@@ -59,6 +61,18 @@ class DistancesParser
 {
 public:
 
+    /**
+     * Constructor
+     *
+     * @param storage How the location manager will store the loaded distances
+     * @param defaultDistance For sparse storage, the distance between
+     * two different locations missing from the file
+     */
+    DistancesParser(Locations::DistanceStorage storage = Locations::DenseStorage, Locations::Distance defaultDistance = 0.0f) :
+        storage(storage),
+        defaultDistance(defaultDistance)
+    {}
+
     /**
      * Loads distences information from a file
      *
@@ -67,37 +81,43 @@ public:
      */
     void loadDistancesFile(const std::string& fname, Locations::LocationManager& locationManager)
     {
-        std::ifstream f(fname.c_str());
+        DataSource::FileBuffer file;
 
-        if (!f)
+        if (!file.open(fname))
             throw DistancesFileNotFound();
 
+        locationManager.setDistanceStorage(storage, defaultDistance);
+
         currentLineNumber = 1;
 
-        std::vector<std::string> values;
+        DataSource::DelimitedTextScanner scanner(file.data(), file.end(), ',');
+        Location location1;
+        Location location2;
 
-        while (f >> mili::Separator(values, ','))
+        while (scanner.nextLine())
         {
-            if (values.size() != 3)
+            if (scanner.fieldCount() != 3)
                 throw MalformedDistancesFile(getLineNumberText());
 
-            Location location1 = mili::trim(values[0]);
-            Location location2 = mili::trim(values[1]);
+            scanner.field(0).assignTo(location1);
+            scanner.field(1).assignTo(location2);
 
             float distance;
-            if (!mili::from_string(values[2], distance))
+            if (!DataSource::parseFloat(scanner.field(2), distance))
                 throw MalformedDistancesFile(getLineNumberText());
 
             addDistance(distance, location1, location2, locationManager);
 
-            values.clear();
-
             currentLineNumber++;
         }
+        locationManager.compactDistances();
     }
 
 private:
 
+    Locations::DistanceStorage storage;
+    Locations::Distance defaultDistance;
+
     /**
      * Adds to the location manager the distance between location1 and location2
      *
@@ -0,0 +1,75 @@
+/*
+    DistancesWriter: a class for saving distances as text
+
+    Copyright (C) 2011 Emmanuel Teisaire, Nicolás Bombau, Carlos Castro, Damián Domé, FuDePAN
+
+    This file is part of the Phyloloc project.
+
+    Phyloloc is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Phyloloc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef DISTANCES_WRITER_H
+#define DISTANCES_WRITER_H
+
+#include <stdio.h>
+#include <string>
+#include "phylopp/Domain/LocationManager.h"
+#include "phylopp/DataSource/FileStreams.h"
+
+class DistancesWriter
+{
+public:
+
+    /**
+     * Saves the distance between every pair of locations of a location
+     * manager, one "from,to,distance" line each, as read by
+     * DistancesParser. Files named "*.gz" or "*.zst" are compressed.
+     *
+     * @param fname File name
+     * @param locationManager Manager of locations and distances between locations
+     */
+    void saveDistancesFile(const std::string& fname, const Locations::LocationManager& locationManager)
+    {
+        DataSource::OutputFileStream os(fname);
+        const size_t count = locationManager.getLocationsCount();
+        std::string line;
+        char distance[MAX_TOKEN_SIZE];
+
+        for (Locations::LocationId from = 1; from <= count; from++)
+        {
+            for (Locations::LocationId to = 1; to <= count; to++)
+            {
+                const int written = snprintf(distance, sizeof(distance), "%.*g",
+                                             MAX_FLOAT_DIGITS, locationManager.distance(from, to));
+                line = locationManager.getLocationName(from);
+                line += ',';
+                line += locationManager.getLocationName(to);
+                line += ',';
+                line.append(distance, written);
+                line += '\n';
+                os.write(line.data(), line.size());
+            }
+        }
+    }
+
+private:
+
+    // Room for the longest formatted distance
+    static const size_t MAX_TOKEN_SIZE = 32;
+    // Enough significant digits to round-trip any float
+    static const int MAX_FLOAT_DIGITS = 9;
+};
+
+#endif
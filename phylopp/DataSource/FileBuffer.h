@@ -0,0 +1,73 @@
+/*
+    Copyright (C) 2011 Emmanuel Teisaire, Nicolás Bombau, Carlos Castro, Damián Domé, FuDePAN
+
+    This file is part of the Phyloloc project.
+
+    Phyloloc is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Phyloloc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef FILE_BUFFER_H
+#define FILE_BUFFER_H
+
+#include <string>
+#include <vector>
+
+namespace DataSource
+{
+
+/**
+* Class: FileBuffer
+* -----------------
+* Description: Holds the whole contents of a file in memory. Plain files
+* are memory mapped, so no copy is made; gzip and zstd files are
+* decompressed into an owned buffer.
+*/
+class FileBuffer
+{
+public:
+    FileBuffer();
+    ~FileBuffer();
+
+    /**
+    * Method: open
+    * ------------
+    * Description: Maps or decompresses a file, releasing the previous one
+    * @param fname file path
+    * @return false if the file could not be opened
+    */
+    bool open(const std::string& fname);
+
+    void close();
+    void swap(FileBuffer& other);
+
+    const char* data() const;
+    const char* end() const;
+    size_t size() const;
+
+private:
+    void* mapping;
+    size_t mappingSize;
+    std::vector<char> contents;
+    const char* begin;
+    size_t length;
+
+    bool decompress(const std::string& fname);
+
+    FileBuffer(const FileBuffer&);
+    FileBuffer& operator=(const FileBuffer&);
+};
+
+}
+
+#endif
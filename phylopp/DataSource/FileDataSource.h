@@ -36,9 +36,11 @@
 #include "phylopp/Domain/ListIterator.h"
 #include "phylopp/DataSource/IDataSourceStrategy.h"
 #include "phylopp/DataSource/FilesInfo.h"
+#include "phylopp/DataSource/FileStreams.h"
 #include "phylopp/DataSource/NewickParser.h"
 #include "phylopp/DataSource/NewickWriter.h"
 #include "phylopp/DataSource/DistancesParser.h"
+#include "phylopp/DataSource/DistanceMatrixParser.h"
 #include "phylopp/DataSource/LocationsParser.h"
 #include "phylopp/DataSource/TreeValidationPolicies.h"
 
@@ -65,8 +67,17 @@ public:
             LocationsParser locationsParser;
             locationsParser.loadLocationsFile(info.getLocationsFilePath(), locationManager);
 
-            DistancesParser distancesParser;
-            distancesParser.loadDistancesFile(info.getDistancesFilePath(), locationManager);
+            if (DistanceMatrixParser::isDistanceMatrixFile(info.getDistancesFilePath()))
+            {
+                DistanceMatrixParser distanceMatrixParser;
+                distanceMatrixParser.loadDistanceMatrixFile(info.getDistancesFilePath(), locationManager);
+                locationManager.setDistanceStorage(info.getDistanceStorage(), info.getDefaultDistance());
+            }
+            else
+            {
+                DistancesParser distancesParser(info.getDistanceStorage(), info.getDefaultDistance());
+                distancesParser.loadDistancesFile(info.getDistancesFilePath(), locationManager);
+            }
         }
         catch (const LocationException& ex)
         {
@@ -86,6 +97,18 @@ public:
             locationManager.clear();
             throw;
         }
+        catch (const CompressedFileException& ex)
+        {
+            trees.clear();
+            locationManager.clear();
+            throw;
+        }
+        catch (const DistanceMatrixFileException& ex)
+        {
+            trees.clear();
+            locationManager.clear();
+            throw;
+        }
 
         try
         {
@@ -109,6 +132,12 @@ public:
             locationManager.clear();
             throw;
         }
+        catch (const CompressedFileException& ex)
+        {
+            trees.clear();
+            locationManager.clear();
+            throw;
+        }
     }
 
     /**
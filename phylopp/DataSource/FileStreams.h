@@ -0,0 +1,197 @@
+/*
+    Copyright (C) 2011 Emmanuel Teisaire, Nicolás Bombau, Carlos Castro, Damián Domé, FuDePAN
+
+    This file is part of the Phyloloc project.
+
+    Phyloloc is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Phyloloc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef FILE_STREAMS_H
+#define FILE_STREAMS_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <mili/mili.h>
+
+class CompressedFileExceptionHierarchy {};
+
+typedef mili::GenericException<CompressedFileExceptionHierarchy> CompressedFileException;
+
+/**
+* CorruptedCompressedFile
+* --------------------
+* Description: Exception used when a compressed file can not be decoded.
+*/
+DEFINE_SPECIFIC_EXCEPTION_TEXT(CorruptedCompressedFile,
+                               CompressedFileExceptionHierarchy,
+                               "The compressed file is corrupted");
+
+/**
+* UnsupportedCompression
+* --------------------
+* Description: Exception used when a file uses a compression format
+* that phylopp was built without.
+*/
+DEFINE_SPECIFIC_EXCEPTION_TEXT(UnsupportedCompression,
+                               CompressedFileExceptionHierarchy,
+                               "The compression format is not supported");
+
+namespace DataSource
+{
+
+enum Compression
+{
+    NoCompression,
+    GzipCompression,
+    ZstdCompression
+};
+
+/**
+* Method: detectCompression
+* -------------------------
+* Description: Recognizes the compression format by its magic bytes
+* @param header first bytes of a file
+* @param size amount of bytes available in header
+* @return the compression format, NoCompression if it is not recognized
+*/
+Compression detectCompression(const unsigned char* header, size_t size);
+
+/**
+* Method: compressionFromFileName
+* -------------------------------
+* Description: Chooses the compression format for a file to be written,
+* ".gz" files are written with gzip and ".zst" files with zstd.
+* @param fname file path
+* @return the compression format, NoCompression for any other extension
+*/
+Compression compressionFromFileName(const std::string& fname);
+
+/**
+* Class: DecompressingStreamBuf
+* -----------------------------
+* Description: Input buffer that reads plain, gzip or zstd files,
+* detecting the format from the first bytes of the file.
+*/
+class DecompressingStreamBuf : public std::streambuf
+{
+public:
+    DecompressingStreamBuf();
+    ~DecompressingStreamBuf();
+
+    bool open(const std::string& fname);
+    void close();
+    bool is_open() const;
+
+    Compression getCompression() const;
+
+protected:
+    virtual int_type underflow();
+
+private:
+    struct Decoder;
+
+    FILE* file;
+    Compression compression;
+    Decoder* decoder;
+    std::vector<char> input;
+    std::vector<char> output;
+    size_t inputBegin;
+    size_t inputEnd;
+
+    bool fillInput();
+    size_t decode();
+
+    DecompressingStreamBuf(const DecompressingStreamBuf&);
+    DecompressingStreamBuf& operator=(const DecompressingStreamBuf&);
+};
+
+/**
+* Class: CompressingStreamBuf
+* ---------------------------
+* Description: Output buffer that writes plain, gzip or zstd files.
+*/
+class CompressingStreamBuf : public std::streambuf
+{
+public:
+    CompressingStreamBuf();
+    ~CompressingStreamBuf();
+
+    bool open(const std::string& fname, Compression compression);
+    void close();
+    bool is_open() const;
+
+protected:
+    virtual int_type overflow(int_type c);
+    virtual std::streamsize xsputn(const char* s, std::streamsize n);
+    virtual int sync();
+
+private:
+    struct Encoder;
+
+    FILE* file;
+    Compression compression;
+    Encoder* encoder;
+    std::vector<char> input;
+    std::vector<char> output;
+
+    bool encode(const char* data, size_t size, bool finish);
+    bool flushInput(bool finish);
+
+    CompressingStreamBuf(const CompressingStreamBuf&);
+    CompressingStreamBuf& operator=(const CompressingStreamBuf&);
+};
+
+/**
+* Class: InputFileStream
+* ----------------------
+* Description: Drop-in replacement of std::ifstream that transparently
+* decompresses gzip and zstd files. Decoding errors are thrown as
+* CompressedFileException.
+*/
+class InputFileStream : public std::istream
+{
+public:
+    explicit InputFileStream(const std::string& fname);
+
+    bool is_open() const;
+    Compression getCompression() const;
+
+private:
+    DecompressingStreamBuf buffer;
+};
+
+/**
+* Class: OutputFileStream
+* -----------------------
+* Description: Drop-in replacement of std::ofstream that compresses
+* the output. The file is finished when the stream is destroyed.
+*/
+class OutputFileStream : public std::ostream
+{
+public:
+    OutputFileStream(const std::string& fname, Compression compression);
+    explicit OutputFileStream(const std::string& fname);
+
+    bool is_open() const;
+    void close();
+
+private:
+    CompressingStreamBuf buffer;
+};
+
+}
+
+#endif
@@ -23,6 +23,7 @@
 #define FILESINFO_H
 
 #include <string>
+#include "phylopp/Domain/DistanceStorage.h"
 
 namespace DataSource
 {
@@ -36,13 +37,19 @@ public:
      * @param treeFilePath Path to trees file
      * @param locationsFilePath Path to locations file
      * @param distancesFilePath Path to distances file
+     * @param distanceStorage How loaded distances are stored
+     * @param defaultDistance For sparse storage, the distance between
+     * two different locations missing from the distances file
      *
      */
-    FilesInfo(const std::string& treesFilePath, const std::string& locationsFilePath, const std::string& distancesFilePath)
+    FilesInfo(const std::string& treesFilePath, const std::string& locationsFilePath, const std::string& distancesFilePath,
+              Locations::DistanceStorage distanceStorage = Locations::DenseStorage, Locations::Distance defaultDistance = 0.0f)
     {
         this->treesFilePath = treesFilePath;
         this->locationsFilePath = locationsFilePath;
         this->distancesFilePath = distancesFilePath;
+        this->distanceStorage = distanceStorage;
+        this->defaultDistance = defaultDistance;
     }
 
     /**
@@ -75,11 +82,34 @@ public:
         return distancesFilePath;
     }
 
+    /**
+     * Get how loaded distances are stored
+     *
+     * @return distance storage
+     */
+    Locations::DistanceStorage getDistanceStorage() const
+    {
+        return distanceStorage;
+    }
+
+    /**
+     * Get the distance of sparse storage between locations without a
+     * given distance
+     *
+     * @return default distance
+     */
+    Locations::Distance getDefaultDistance() const
+    {
+        return defaultDistance;
+    }
+
 
 private:
     std::string treesFilePath;
     std::string locationsFilePath;
     std::string distancesFilePath;
+    Locations::DistanceStorage distanceStorage;
+    Locations::Distance defaultDistance;
 };
 }
 
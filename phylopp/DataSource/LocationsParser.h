@@ -29,6 +29,8 @@
 #include <mili/mili.h>
 #include "phylopp/Domain/INode.h"
 #include "phylopp/Domain/LocationManager.h"
+#include "phylopp/DataSource/FileBuffer.h"
+#include "phylopp/DataSource/DelimitedTextScanner.h"
 
 using namespace Locations;
 
@@ -67,26 +69,27 @@ public:
      */
     void loadLocationsFile(const std::string& fname, Locations::LocationManager& locationManager)
     {
-        std::ifstream f(fname.c_str());
+        DataSource::FileBuffer file;
 
-        if (!f)
+        if (!file.open(fname))
             throw DataFileNotFound();
 
         currentLineNumber = 1;
 
-        std::vector<std::string> values;
+        DataSource::DelimitedTextScanner scanner(file.data(), file.end(), ',');
+        Domain::NodeName name;
+        Location location;
 
-        while (f >> mili::Separator(values, ','))
+        while (scanner.nextLine())
         {
-            if (values.size() != 2)
+            if (scanner.fieldCount() != 2)
                 throw MalformedFile(getLineNumberText());
 
-            Domain::NodeName name = mili::trim(values[0]);
-            Location location = mili::trim(values[1]);
+            scanner.field(0).assignTo(name);
+            scanner.field(1).assignTo(location);
 
             addLocation(name, location, locationManager);
 
-            values.clear();
             currentLineNumber++;
         }
     }
@@ -0,0 +1,64 @@
+/*
+    LocationsWriter: a class for saving the locations of nodes
+
+    Copyright (C) 2011 Emmanuel Teisaire, Nicolás Bombau, Carlos Castro, Damián Domé, FuDePAN
+
+    This file is part of the Phyloloc project.
+
+    Phyloloc is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Phyloloc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef LOCATIONS_WRITER_H
+#define LOCATIONS_WRITER_H
+
+#include <string>
+#include "phylopp/Domain/LocationManager.h"
+#include "phylopp/DataSource/FileStreams.h"
+
+class LocationsWriter
+{
+public:
+
+    /**
+     * Saves the location of every node of a location manager, one
+     * "node,location" line each, as read by LocationsParser. Files
+     * named "*.gz" or "*.zst" are compressed.
+     *
+     * @param fname File name
+     * @param locationManager Manager of locations and distances between locations
+     */
+    void saveLocationsFile(const std::string& fname, const Locations::LocationManager& locationManager)
+    {
+        DataSource::OutputFileStream os(fname);
+        const size_t count = locationManager.getNodeNameCount();
+        std::string line;
+
+        for (Locations::NodeNameId id = 1; id <= count; id++)
+        {
+            const Locations::LocationId location = locationManager.getNodeNameLocationId(id);
+
+            if (location != Locations::LOCATION_NOT_FOUND)
+            {
+                line = locationManager.getNodeName(id);
+                line += ',';
+                line += locationManager.getLocationName(location);
+                line += '\n';
+                os.write(line.data(), line.size());
+            }
+        }
+    }
+};
+
+#endif
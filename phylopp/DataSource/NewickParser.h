@@ -27,52 +27,11 @@
 #include <iostream>
 #include <mili/mili.h>
 #include "phylopp/Domain/ITree.h"
-#include "phylopp/Domain/ListIterator.h"
+#include "phylopp/Domain/ITreeCollection.h"
 #include "phylopp/Domain/LocationManager.h"
+#include "phylopp/DataSource/NewickReader.h"
 #include "phylopp/DataSource/TreeValidationPolicies.h"
 
-class TreeFileExceptionHierarchy {};
-
-typedef mili::GenericException<TreeFileExceptionHierarchy> TreeFileException;
-
-/**
-* MissingTreeSeparator
-* --------------------
-* Description: Exception used when the nodes separator its not found
-*/
-DEFINE_SPECIFIC_EXCEPTION_TEXT(MissingTreeSeparator,
-                               TreeFileExceptionHierarchy,
-                               "Missing tree separator (;)");
-
-/**
-* TreeFileNotFound
-* --------------------
-* Description: Exception used when the input file is missing.
-*/
-DEFINE_SPECIFIC_EXCEPTION_TEXT(TreeFileNotFound,
-                               TreeFileExceptionHierarchy,
-                               "The input tree file does not exist.");
-
-/**
-* MalformedExpression
-* --------------------
-* Description: Exception used when the input file is missing.
-*/
-DEFINE_SPECIFIC_EXCEPTION_TEXT(MalformedExpression,
-                               TreeFileExceptionHierarchy,
-                               "The input is not correctly formed");
-
-
-/**
-* MissingDataException
-* --------------------
-* Description: Exception used when missing data in leaf nodes is not allowed
-*/
-DEFINE_SPECIFIC_EXCEPTION_TEXT(MissingDataException,
-                               TreeFileExceptionHierarchy,
-                               "Missing data not allowed. All terminal nodes should have name");
-
-
 template < class T, class ValidationPolicy = DefaultValidationPolicy >
 class NewickParser
 {
@@ -92,198 +51,16 @@ public:
      * @param locationManager Manager of locations and distances between locations
      * @param trees Collection to be filled with the parsed trees
      */
-    void loadNewickFile(const std::string& fname, const Locations::LocationManager locationManager, Domain::ITreeCollection<T>& trees)
+    void loadNewickFile(const std::string& fname, const Locations::LocationManager& locationManager, Domain::ITreeCollection<T>& trees)
     {
-        std::ifstream f(fname.c_str());
-
-        if (!f)
-            throw TreeFileNotFound();
-
-        std::string line;
-
-        currentLineNumber = 1;
-        while (getline(f, line))
-        {
-            std::string tree_str = line;
+        NewickReader<T, ValidationPolicy> reader(fname, locationManager, validationPolicy);
 
-            character = tree_str.c_str();
-
-            do
-            {
-                Domain::ITree<T>* tree = trees.addTree();
-                load_node(locationManager, tree->getRoot());
-                consume_whitespace();
-                if (*character != ';')
-                    throw MissingTreeSeparator(getLineNumberText());
-                else
-                    ++character;
-            }
-            while (*character != 0);
-
-            currentLineNumber++;
-        }
+        while (reader.hasNext())
+            reader.readTree(trees.addTree());
     }
 
 private:
     ValidationPolicy validationPolicy;
-    mili::VariantsSet set;
-    const char* character;
-
-    /****************************************************
-     ** This variable and method will no longer be
-     ** needed when mili generic exceptions is updated.
-     *********       mili issue 35              ********/
-
-    unsigned int currentLineNumber;
-
-    std::string getLineNumberText() const
-    {
-        std:: stringstream s;
-        s << "Line: " << currentLineNumber;
-        return s.str();
-    }
-    /****************************************************/
-
-    /**
-     * Loads a node and all its children recursively
-     *
-     * @param locationManager Manager of locations and distances between locations
-     * @param node Node to be filled
-     */
-    void load_node(const Locations::LocationManager locationManager, T* node)
-    {
-        std::string name;
-        float branchLength = 0.0f;
-        Locations::LocationId locationId;
-        // Output: either ',' or ')' (depending on the node type)
-        consume_whitespace();
-
-        switch (*character)
-        {
-            case '(':
-                // We are nonleaf. Load new child.
-                ++character;
-                load_children(locationManager, node); // leaves in a parent
-                character++;
-                name = consume_name();
-                node->setName(name);
-                branchLength = consume_branch_length();
-                node->setBranchLength(branchLength);
-
-                break;
-            case ',':
-            case ')':
-                //Allow nameless nodes: dont consume character.
-                node->setName("");
-                node->setBranchLength(0.0f);
-                break;
-            case 0:
-                throw MalformedExpression(getLineNumberText());
-            default:
-                // We are leaf.
-                name = consume_name();
-                node->setName(name);
-                branchLength = consume_branch_length();
-                node->setBranchLength(branchLength);
-                // Set location id, if exists, for the node
-                locationId = locationManager.getNameLocationId(name);
-                if (locationId != Locations::LOCATION_NOT_FOUND)
-                {
-                    node->setLocationId(locationId);
-                }
-                //else no location is set for that node
-        }
-        if (!validationPolicy.validate(node))
-            throw MissingDataException(getLineNumberText());
-    }
-
-    /**
-     * Loads a nodes children
-     *
-     * @param locationManager Manager of locations and distances between locations
-     * @param parent node whose children will be loaded
-     */
-    void load_children(const Locations::LocationManager locationManager, T* parent)
-    {
-        T* child;
-        bool keep_reading = true;
-
-        // Input: first char of first child.
-        // output: ')'
-        do
-        {
-            child = parent->template addChild<T>();
-            load_node(locationManager, child);
-            consume_whitespace();
-            switch (*character)
-            {
-                case ',':
-                    keep_reading = true;
-                    ++character;
-                    break;
-                case ')':
-                    keep_reading = false;
-                    break;
-                default:
-                    throw MalformedExpression(getLineNumberText());
-            }
-        }
-        while (keep_reading);
-    }
-
-    static inline bool is_namechar(char c)
-    {
-        return mili::in_range(c, '0', '9') ||
-               mili::in_range(c, 'a', 'z') ||
-               mili::in_range(c, 'A', 'Z') ||
-               c == '_' ||
-               c == '-';
-    }
-
-    static inline bool is_branchlen_char(char c)
-    {
-        return mili::in_range(c, '0', '9') ||
-               c == '.';
-    }
-
-    std::string consume_name()
-    {
-        std::string ret;
-        while (is_namechar(*character))
-        {
-            ret += *character;
-            ++character;
-        }
-
-        return ret;
-    }
-
-    void consume_whitespace()
-    {
-        while (*character == ' ' || *character == '\t')
-            ++character;
-    }
-
-    float consume_branch_length()
-    {
-        consume_whitespace();
-        float ret = 0.0f;
-        if (*character == ':')
-        {
-            ++character;
-            std::string branchLenStr;
-            while (is_branchlen_char(*character))
-            {
-                branchLenStr += *character;
-                ++character;
-            }
-
-            if (!mili::from_string(branchLenStr, ret))
-                throw MalformedExpression(getLineNumberText());
-
-        }
-        return ret;
-    }
 };
 
 #endif
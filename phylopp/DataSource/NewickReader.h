@@ -0,0 +1,364 @@
+/*
+    NewickReader: a pull-based reader for trees in newick format
+
+    Copyright (C) 2011 Emmanuel Teisaire, Nicolás Bombau, Carlos Castro, Damián Domé, FuDePAN
+
+    This file is part of the Phyloloc project.
+
+    Phyloloc is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Phyloloc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef NEWICK_READER_H
+#define NEWICK_READER_H
+
+#include <string>
+#include <iostream>
+#include <sstream>
+#include <mili/mili.h>
+#include "phylopp/Domain/ITree.h"
+#include "phylopp/Domain/ListIterator.h"
+#include "phylopp/Domain/LocationManager.h"
+#include "phylopp/DataSource/FileStreams.h"
+#include "phylopp/DataSource/TreeValidationPolicies.h"
+#include "phylopp/Domain/SupportAspect.h"
+
+class TreeFileExceptionHierarchy {};
+
+typedef mili::GenericException<TreeFileExceptionHierarchy> TreeFileException;
+
+/**
+* MissingTreeSeparator
+* --------------------
+* Description: Exception used when the nodes separator its not found
+*/
+DEFINE_SPECIFIC_EXCEPTION_TEXT(MissingTreeSeparator,
+                               TreeFileExceptionHierarchy,
+                               "Missing tree separator (;)");
+
+/**
+* TreeFileNotFound
+* --------------------
+* Description: Exception used when the input file is missing.
+*/
+DEFINE_SPECIFIC_EXCEPTION_TEXT(TreeFileNotFound,
+                               TreeFileExceptionHierarchy,
+                               "The input tree file does not exist.");
+
+/**
+* MalformedExpression
+* --------------------
+* Description: Exception used when the input file is missing.
+*/
+DEFINE_SPECIFIC_EXCEPTION_TEXT(MalformedExpression,
+                               TreeFileExceptionHierarchy,
+                               "The input is not correctly formed");
+
+
+/**
+* MissingDataException
+* --------------------
+* Description: Exception used when missing data in leaf nodes is not allowed
+*/
+DEFINE_SPECIFIC_EXCEPTION_TEXT(MissingDataException,
+                               TreeFileExceptionHierarchy,
+                               "Missing data not allowed. All terminal nodes should have name");
+
+
+/**
+* Class: NewickReader
+* -------------------
+* Description: Reads the trees of a newick file one at a time, so that
+* clients can process files of any size without holding every tree
+* in memory. Only the current line of the file is kept, and gzip or
+* zstd compressed files are decompressed on the fly.
+* Type Parameter T: T is the underlying node class
+*/
+template < class T, class ValidationPolicy = DefaultValidationPolicy >
+class NewickReader
+{
+public:
+
+    /**
+     * Constructor
+     *
+     * @param fname file path
+     * @param locationManager Manager of locations and distances between locations.
+     * It must outlive the reader.
+     * @param validationPolicy policy used to validate nodes
+     */
+    NewickReader(const std::string& fname,
+                 const Locations::LocationManager& locationManager,
+                 const ValidationPolicy& validationPolicy = ValidationPolicy()) :
+        f(fname),
+        locationManager(locationManager),
+        validationPolicy(validationPolicy),
+        character(NULL),
+        atLineEnd(true),
+        nextTreeId(1),
+        currentLineNumber(0)
+    {
+        if (!f)
+            throw TreeFileNotFound();
+    }
+
+    /**
+     * Informs whether there is input left to be read as a tree
+     *
+     * @return true if readTree or next may be called
+     */
+    bool hasNext()
+    {
+        if (atLineEnd && getline(f, line))
+        {
+            character = line.c_str();
+            atLineEnd = false;
+            currentLineNumber++;
+        }
+        return !atLineEnd;
+    }
+
+    /**
+     * Reads the next tree into a tree supplied by the client
+     *
+     * @param tree Empty tree to be filled with the next tree of the file
+     */
+    void readTree(Domain::ITree<T>* tree)
+    {
+        if (!hasNext())
+            throw MalformedExpression(getLineNumberText());
+
+        load_node(tree->getRoot());
+        consume_whitespace();
+        if (*character != ';')
+            throw MissingTreeSeparator(getLineNumberText());
+
+        ++character;
+        atLineEnd = (*character == 0);
+    }
+
+    /**
+     * Reads the next tree, handing its ownership to the client
+     *
+     * @return the next tree of the file, or NULL if there are no more trees
+     */
+    Domain::ITree<T>* next()
+    {
+        Domain::ITree<T>* tree = NULL;
+
+        if (hasNext())
+        {
+            tree = new Domain::ITree<T>(nextTreeId++);
+            try
+            {
+                readTree(tree);
+            }
+            catch (...)
+            {
+                delete tree;
+                throw;
+            }
+        }
+        return tree;
+    }
+
+private:
+    DataSource::InputFileStream f;
+    std::string line;
+    const Locations::LocationManager& locationManager;
+    ValidationPolicy validationPolicy;
+    const char* character;
+    bool atLineEnd;
+    Domain::TreeId nextTreeId;
+
+    /****************************************************
+     ** This variable and method will no longer be
+     ** needed when mili generic exceptions is updated.
+     *********       mili issue 35              ********/
+
+    unsigned int currentLineNumber;
+
+    std::string getLineNumberText() const
+    {
+        std:: stringstream s;
+        s << "Line: " << currentLineNumber;
+        return s.str();
+    }
+    /****************************************************/
+
+    /**
+     * Loads a node and all its children recursively
+     *
+     * @param node Node to be filled
+     */
+    void load_node(T* node)
+    {
+        std::string name;
+        float branchLength = 0.0f;
+        // Output: either ',' or ')' (depending on the node type)
+        consume_whitespace();
+
+        switch (*character)
+        {
+            case '(':
+                // We are nonleaf. Load new child.
+                ++character;
+                load_children(node); // leaves in a parent
+                character++;
+                name = consume_name();
+                if (!readSupport(node, name))
+                    node->setName(name);
+                branchLength = consume_branch_length();
+                node->setBranchLength(branchLength);
+
+                break;
+            case ',':
+            case ')':
+                //Allow nameless nodes: dont consume character.
+                node->setName("");
+                node->setBranchLength(0.0f);
+                break;
+            case 0:
+                throw MalformedExpression(getLineNumberText());
+            default:
+                // We are leaf.
+                name = consume_name();
+                node->setName(name);
+                branchLength = consume_branch_length();
+                node->setBranchLength(branchLength);
+        }
+        // Set location id, LOCATION_NOT_FOUND if there is none
+        node->setLocationId(locationManager.getNameLocationId(name));
+        if (!validationPolicy.validate(node))
+            throw MissingDataException(getLineNumberText());
+    }
+
+    /**
+     * Loads a nodes children
+     *
+     * @param parent node whose children will be loaded
+     */
+    void load_children(T* parent)
+    {
+        T* child;
+        bool keep_reading = true;
+
+        // Input: first char of first child.
+        // output: ')'
+        do
+        {
+            child = parent->template addChild<T>();
+            load_node(child);
+            consume_whitespace();
+            switch (*character)
+            {
+                case ',':
+                    keep_reading = true;
+                    ++character;
+                    break;
+                case ')':
+                    keep_reading = false;
+                    break;
+                default:
+                    throw MalformedExpression(getLineNumberText());
+            }
+        }
+        while (keep_reading);
+    }
+
+    static inline bool is_namechar(char c)
+    {
+        return mili::in_range(c, '0', '9') ||
+               mili::in_range(c, 'a', 'z') ||
+               mili::in_range(c, 'A', 'Z') ||
+               c == '_' ||
+               c == '-' ||
+               c == '.';
+    }
+
+    static inline bool is_branchlen_char(char c)
+    {
+        // NewickWriter uses exponent notation for very small or large lengths
+        return mili::in_range(c, '0', '9') ||
+               c == '.' ||
+               c == 'e' ||
+               c == 'E' ||
+               c == '+' ||
+               c == '-';
+    }
+
+    // Nodes without a SupportAspect keep every label as their name
+    bool readSupport(void* /*node*/, const std::string& /*label*/)
+    {
+        return false;
+    }
+
+    /**
+     * Reads a numeric internal label, as written by NewickWriter, as
+     * the support of the node.
+     *
+     * @return true if the label was a support
+     */
+    bool readSupport(Domain::SupportHolder* node, const std::string& label)
+    {
+        std::stringstream ss(label);
+        Domain::Support support;
+        ss >> support;
+        const bool isSupport = !label.empty() && !ss.fail() && ss.eof();
+        if (isSupport)
+            node->setSupport(support);
+        return isSupport;
+    }
+
+    std::string consume_name()
+    {
+        std::string ret;
+        while (is_namechar(*character))
+        {
+            ret += *character;
+            ++character;
+        }
+
+        return ret;
+    }
+
+    void consume_whitespace()
+    {
+        while (*character == ' ' || *character == '\t')
+            ++character;
+    }
+
+    float consume_branch_length()
+    {
+        consume_whitespace();
+        float ret = 0.0f;
+        if (*character == ':')
+        {
+            ++character;
+            std::string branchLenStr;
+            while (is_branchlen_char(*character))
+            {
+                branchLenStr += *character;
+                ++character;
+            }
+
+            if (!mili::from_string(branchLenStr, ret))
+                throw MalformedExpression(getLineNumberText());
+
+        }
+        return ret;
+    }
+};
+
+#endif
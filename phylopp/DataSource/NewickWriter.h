@@ -23,10 +23,17 @@
 #ifndef NEWICK_WRITER_H
 #define NEWICK_WRITER_H
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string>
+#include <vector>
 #include <iostream>
-#include <fstream>
 #include "phylopp/Domain/ITree.h"
+#include "phylopp/Domain/ITreeCollection.h"
 #include "phylopp/Domain/ListIterator.h"
+#include "phylopp/Domain/SupportAspect.h"
+#include "phylopp/DataSource/FileStreams.h"
 
 template <class T>
 class NewickWriter
@@ -34,21 +41,71 @@ class NewickWriter
 public:
 
     /**
-     * Saves a collection of trees to a file
+     * Precision value that makes the writer emit the shortest branch length
+     * representation that reads back to exactly the same float.
+     */
+    static const unsigned int SHORTEST_PRECISION = 0;
+
+    /**
+     * Constructor
+     *
+     * @param precision Significant digits used for branch lengths,
+     * or SHORTEST_PRECISION for shortest round-trip output
+     */
+    NewickWriter(unsigned int precision = SHORTEST_PRECISION) :
+        precision(precision)
+    {
+        buffer.reserve(BUFFER_SIZE + MAX_TOKEN_SIZE);
+    }
+
+    /**
+     * Sets the significant digits used for branch lengths
+     *
+     * @param digits Significant digits, or SHORTEST_PRECISION
+     */
+    void setPrecision(unsigned int digits)
+    {
+        precision = digits;
+    }
+
+    /**
+     * Saves a collection of trees to a file. Files named "*.gz" or
+     * "*.zst" are compressed.
      *
      * @param fname file name in which the trees will be saved
      * @param trees The collection of trees to be saved
      */
     void saveNewickFile(const std::string& fname, const Domain::ITreeCollection<T>& trees)
     {
-        std::ofstream os(fname.c_str());
+        DataSource::OutputFileStream os(fname);
+        saveNewickStream(os, trees);
+    }
 
+    /**
+     * Saves a collection of trees to a stream
+     *
+     * @param os Stream in which the trees will be saved
+     * @param trees The collection of trees to be saved
+     */
+    void saveNewickStream(std::ostream& os, const Domain::ITreeCollection<T>& trees)
+    {
         for (typename TreeCollection::iterator iter = trees.getIterator(); !iter.end(); iter.next())
         {
-            Domain::ITree<T>* tree = iter.get();
-            saveTree(tree->getRoot(), os);
-            os << ";\n";
+            saveTree(iter.get()->getRoot(), os);
         }
+        flush(os);
+    }
+
+    /**
+     * Saves a single tree to a stream
+     *
+     * @param os Stream in which the tree will be saved
+     * @param tree The tree to be saved
+     */
+    void saveNewickTree(std::ostream& os, const Domain::ITree<T>* tree)
+    {
+        saveTree(tree->getRoot(), os);
+        flush(os);
     }
 
 private:
@@ -56,36 +113,180 @@ private:
     typedef Domain::ITreeCollection<T> TreeCollection;
     typedef Domain::ListIterator<T, Domain::Node> NodeIterator;
 
+    // Output is flushed in blocks of this size
+    static const size_t BUFFER_SIZE = 1 << 16;
+    // Room for the longest formatted branch length
+    static const size_t MAX_TOKEN_SIZE = 32;
+    // Enough significant digits to round-trip any float
+    static const unsigned int MAX_FLOAT_DIGITS = 9;
+    // Integral branch lengths below this bound are written as integers
+    static const int MAX_INTEGRAL_LENGTH = 1000000;
+
+    enum WriteAction
+    {
+        OpenNode,
+        CloseNode,
+        SeparateNodes
+    };
+
+    struct WriteFrame
+    {
+        const T* node;
+        WriteAction action;
+
+        WriteFrame(const T* n, WriteAction a) :
+            node(n),
+            action(a)
+        {}
+    };
+
+    unsigned int precision;
+    std::string buffer;
+    std::vector<WriteFrame> pending;
+    std::vector<const T*> children;
+
     /**
-     * Saves a tree in a file recursively
+     * Appends a tree to the output buffer, without recursion
      *
-     * @param node Node to be saved
-     * @param os File stream in which the node will be saved
+     * @param root Root of the tree to be saved
+     * @param os Stream which receives the buffer every BUFFER_SIZE bytes
      */
-    static void saveTree(const T* node, std::ostream& os)
+    void saveTree(const T* root, std::ostream& os)
     {
+        pending.push_back(WriteFrame(root, OpenNode));
 
-        if (!node->isLeaf())
+        while (!pending.empty())
         {
-            os << '(';
-            NodeIterator iter = node->template getChildrenIterator<T>();
+            const WriteFrame frame = pending.back();
+            pending.pop_back();
 
-            //the first node does not have to be preceded by ','
-            if (!iter.end())
+            switch (frame.action)
             {
-                saveTree(iter.get(), os);
-                iter.next();
+                case OpenNode:
+                    if (frame.node->isLeaf())
+                    {
+                        writeLabel(frame.node);
+                    }
+                    else
+                    {
+                        buffer += '(';
+                        pushChildren(frame.node);
+                    }
+                    break;
+                case CloseNode:
+                    buffer += ')';
+                    writeLabel(frame.node);
+                    break;
+                case SeparateNodes:
+                    buffer += ',';
+                    break;
             }
 
-            for (; !iter.end(); iter.next())
-            {
-                os << ',';
-                saveTree(iter.get(), os);
-            }
-            os << ')';
+            if (buffer.size() >= BUFFER_SIZE)
+                flush(os);
+        }
+        buffer += ";\n";
+    }
 
+    /**
+     * Schedules the children of a node, so that they are written
+     * in order, separated by ',' and followed by ')'
+     *
+     * @param node Internal node whose children will be written
+     */
+    void pushChildren(const T* node)
+    {
+        pending.push_back(WriteFrame(node, CloseNode));
+
+        children.clear();
+        for (NodeIterator iter = node->template getChildrenIterator<T>(); !iter.end(); iter.next())
+            children.push_back(iter.get());
+
+        //the first node does not have to be preceded by ','
+        for (size_t i = children.size(); i > 1; --i)
+        {
+            pending.push_back(WriteFrame(children[i - 1], OpenNode));
+            pending.push_back(WriteFrame(NULL, SeparateNodes));
+        }
+        pending.push_back(WriteFrame(children[0], OpenNode));
+    }
+
+    void writeLabel(const T* node)
+    {
+        if (node->getName().empty() && !node->isLeaf())
+            writeSupport(node);
+        else
+            buffer += node->getName();
+        buffer += ':';
+        writeNumber(node->getBranchLength());
+    }
+
+    // Nodes without a SupportAspect have no support to write
+    void writeSupport(const void* /*node*/)
+    {}
+
+    void writeSupport(const Domain::SupportHolder* node)
+    {
+        if (node->hasSupport())
+            writeNumber(node->getSupport());
+    }
+
+    /**
+     * Formats a branch length or a support into the buffer. Integral
+     * values are written directly, the rest through printf "%g" style
+     * formatting.
+     *
+     * @param length Value to be written
+     */
+    void writeNumber(Domain::BranchLength length)
+    {
+        char token[MAX_TOKEN_SIZE];
+        int written;
+
+        if (fabs(length) < MAX_INTEGRAL_LENGTH && length == static_cast<int>(length))
+            written = snprintf(token, sizeof(token), "%d", static_cast<int>(length));
+        else if (precision != SHORTEST_PRECISION)
+            written = snprintf(token, sizeof(token), "%.*g", precision, length);
+        else
+            written = formatShortest(length, token);
+
+        normalizeDecimalPoint(token, written);
+        buffer.append(token, written);
+    }
+
+    /**
+     * Writes the shortest decimal representation of a float that
+     * parses back to the very same value.
+     *
+     * @return amount of characters written
+     */
+    static int formatShortest(Domain::BranchLength length, char* token)
+    {
+        int written = 0;
+        bool roundTrips = false;
+
+        for (unsigned int digits = 1; digits <= MAX_FLOAT_DIGITS && !roundTrips; ++digits)
+        {
+            written = snprintf(token, MAX_TOKEN_SIZE, "%.*g", digits, length);
+            roundTrips = (strtof(token, NULL) == length);
         }
-        os << node->getName() << ':' << node->getBranchLength();
+        return written;
+    }
+
+    // newick always uses '.' regardless of the process locale
+    static void normalizeDecimalPoint(char* token, int length)
+    {
+        for (int i = 0; i < length; ++i)
+        {
+            if (token[i] == ',')
+                token[i] = '.';
+        }
+    }
+
+    void flush(std::ostream& os)
+    {
+        os.write(buffer.data(), buffer.size());
+        buffer.clear();
     }
 };
 
@@ -0,0 +1,275 @@
+/*
+    Copyright (C) 2011 Emmanuel Teisaire, Nicolás Bombau, Carlos Castro, Damián Domé, FuDePAN
+
+    This file is part of the Phyloloc project.
+
+    Phyloloc is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Phyloloc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DISTANCE_MATRIX_H
+#define DISTANCE_MATRIX_H
+
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+
+namespace Locations
+{
+
+typedef float Distance;
+
+/**
+* Method: pairwiseSum
+* -------------------
+* Description: Sums count distances. Blocks are summed with eight
+* independent accumulators, which the compiler can keep in vector
+* registers, and blocks are combined pairwise, so the rounding error
+* grows with log(count) rather than with count.
+* Returns: The sum of the distances
+*/
+inline Distance pairwiseSum(const Distance* values, size_t count)
+{
+    static const size_t LANES = 8;
+    static const size_t BLOCK = 256;
+
+    Distance sum;
+
+    if (count > BLOCK)
+    {
+        const size_t half = count / 2;
+        sum = pairwiseSum(values, half) + pairwiseSum(values + half, count - half);
+    }
+    else
+    {
+        Distance lanes[LANES] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+        const size_t vectorized = count - count % LANES;
+
+        for (size_t i = 0; i < vectorized; i += LANES)
+            for (size_t lane = 0; lane < LANES; lane++)
+                lanes[lane] += values[i + lane];
+
+        for (size_t i = vectorized; i < count; i++)
+            lanes[i - vectorized] += values[i];
+
+        sum = ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3]))
+              + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+    }
+
+    return sum;
+}
+
+/**
+* Class: DistanceMatrix
+* ---------------------
+* Description: Square matrix of distances stored in a single row-major
+* buffer. Rows are stride() elements apart and start on a cache line
+* boundary, so row scans can be vectorized. Cells outside the matrix
+* size are always zero.
+*/
+class DistanceMatrix
+{
+public:
+
+    // Rows are aligned to this many bytes
+    static const size_t ROW_ALIGNMENT = 64;
+
+    DistanceMatrix() :
+        count(0),
+        rowStride(0),
+        offset(0)
+    {}
+
+    DistanceMatrix(const DistanceMatrix& other) :
+        count(0),
+        rowStride(0),
+        offset(0)
+    {
+        *this = other;
+    }
+
+    DistanceMatrix& operator=(const DistanceMatrix& other)
+    {
+        if (this != &other)
+        {
+            clear();
+            if (other.rowStride > 0)
+            {
+                allocate(other.rowStride);
+                std::copy(other.data(), other.data() + rowStride * rowStride, data());
+            }
+            count = other.count;
+        }
+        return *this;
+    }
+
+    /**
+    * Method: resize
+    * --------------
+    * Description: Grows the matrix to n x n, keeping its contents and
+    * filling new cells with zero. The buffer grows geometrically, so
+    * adding locations one at a time does not copy the matrix every time.
+    * @param n new amount of rows and columns, never less than size()
+    */
+    void resize(size_t n)
+    {
+        if (n > rowStride)
+        {
+            DistanceMatrix grown;
+            grown.allocate(std::max(n, rowStride + rowStride / 2));
+
+            for (size_t i = 0; i < count; i++)
+                std::copy(row(i), row(i) + count, grown.row(i));
+
+            swap(grown);
+        }
+        count = std::max(count, n);
+    }
+
+    void clear()
+    {
+        std::vector<Distance>().swap(storage);
+        count = rowStride = offset = 0;
+    }
+
+    void swap(DistanceMatrix& other)
+    {
+        storage.swap(other.storage);
+        std::swap(count, other.count);
+        std::swap(rowStride, other.rowStride);
+        std::swap(offset, other.offset);
+    }
+
+    size_t size() const
+    {
+        return count;
+    }
+
+    bool empty() const
+    {
+        return count == 0;
+    }
+
+    /**
+    * Method: stride
+    * --------------
+    * Returns: The distance, in elements, between two consecutive rows
+    */
+    size_t stride() const
+    {
+        return rowStride;
+    }
+
+    Distance* data()
+    {
+        return storage.empty() ? NULL : &storage[offset];
+    }
+
+    const Distance* data() const
+    {
+        return storage.empty() ? NULL : &storage[offset];
+    }
+
+    Distance* row(size_t i)
+    {
+        return data() + i * rowStride;
+    }
+
+    const Distance* row(size_t i) const
+    {
+        return data() + i * rowStride;
+    }
+
+    Distance& operator()(size_t i, size_t j)
+    {
+        return storage[offset + i * rowStride + j];
+    }
+
+    Distance operator()(size_t i, size_t j) const
+    {
+        return storage[offset + i * rowStride + j];
+    }
+
+    Distance get(size_t i, size_t j) const
+    {
+        return (*this)(i, j);
+    }
+
+    void set(size_t i, size_t j, Distance distance)
+    {
+        (*this)(i, j) = distance;
+    }
+
+    /**
+    * Method: rowSum
+    * --------------
+    * Returns: The sum of the first n distances of row i
+    */
+    Distance rowSum(size_t i, size_t n) const
+    {
+        return pairwiseSum(row(i), n);
+    }
+
+    /**
+    * Method: countMissing
+    * --------------------
+    * Returns: How many distances from i to the locations in [begin, end),
+    * other than i itself, are zero
+    */
+    size_t countMissing(size_t i, size_t begin, size_t end) const
+    {
+        const Distance* const distances = row(i);
+        size_t zeros = 0;
+
+        for (size_t j = begin; j < end; j++)
+            zeros += (distances[j] == 0.0f) ? 1 : 0;
+
+        if (begin <= i && i < end && distances[i] == 0.0f)
+            zeros--;
+
+        return zeros;
+    }
+
+    /**
+    * Method: bytes
+    * -------------
+    * Returns: The memory used by the distances
+    */
+    size_t bytes() const
+    {
+        return storage.capacity() * sizeof(Distance);
+    }
+
+private:
+
+    static const size_t ALIGNMENT_ELEMENTS = ROW_ALIGNMENT / sizeof(Distance);
+
+    std::vector<Distance> storage;
+    size_t count;
+    size_t rowStride;
+    size_t offset;
+
+    // Reserves a zeroed buffer for stride x stride cells
+    void allocate(size_t stride)
+    {
+        rowStride = (stride + ALIGNMENT_ELEMENTS - 1) / ALIGNMENT_ELEMENTS * ALIGNMENT_ELEMENTS;
+        storage.assign(rowStride * rowStride + ALIGNMENT_ELEMENTS, 0.0f);
+
+        const size_t misalignment = reinterpret_cast<uintptr_t>(&storage[0]) % ROW_ALIGNMENT;
+        offset = (misalignment == 0) ? 0 : (ROW_ALIGNMENT - misalignment) / sizeof(Distance);
+    }
+};
+
+}
+
+#endif
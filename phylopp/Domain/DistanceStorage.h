@@ -0,0 +1,405 @@
+/*
+    Copyright (C) 2011 Emmanuel Teisaire, Nicolás Bombau, Carlos Castro, Damián Domé, FuDePAN
+
+    This file is part of the Phyloloc project.
+
+    Phyloloc is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Phyloloc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef DISTANCE_STORAGE_H
+#define DISTANCE_STORAGE_H
+
+#include <vector>
+#include <algorithm>
+#include "DistanceMatrix.h"
+
+namespace Locations
+{
+
+/**
+* Enum: DistanceStorage
+* ---------------------
+* Description: How a LocationManager stores its distances.
+* DenseStorage keeps every distance of a full matrix.
+* SymmetricStorage keeps one distance per pair of locations.
+* SparseStorage keeps only the given distances and answers a default
+* distance for every other pair of different locations.
+*/
+enum DistanceStorage
+{
+    DenseStorage,
+    SymmetricStorage,
+    SparseStorage
+};
+
+/**
+* Class: SymmetricDistanceMatrix
+* ------------------------------
+* Description: Symmetric matrix of distances that stores the lower
+* triangle, diagonal included, packed row by row. Cell (i, j) with
+* i >= j is at i * (i + 1) / 2 + j, so growing only appends cells.
+*/
+class SymmetricDistanceMatrix
+{
+public:
+
+    SymmetricDistanceMatrix() :
+        count(0)
+    {}
+
+    /**
+    * Method: resize
+    * --------------
+    * Description: Grows the matrix to n x n, filling new cells with zero.
+    * @param n new amount of rows and columns, never less than size()
+    */
+    void resize(size_t n)
+    {
+        count = std::max(count, n);
+        cells.resize(count * (count + 1) / 2, 0.0f);
+    }
+
+    void clear()
+    {
+        std::vector<Distance>().swap(cells);
+        count = 0;
+    }
+
+    size_t size() const
+    {
+        return count;
+    }
+
+    bool empty() const
+    {
+        return count == 0;
+    }
+
+    Distance get(size_t i, size_t j) const
+    {
+        return cells[index(i, j)];
+    }
+
+    /**
+    * Method: set
+    * -----------
+    * Description: Sets the distance from i to j and from j to i
+    */
+    void set(size_t i, size_t j, Distance distance)
+    {
+        cells[index(i, j)] = distance;
+    }
+
+    /**
+    * Method: rowSum
+    * --------------
+    * Returns: The sum of the first n distances of row i
+    */
+    Distance rowSum(size_t i, size_t n) const
+    {
+        //the cells left of the diagonal are contiguous
+        const size_t packed = std::min(i + 1, n);
+        const Distance left = pairwiseSum(&cells[index(i, 0)], packed);
+
+        //the cells right of the diagonal are one column of the rows below
+        double right = 0.0;
+        for (size_t j = i + 1; j < n; j++)
+            right += cells[index(j, i)];
+
+        return left + Distance(right);
+    }
+
+    /**
+    * Method: countMissing
+    * --------------------
+    * Returns: How many distances from i to the locations in [begin, end),
+    * other than i itself, are zero
+    */
+    size_t countMissing(size_t i, size_t begin, size_t end) const
+    {
+        size_t zeros = 0;
+
+        //the cells left of the diagonal are contiguous
+        const Distance* const row = &cells[index(i, 0)];
+        for (size_t j = begin; j < std::min(end, i); j++)
+            zeros += (row[j] == 0.0f) ? 1 : 0;
+
+        //the cells right of the diagonal are one column of the rows below
+        for (size_t j = std::max(begin, i + 1); j < end; j++)
+            zeros += (cells[index(j, i)] == 0.0f) ? 1 : 0;
+
+        return zeros;
+    }
+
+    /**
+    * Method: bytes
+    * -------------
+    * Returns: The memory used by the distances
+    */
+    size_t bytes() const
+    {
+        return cells.capacity() * sizeof(Distance);
+    }
+
+private:
+
+    std::vector<Distance> cells;
+    size_t count;
+
+    static size_t index(size_t i, size_t j)
+    {
+        return (i >= j) ? i * (i + 1) / 2 + j : j * (j + 1) / 2 + i;
+    }
+};
+
+/**
+* Class: SparseDistanceMatrix
+* ---------------------------
+* Description: Matrix of distances in compressed sparse row form, for
+* data where most pairs of locations share a default distance. New
+* distances are buffered and merged into the rows on compact(); get()
+* searches the buffer linearly, so compact after adding many distances.
+* The distance from a location to itself defaults to zero.
+*/
+class SparseDistanceMatrix
+{
+public:
+
+    explicit SparseDistanceMatrix(Distance defaultDistance = 0.0f) :
+        count(0),
+        defaultValue(defaultDistance)
+    {}
+
+    void resize(size_t n)
+    {
+        count = std::max(count, n);
+    }
+
+    void clear()
+    {
+        std::vector<unsigned int>().swap(rowOffsets);
+        std::vector<unsigned int>().swap(columns);
+        std::vector<Distance>().swap(values);
+        std::vector<Entry>().swap(pending);
+        count = 0;
+    }
+
+    size_t size() const
+    {
+        return count;
+    }
+
+    bool empty() const
+    {
+        return count == 0;
+    }
+
+    Distance getDefaultDistance() const
+    {
+        return defaultValue;
+    }
+
+    void setDefaultDistance(Distance defaultDistance)
+    {
+        defaultValue = defaultDistance;
+    }
+
+    Distance get(size_t i, size_t j) const
+    {
+        //the newest buffered distance wins over the rows
+        for (size_t k = pending.size(); k > 0; --k)
+        {
+            if (pending[k - 1].row == i && pending[k - 1].column == j)
+                return pending[k - 1].value;
+        }
+
+        Distance distance = (i == j) ? 0.0f : defaultValue;
+
+        if (i + 1 < rowOffsets.size() && rowOffsets[i] < rowOffsets[i + 1])
+        {
+            const unsigned int* const begin = &columns[0] + rowOffsets[i];
+            const unsigned int* const end = &columns[0] + rowOffsets[i + 1];
+            const unsigned int* const column = std::lower_bound(begin, end, static_cast<unsigned int>(j));
+
+            if (column != end && *column == j)
+                distance = values[column - &columns[0]];
+        }
+
+        return distance;
+    }
+
+    void set(size_t i, size_t j, Distance distance)
+    {
+        pending.push_back(Entry(i, j, distance, pending.size()));
+    }
+
+    /**
+    * Method: rowSum
+    * --------------
+    * Returns: The sum of the first n distances of row i
+    */
+    Distance rowSum(size_t i, size_t n) const
+    {
+        compact();
+
+        Distance sum = 0.0f;
+        size_t defaults = (i < n) ? n - 1 : n;
+
+        if (i + 1 < rowOffsets.size())
+        {
+            for (unsigned int k = rowOffsets[i]; k < rowOffsets[i + 1] && columns[k] < n; k++)
+            {
+                sum += values[k];
+                if (columns[k] != i)
+                    defaults--;
+            }
+        }
+
+        return sum + defaultValue * Distance(defaults);
+    }
+
+    /**
+    * Method: countMissing
+    * --------------------
+    * Returns: How many distances from i to the locations in [begin, end),
+    * other than i itself, are zero
+    */
+    size_t countMissing(size_t i, size_t begin, size_t end) const
+    {
+        compact();
+
+        size_t zeros = 0;
+        size_t given = 0;
+
+        if (i + 1 < rowOffsets.size())
+        {
+            for (unsigned int k = rowOffsets[i]; k < rowOffsets[i + 1] && columns[k] < end; k++)
+            {
+                if (columns[k] >= begin && columns[k] != i)
+                {
+                    zeros += (values[k] == 0.0f) ? 1 : 0;
+                    given++;
+                }
+            }
+        }
+
+        if (defaultValue == 0.0f)
+        {
+            //every distance not given is missing too
+            const size_t others = (begin <= i && i < end) ? end - begin - 1 : end - begin;
+            zeros += others - given;
+        }
+
+        return zeros;
+    }
+
+    /**
+    * Method: compact
+    * ---------------
+    * Description: Merges the buffered distances into the rows. rowSum
+    * and countMissing do it on demand; get() never does, so it may be
+    * called from several threads.
+    */
+    void compact() const
+    {
+        if (!pending.empty())
+        {
+            std::vector<Entry> entries;
+            entries.reserve(values.size() + pending.size());
+
+            for (size_t i = 0; i + 1 < rowOffsets.size(); i++)
+                for (unsigned int k = rowOffsets[i]; k < rowOffsets[i + 1]; k++)
+                    entries.push_back(Entry(i, columns[k], values[k], 0));
+
+            //pending entries come after the stored ones, newest last
+            for (size_t k = 0; k < pending.size(); k++)
+            {
+                entries.push_back(pending[k]);
+                entries.back().order++;
+            }
+            std::vector<Entry>().swap(pending);
+
+            std::sort(entries.begin(), entries.end());
+
+            rowOffsets.assign(count + 1, 0);
+            columns.clear();
+            values.clear();
+
+            for (size_t k = 0; k < entries.size(); k++)
+            {
+                const bool newest = k + 1 == entries.size()
+                                    || entries[k + 1].row != entries[k].row
+                                    || entries[k + 1].column != entries[k].column;
+                if (newest)
+                {
+                    rowOffsets[entries[k].row + 1]++;
+                    columns.push_back(entries[k].column);
+                    values.push_back(entries[k].value);
+                }
+            }
+
+            for (size_t i = 0; i < count; i++)
+                rowOffsets[i + 1] += rowOffsets[i];
+        }
+    }
+
+    /**
+    * Method: bytes
+    * -------------
+    * Returns: The memory used by the distances
+    */
+    size_t bytes() const
+    {
+        return rowOffsets.capacity() * sizeof(unsigned int)
+               + columns.capacity() * sizeof(unsigned int)
+               + values.capacity() * sizeof(Distance)
+               + pending.capacity() * sizeof(Entry);
+    }
+
+private:
+
+    struct Entry
+    {
+        unsigned int row;
+        unsigned int column;
+        Distance value;
+        size_t order;
+
+        Entry(size_t row, size_t column, Distance value, size_t order) :
+            row(static_cast<unsigned int>(row)),
+            column(static_cast<unsigned int>(column)),
+            value(value),
+            order(order)
+        {}
+
+        bool operator<(const Entry& other) const
+        {
+            return (row != other.row) ? row < other.row :
+                   (column != other.column) ? column < other.column :
+                   order < other.order;
+        }
+    };
+
+    size_t count;
+    Distance defaultValue;
+    mutable std::vector<unsigned int> rowOffsets;
+    mutable std::vector<unsigned int> columns;
+    mutable std::vector<Distance> values;
+    mutable std::vector<Entry> pending;
+};
+
+} // End of Namespace Locations
+
+#endif
@@ -24,6 +24,7 @@
 #include <string>
 #include <map>
 #include <set>
+#include <vector>
 
 #include "phylopp/Domain/INode.h"
 
@@ -82,6 +83,42 @@ public:
         return id;
     }
 
+    /*
+    * Method: getLeaves
+    * -----------------
+    * Description: Collects the leaves of the tree, from left to right
+    * @param leaves receives the leaves
+    */
+    void getLeaves(std::vector<const T*>& leaves) const
+    {
+        leaves.clear();
+
+        //a stack is used to avoid recursion on deep trees
+        std::vector<const T*> pending;
+        std::vector<const T*> children;
+        pending.push_back(&root);
+
+        while (!pending.empty())
+        {
+            const T* const node = pending.back();
+            pending.pop_back();
+
+            if (node->isLeaf())
+            {
+                leaves.push_back(node);
+            }
+            else
+            {
+                children.clear();
+                for (ListIterator<T, Node> it = node->template getChildrenIterator<T>(); !it.end(); it.next())
+                    children.push_back(it.get());
+
+                //the leftmost child is visited first
+                pending.insert(pending.end(), children.rbegin(), children.rend());
+            }
+        }
+    }
+
 private:
     T root;
     const TreeId id;
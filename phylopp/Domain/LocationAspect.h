@@ -20,7 +20,10 @@
 #ifndef LOCATION_H
 #define LOCATION_H
 
+#include <vector>
 #include "LocationManager.h"
+#include "ITree.h"
+#include "ITreeCollection.h"
 
 namespace Locations
 {
@@ -30,6 +33,10 @@ class LocationAspect : public T
 {
 public:
 
+    LocationAspect() :
+        locationId(LOCATION_NOT_FOUND)
+    {}
+
     /**
     * Method: setLocationId
     * ---------------
@@ -58,6 +65,82 @@ private:
 
 };
 
+/**
+* Method: resolveLocationIds
+* --------------------------
+* Description: Sets the location id of every node of the tree from its
+* name, or LOCATION_NOT_FOUND if the name has no location. Must be called
+* again whenever the locations of the manager change.
+* Type Parameter T: T is the node type, derived from LocationAspect
+*/
+template <class T>
+void resolveLocationIds(Domain::ITree<T>* tree, const LocationManager& locationManager)
+{
+    //a stack is used to avoid recursion on deep trees
+    std::vector<T*> pending;
+    pending.push_back(tree->getRoot());
+
+    while (!pending.empty())
+    {
+        T* const node = pending.back();
+        pending.pop_back();
+
+        node->setLocationId(locationManager.getNameLocationId(node->getName()));
+
+        for (Domain::ListIterator<T, Domain::Node> it = node->template getChildrenIterator<T>(); !it.end(); it.next())
+            pending.push_back(it.get());
+    }
+}
+
+/**
+* Method: resolveLocationIds
+* --------------------------
+* Description: Sets the location id of every node of every tree of the
+* collection from its name.
+* Type Parameter T: T is the node type, derived from LocationAspect
+*/
+template <class T>
+void resolveLocationIds(const Domain::ITreeCollection<T>& trees, const LocationManager& locationManager)
+{
+    for (typename Domain::ITreeCollection<T>::iterator it = trees.getIterator(); !it.end(); it.next())
+        resolveLocationIds(it.get(), locationManager);
+}
+
+/**
+* Method: getLeafLocationIds
+* --------------------------
+* Description: Collects the cached location ids of the leaves of the
+* tree, from left to right.
+* Type Parameter T: T is the node type, derived from LocationAspect
+*/
+template <class T>
+void getLeafLocationIds(const Domain::ITree<T>* tree, std::vector<LocationId>& ids)
+{
+    std::vector<const T*> leaves;
+    tree->getLeaves(leaves);
+
+    ids.resize(leaves.size());
+    for (size_t i = 0; i < leaves.size(); i++)
+        ids[i] = leaves[i]->getLocationId();
+}
+
+/**
+* Method: getLeafDistances
+* ------------------------
+* Description: Computes the distances among all the leaves of the tree
+* in one call, using the cached location ids.
+* @param result receives at row i and column j the distance from the
+* i-th leaf to the j-th leaf, counting leaves from left to right
+* Type Parameter T: T is the node type, derived from LocationAspect
+*/
+template <class T>
+void getLeafDistances(const Domain::ITree<T>* tree, const LocationManager& locationManager, DistanceMatrix& result)
+{
+    std::vector<LocationId> ids;
+    getLeafLocationIds(tree, ids);
+    locationManager.distances(ids, result);
+}
+
 } // End of Namespace Location
 
 #endif
@@ -20,9 +20,15 @@ along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
 #define LOCATION_MANAGER_H
 
 #include <vector>
+#include <algorithm>
+#include <utility>
 #include <mili/mili.h>
 #include "INode.h"
 #include "ListIterator.h"
+#include "DistanceMatrix.h"
+#include "DistanceStorage.h"
+#include "NameTable.h"
+#include "ParallelFor.h"
 
 namespace Locations
 {
@@ -34,7 +40,6 @@ static const unsigned int ID_INCREMENT = 1;
 class LocationExceptionHierarchy {};
 
 typedef mili::GenericException<LocationExceptionHierarchy> LocationException;
-typedef float Distance;
 typedef std::vector<Distance> DistanceVector;
 typedef std::string Location;
 typedef unsigned int LocationId;
@@ -49,6 +54,31 @@ typedef unsigned int NodeNameId;
 DEFINE_SPECIFIC_EXCEPTION_TEXT(InvalidLocation,
                                LocationExceptionHierarchy,
                                "The location is not defined");
+template <class T>
+class LocationAspect;
+
+typedef std::pair<LocationId, LocationId> LocationPair;
+
+/**
+* Class: ValidationReport
+* ----------------------
+* Description: Everything that makes a LocationManager invalid
+*/
+class ValidationReport
+{
+public:
+
+    //named nodes without a location
+    std::vector<NodeNameId> nodesWithoutLocation;
+    //pairs of different locations without a distance, sorted
+    std::vector<LocationPair> missingDistances;
+
+    bool isValid() const
+    {
+        return nodesWithoutLocation.empty() && missingDistances.empty();
+    }
+};
+
 /**
 * Class: LocationManager
 * ----------------------
@@ -60,22 +90,84 @@ class LocationManager
 
 public:
 
-    mili::VariantsSet::iterator getLocations()
+    LocationManager() :
+        storage(DenseStorage),
+        dispersionOutdated(true),
+        validatedLocations(0)
+    {}
+
+    void clear()
     {
-        return locationIdSet.begin();
+        dispersionOutdated = true;
+        locationTable.clear();
+        nodeNameTable.clear();
+        nodeLocations.clear();
+        locationsDistances.clear();
+        symmetricDistances.clear();
+        sparseDistances.clear();
+        missingDistances.clear();
+        touchedRows.clear();
+        validatedLocations = 0;
     }
 
-    void clear()
+    /**
+    * Method: setDistanceStorage
+    * ----------------------
+    * Description: Chooses how distances are stored. Distances already
+    * added are moved to the new storage; symmetric storage keeps a
+    * single distance for each pair of locations.
+    * @param newStorage the storage to use from now on
+    * @param defaultDistance for sparse storage, the distance between
+    * two different locations without a given distance
+    */
+    void setDistanceStorage(const DistanceStorage newStorage, const Distance defaultDistance = 0.0f)
     {
-        nodeLocationSet.clear();
-        locationIdSet.clear();
-        nodeNameIdSet.clear();
+        compactDistances();
+
+        const size_t count = distancesSize();
+        LocationManager converted;
+        converted.storage = newStorage;
+        converted.sparseDistances.setDefaultDistance(defaultDistance);
+        converted.resizeDistancesMatrix(count);
 
-        for (unsigned int i = 0; i < locationsDistances.size(); i++)
+        for (size_t i = 0; i < count; i++)
         {
-            locationsDistances[i].clear();
+            for (size_t j = 0; j < count; j++)
+            {
+                const Distance distance = storedDistance(i, j);
+                const Distance implicit = (i == j) ? 0.0f : defaultDistance;
+                if (newStorage != SparseStorage || distance != implicit)
+                    converted.storeDistance(i, j, distance);
+            }
         }
-        locationsDistances.clear();
+
+        storage = newStorage;
+        locationsDistances.swap(converted.locationsDistances);
+        std::swap(symmetricDistances, converted.symmetricDistances);
+        std::swap(sparseDistances, converted.sparseDistances);
+        compactDistances();
+        dispersionOutdated = true;
+        validatedLocations = 0;
+    }
+
+    /**
+    * Method: getDistanceStorage
+    * ----------------------
+    * Returns: How distances are stored
+    */
+    DistanceStorage getDistanceStorage() const
+    {
+        return storage;
+    }
+
+    /**
+    * Method: getDistancesBytes
+    * ----------------------
+    * Returns: The memory used to store the distances
+    */
+    size_t getDistancesBytes() const
+    {
+        return locationsDistances.bytes() + symmetricDistances.bytes() + sparseDistances.bytes();
     }
 
     /**
@@ -85,17 +177,26 @@ public:
     */
     void addLocation(const Location& location, const Domain::NodeName& name)
     {
-        const LocationId id = getLocationId(location);
-        const NodeNameId nameId = getNodeNameId(name);
+        const LocationId id = locationTable.insert(location);
+        const NodeNameId nameId = nodeNameTable.insert(name);
 
-        //TODO: generate Id in private method
-        size_t generatedId = (id == LOCATION_NOT_FOUND) ? getLocationsCount() + ID_INCREMENT : id;
-        size_t generatedNodeNameId = (nameId == NODENAME_NOT_FOUND) ? getNodeNameCount() + ID_INCREMENT : nameId;
+        if (nameId > nodeLocations.size())
+            nodeLocations.resize(nameId, LOCATION_NOT_FOUND);
+
+        //a node added again moves to the new location
+        nodeLocations[nameId - 1] = id;
+        dispersionOutdated = true;
+    }
 
-        //consistent if location already exists
-        nodeLocationSet.insert(name, location);
-        locationIdSet.insert(location, generatedId);
-        nodeNameIdSet.insert(name, generatedNodeNameId);
+    /**
+    * Method: getLocationName
+    * ----------------------
+    * Returns: The location identified by id, which must be a valid id
+    */
+    const Location& getLocationName(const LocationId id) const
+    {
+        checkLocationId(id);
+        return locationTable.name(id);
     }
 
     /**
@@ -106,21 +207,17 @@ public:
     */
     Location getLocation(const Domain::NodeName& name) const
     {
-        Location location;
+        const LocationId id = getNameLocationId(name);
 
-        bool ret = nodeLocationSet.get_element<Location>(name, location, std::nothrow);
-
-        if (!ret)
-            location.clear();
-
-        return location;
+        return (id == LOCATION_NOT_FOUND) ? Location() : locationTable.name(id);
     }
 
     /**
     * Method: addDistance
     * ----------------------
     * Description: Add a new distance from one location to another
-    * The distance is not bidirectional
+    * The distance is not bidirectional, unless the storage is
+    * SymmetricStorage
     */
     void addDistance(
         const Distance distance,
@@ -134,13 +231,91 @@ public:
 
         const size_t locationsCount = getLocationsCount();
 
-        if (locationsDistances.size() < locationsCount)
+        if (distancesSize() < locationsCount)
+        {
+            resizeDistancesMatrix(locationsCount);
+        }
+        //else not needed
+
+        storeDistance(idFrom - 1, idTo - 1, distance);
+        dispersionOutdated = true;
+    }
+
+    /**
+    * Method: addDistances
+    * ----------------------
+    * Description: Add the distances of a dense matrix in one call.
+    * Row i and column j of the matrix hold the distance from
+    * location ids[i] to location ids[j].
+    * @param ids location ids of the matrix rows and columns
+    * @param matrix row-major matrix of ids.size() x ids.size() distances
+    */
+    void addDistances(const std::vector<LocationId>& ids, const Distance* matrix)
+    {
+        const size_t count = ids.size();
+        const size_t locationsCount = getLocationsCount();
+        bool identity = (count == locationsCount);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            checkLocationId(ids[i]);
+            identity = identity && (ids[i] == i + ID_INCREMENT);
+        }
+
+        if (distancesSize() < locationsCount)
         {
             resizeDistancesMatrix(locationsCount);
         }
         //else not needed
 
-        locationsDistances[idFrom - 1][idTo - 1] = distance;
+        for (size_t i = 0; i < count; i++)
+        {
+            const Distance* const row = matrix + i * count;
+
+            if (identity && storage == DenseStorage)
+            {
+                std::copy(row, row + count, locationsDistances.row(i));
+                touchRow(i);
+            }
+            else
+            {
+                for (size_t j = 0; j < count; j++)
+                    storeDistance(ids[i] - 1, ids[j] - 1, row[j]);
+            }
+        }
+        compactDistances();
+        dispersionOutdated = true;
+    }
+
+    /**
+    * Method: compactDistances
+    * ----------------------
+    * Description: Merges the distances added one at a time into sparse
+    * storage, so that looking them up is fast again. Call it after
+    * adding many distances with addDistance.
+    */
+    void compactDistances()
+    {
+        if (storage == SparseStorage)
+            sparseDistances.compact();
+    }
+
+    /**
+    * Method: distance
+    * ----------------------
+    * Description: May be called from several threads, as long as no
+    * distances are added meanwhile.
+    * Returns: The distance from one location to another
+    */
+    Distance distance(const LocationId idFrom, const LocationId idTo) const
+    {
+        checkLocations(idFrom, idTo);
+
+        const size_t size = distancesSize();
+
+        return (idFrom <= size && idTo <= size) ?
+               storedDistance(idFrom - 1, idTo - 1) :
+               0.0f;
     }
 
     /**
@@ -155,21 +330,101 @@ public:
         LocationId idFrom = getLocationId(nodeFrom);
         LocationId idTo = getLocationId(nodeTo);
 
-        //TODO: Check if locationsDistances is initialized
-        checkLocations(idFrom, idTo);
+        return distance(idFrom, idTo);
+    }
+
+    /**
+    * Method: distanceByCachedId
+    * ----------------------
+    * Description: Uses the location ids cached in the nodes instead of
+    * looking their names up; see resolveLocationIds. Nodes whose ids
+    * were never resolved throw InvalidLocation.
+    * Returns: The distance from one node to another
+    */
+    template <class T>
+    Distance distanceByCachedId(
+        const LocationAspect<T>* nodeFrom,
+        const LocationAspect<T>* nodeTo) const
+    {
+        return distance(nodeFrom->getLocationId(), nodeTo->getLocationId());
+    }
+
+    /**
+    * Method: distances
+    * ----------------------
+    * Description: Looks up many distances in one call. Large batches
+    * are split across processors.
+    * @param from location ids the distances start from
+    * @param to location ids the distances end at
+    * @param count amount of pairs
+    * @param result receives the distance from from[k] to to[k] at k
+    */
+    void distances(
+        const LocationId* from,
+        const LocationId* to,
+        const size_t count,
+        Distance* result) const
+    {
+        for (size_t k = 0; k < count; k++)
+            checkLocations(from[k], to[k]);
+
+        if (storage == SparseStorage)
+            sparseDistances.compact();
+
+        Domain::parallelFor(0, count, PairDistances(*this, from, to, result), PARALLEL_BATCH_DISTANCES);
+    }
+
+    /**
+    * Method: distances
+    * ----------------------
+    * Description: Fills a matrix with the distances among some locations
+    * @param ids location ids of the matrix rows and columns
+    * @param result receives at row i and column j the distance from
+    * location ids[i] to location ids[j]
+    */
+    void distances(const std::vector<LocationId>& ids, DistanceMatrix& result) const
+    {
+        const size_t count = ids.size();
+
+        for (size_t i = 0; i < count; i++)
+            checkLocations(ids[i], ids[i]);
 
-        return locationsDistances[idFrom - 1][idTo - 1];
+        if (storage == SparseStorage)
+            sparseDistances.compact();
+
+        result.clear();
+        result.resize(count);
+
+        if (count > 0)
+            Domain::parallelFor(0, count, SubmatrixRows(*this, ids, result), PARALLEL_DISPERSION_ROWS);
+    }
+
+    /**
+    * Method: getDistanceMatrix
+    * ----------------------
+    * Returns: The distances matrix, where row i and column j hold the
+    * distance from location id i + 1 to location id j + 1. It is empty
+    * unless the storage is DenseStorage.
+    */
+    const DistanceMatrix& getDistanceMatrix() const
+    {
+        return locationsDistances;
     }
 
     /**
     * Method: getDispersionVector
     * ----------------------
     * Returns: The dispersion vector of the locations
-    * holded by locationManager
+    * holded by locationManager. It is only recalculated after
+    * locations or distances change.
     */
     const DistanceVector& getDispersionVector()
     {
-        calculateDispersionVector();
+        if (dispersionOutdated)
+        {
+            calculateDispersionVector();
+            dispersionOutdated = false;
+        }
         return dispersionVector;
     }
 
@@ -181,16 +436,28 @@ public:
     */
     LocationId getLocationId(const Location& location) const
     {
-        LocationId id;
-        try
-        {
-            id = locationIdSet.get_element<LocationId>(location);
-        }
-        catch (const mili::BadElementName&)
-        {
-            id = LOCATION_NOT_FOUND;
-        }
-        return id;
+        return locationTable.find(location);
+    }
+
+    /**
+    * Method: getNodeName
+    * ----------------------
+    * Returns: The node name identified by id, which must be a valid id
+    */
+    const Domain::NodeName& getNodeName(const NodeNameId id) const
+    {
+        return nodeNameTable.name(id);
+    }
+
+    /**
+    * Method: getNodeNameLocationId
+    * ----------------------
+    * Returns: The location id of the node name identified by id, which
+    * must be a valid id
+    */
+    LocationId getNodeNameLocationId(const NodeNameId id) const
+    {
+        return nodeLocations[id - 1];
     }
 
     /**
@@ -201,16 +468,7 @@ public:
     */
     NodeNameId getNodeNameId(const Domain::NodeName& name) const
     {
-        NodeNameId id;
-        try
-        {
-            id = nodeNameIdSet.get_element<NodeNameId>(name);
-        }
-        catch (const mili::BadElementName&)
-        {
-            id = NODENAME_NOT_FOUND;
-        }
-        return id;
+        return nodeNameTable.find(name);
     }
 
     /**
@@ -232,8 +490,9 @@ public:
     */
     LocationId getNameLocationId(const Domain::NodeName& name) const
     {
-        Location location = getLocation(name);
-        return getLocationId(location);
+        const NodeNameId nameId = getNodeNameId(name);
+
+        return (nameId == NODENAME_NOT_FOUND) ? LOCATION_NOT_FOUND : nodeLocations[nameId - 1];
     }
 
     /**
@@ -243,7 +502,7 @@ public:
     */
     size_t getLocationsCount() const
     {
-        return locationIdSet.size();
+        return locationTable.size();
     }
 
     /**
@@ -253,14 +512,44 @@ public:
     */
     size_t getNodeNameCount() const
     {
-        return nodeNameIdSet.size();
+        return nodeNameTable.size();
     }
 
+    /**
+    * Method: isValid
+    * ----------------------
+    * Description: Only the distances changed since the last validation
+    * are checked again. Not safe to call concurrently.
+    * Returns: Whether every named node has a location and every
+    * location has a distance to every other location
+    */
     bool isValid() const
     {
         return validateNodes() && validateDistances();
     }
 
+    /**
+    * Method: validate
+    * ----------------------
+    * Description: Lists every reason that makes the manager invalid.
+    * Only the distances changed since the last validation are checked
+    * again. Not safe to call concurrently.
+    * @param report receives the violations
+    */
+    void validate(ValidationReport& report) const
+    {
+        report.nodesWithoutLocation.clear();
+
+        for (NodeNameId nameId = ID_INCREMENT; nameId <= nodeNameTable.size(); nameId++)
+        {
+            if (!validateNode(nameId))
+                report.nodesWithoutLocation.push_back(nameId);
+        }
+
+        revalidateDistances();
+        report.missingDistances = missingDistances;
+    }
+
     /**
     * Check if this locationManager object is empty.
     *
@@ -268,16 +557,281 @@ public:
     */
     bool isEmpty() const
     {
-        return nodeLocationSet.empty() && locationIdSet.empty() && locationsDistances.empty();
+        return nodeNameTable.empty() && locationTable.empty() && distancesSize() == 0;
     }
 
 private:
 
-    mili::VariantsSet nodeLocationSet;
-    mili::VariantsSet locationIdSet;
-    mili::VariantsSet nodeNameIdSet;
-    std::vector<std::vector<Distance> > locationsDistances;
+    NameTable locationTable;
+    NameTable nodeNameTable;
+    //location id of each node name, indexed by node name id - 1
+    std::vector<LocationId> nodeLocations;
+    DistanceStorage storage;
+    //only the distances of the chosen storage are used
+    DistanceMatrix locationsDistances;
+    SymmetricDistanceMatrix symmetricDistances;
+    SparseDistanceMatrix sparseDistances;
     DistanceVector dispersionVector;
+    bool dispersionOutdated;
+
+    //pairs without a distance found by the last validation
+    mutable std::vector<LocationPair> missingDistances;
+    //rows changed since the last validation
+    mutable std::vector<bool> touchedRows;
+    //locations count at the last validation, zero to check everything
+    mutable size_t validatedLocations;
+
+    // Matrices with fewer rows are summed by a single thread
+    static const size_t PARALLEL_DISPERSION_ROWS = 1024;
+
+    // Smaller batches of distances are looked up by a single thread
+    static const size_t PARALLEL_BATCH_DISTANCES = 65536;
+
+    /**
+    * Class: PairDistances
+    * ----------------------
+    * Description: Looks up the distances of a range of pairs
+    */
+    class PairDistances
+    {
+    public:
+        PairDistances(const LocationManager& manager, const LocationId* from, const LocationId* to, Distance* result) :
+            manager(manager),
+            from(from),
+            to(to),
+            result(result)
+        {}
+
+        void operator()(size_t begin, size_t end) const
+        {
+            const size_t size = manager.distancesSize();
+
+            if (manager.storage == DenseStorage)
+            {
+                const DistanceMatrix& matrix = manager.locationsDistances;
+                for (size_t k = begin; k < end; k++)
+                {
+                    result[k] = (from[k] <= size && to[k] <= size) ?
+                                matrix(from[k] - 1, to[k] - 1) :
+                                0.0f;
+                }
+            }
+            else
+            {
+                for (size_t k = begin; k < end; k++)
+                {
+                    result[k] = (from[k] <= size && to[k] <= size) ?
+                                manager.storedDistance(from[k] - 1, to[k] - 1) :
+                                0.0f;
+                }
+            }
+        }
+
+    private:
+        const LocationManager& manager;
+        const LocationId* const from;
+        const LocationId* const to;
+        Distance* const result;
+    };
+
+    /**
+    * Class: MissingCounts
+    * ----------------------
+    * Description: Counts the missing distances of a range of rows.
+    * Touched rows are counted whole, the others only from the
+    * locations added since the last validation.
+    */
+    class MissingCounts
+    {
+    public:
+        MissingCounts(const LocationManager& manager, size_t checked, std::vector<size_t>& counts) :
+            manager(manager),
+            checked(checked),
+            counts(counts)
+        {}
+
+        void operator()(size_t begin, size_t end) const
+        {
+            const size_t locationsCount = counts.size();
+
+            for (size_t i = begin; i < end; i++)
+            {
+                const size_t first = manager.touchedRows[i] ? 0 : checked;
+                counts[i] = manager.countMissing(i, first, locationsCount);
+            }
+        }
+
+    private:
+        const LocationManager& manager;
+        const size_t checked;
+        std::vector<size_t>& counts;
+    };
+
+    /**
+    * Class: SubmatrixRows
+    * ----------------------
+    * Description: Fills a range of rows of a matrix of distances among
+    * some locations
+    */
+    class SubmatrixRows
+    {
+    public:
+        SubmatrixRows(const LocationManager& manager, const std::vector<LocationId>& ids, DistanceMatrix& result) :
+            manager(manager),
+            ids(ids),
+            result(result)
+        {}
+
+        void operator()(size_t begin, size_t end) const
+        {
+            const size_t size = manager.distancesSize();
+            const size_t count = ids.size();
+
+            for (size_t i = begin; i < end; i++)
+            {
+                Distance* const row = result.row(i);
+                const size_t from = ids[i] - 1;
+
+                //locations without any distance keep a row of zeros
+                if (from < size && manager.storage == DenseStorage)
+                {
+                    const Distance* const distances = manager.locationsDistances.row(from);
+                    for (size_t j = 0; j < count; j++)
+                        row[j] = (ids[j] <= size) ? distances[ids[j] - 1] : 0.0f;
+                }
+                else if (from < size)
+                {
+                    for (size_t j = 0; j < count; j++)
+                        row[j] = (ids[j] <= size) ? manager.storedDistance(from, ids[j] - 1) : 0.0f;
+                }
+            }
+        }
+
+    private:
+        const LocationManager& manager;
+        const std::vector<LocationId>& ids;
+        DistanceMatrix& result;
+    };
+
+    /**
+    * Class: RowSums
+    * ----------------------
+    * Description: Stores the sum of each row of a range of rows
+    * Type Parameter Matrix: the distance storage class
+    */
+    template <class Matrix>
+    class RowSums
+    {
+    public:
+        RowSums(const Matrix& matrix, size_t columns, DistanceVector& sums) :
+            matrix(matrix),
+            columns(columns),
+            sums(sums)
+        {}
+
+        void operator()(size_t begin, size_t end) const
+        {
+            for (size_t i = begin; i < end; i++)
+                sums[i] = matrix.rowSum(i, columns);
+        }
+
+    private:
+        const Matrix& matrix;
+        const size_t columns;
+        DistanceVector& sums;
+    };
+
+    size_t distancesSize() const
+    {
+        switch (storage)
+        {
+            case SymmetricStorage:
+                return symmetricDistances.size();
+            case SparseStorage:
+                return sparseDistances.size();
+            default:
+                return locationsDistances.size();
+        }
+    }
+
+    //indexes start at zero
+    Distance storedDistance(const size_t from, const size_t to) const
+    {
+        switch (storage)
+        {
+            case SymmetricStorage:
+                return symmetricDistances.get(from, to);
+            case SparseStorage:
+                return sparseDistances.get(from, to);
+            default:
+                return locationsDistances(from, to);
+        }
+    }
+
+    //indexes start at zero
+    void storeDistance(const size_t from, const size_t to, const Distance distance)
+    {
+        touchRow(from);
+
+        switch (storage)
+        {
+            case SymmetricStorage:
+                symmetricDistances.set(from, to, distance);
+                touchRow(to);
+                break;
+            case SparseStorage:
+                sparseDistances.set(from, to, distance);
+                break;
+            default:
+                locationsDistances(from, to) = distance;
+        }
+    }
+
+    void touchRow(const size_t row)
+    {
+        //rows not validated yet are checked anyway
+        if (row < touchedRows.size())
+            touchedRows[row] = true;
+    }
+
+    //missing distances from location i to the locations in [begin, end)
+    size_t countMissing(const size_t i, const size_t begin, const size_t end) const
+    {
+        const size_t size = distancesSize();
+        size_t missing;
+
+        if (i < size)
+        {
+            const size_t stored = std::min(end, size);
+            missing = 0;
+
+            if (begin < stored)
+            {
+                switch (storage)
+                {
+                    case SymmetricStorage:
+                        missing += symmetricDistances.countMissing(i, begin, stored);
+                        break;
+                    case SparseStorage:
+                        missing += sparseDistances.countMissing(i, begin, stored);
+                        break;
+                    default:
+                        missing += locationsDistances.countMissing(i, begin, stored);
+                }
+            }
+
+            //locations without any distance have no column in the matrix
+            if (end > std::max(begin, size))
+                missing += end - std::max(begin, size);
+        }
+        else
+        {
+            //nor a row
+            missing = (begin <= i && i < end) ? end - begin - 1 : end - begin;
+        }
+
+        return missing;
+    }
 
     static void checkLocations(const LocationId idFrom, const LocationId idTo)
     {
@@ -287,18 +841,33 @@ private:
         }
     }
 
+    void checkLocationId(const LocationId id) const
+    {
+        if (id == LOCATION_NOT_FOUND || id > getLocationsCount())
+        {
+            throw InvalidLocation();
+        }
+    }
+
+    //check that a node != "" has a location
+    bool validateNode(const NodeNameId nameId) const
+    {
+        return mili::implies(!nodeNameTable.name(nameId).empty(),
+                             !locationTable.name(nodeLocations[nameId - 1]).empty());
+    }
+
     //check that every node != "" has a location
     bool validateNodes() const
     {
         bool valid = true;
 
-        mili::VariantsSet::const_iterator it = nodeLocationSet.begin();
+        NodeNameId nameId = ID_INCREMENT;
 
-        while (valid && it != nodeLocationSet.end())
+        while (valid && nameId <= nodeNameTable.size())
         {
-            valid = mili::implies(!it->first.empty(), !it->second.empty());
+            valid = validateNode(nameId);
 
-            it++;
+            nameId++;
         }
         return valid;
     }
@@ -306,22 +875,59 @@ private:
     //check thay every location has a distance to every location
     bool validateDistances() const
     {
-        bool valid = true;
+        revalidateDistances();
+        return missingDistances.empty();
+    }
 
+    /**
+    * Method: revalidateDistances
+    * ----------------------
+    * Description: Updates the missing distances, checking again only
+    * the rows touched and the columns added since the last validation
+    */
+    void revalidateDistances() const
+    {
         const size_t locationsCount = getLocationsCount();
+        const size_t checked = std::min(validatedLocations, locationsCount);
 
-        unsigned int i = 0;
-        while (valid && i < locationsCount)
+        touchedRows.resize(checked);
+        touchedRows.resize(locationsCount, true);
+
+        if (checked < locationsCount || std::find(touchedRows.begin(), touchedRows.end(), true) != touchedRows.end())
         {
-            unsigned int j = 0;
-            while (valid && j < locationsCount)
+            if (storage == SparseStorage)
+                sparseDistances.compact();
+
+            std::vector<size_t> counts(locationsCount, 0);
+            Domain::parallelFor(0, locationsCount, MissingCounts(*this, checked, counts), PARALLEL_DISPERSION_ROWS);
+
+            //the violations of untouched rows among old locations still hold
+            std::vector<LocationPair> missing;
+            for (size_t k = 0; k < missingDistances.size(); k++)
             {
-                valid = mili::implies(i != j, locationsDistances[i][j] != 0.0f);
-                j++;
+                if (!touchedRows[missingDistances[k].first - 1])
+                    missing.push_back(missingDistances[k]);
             }
-            i++;
+
+            const size_t size = distancesSize();
+            for (size_t i = 0; i < locationsCount; i++)
+            {
+                for (size_t j = touchedRows[i] ? 0 : checked; counts[i] > 0 && j < locationsCount; j++)
+                {
+                    if (i != j && (i >= size || j >= size || storedDistance(i, j) == 0.0f))
+                    {
+                        missing.push_back(LocationPair(i + ID_INCREMENT, j + ID_INCREMENT));
+                        counts[i]--;
+                    }
+                }
+            }
+
+            std::sort(missing.begin(), missing.end());
+            missingDistances.swap(missing);
         }
-        return valid;
+
+        validatedLocations = locationsCount;
+        touchedRows.assign(locationsCount, false);
     }
 
     /**
@@ -331,10 +937,20 @@ private:
     */
     void resizeDistancesMatrix(size_t locationsCount)
     {
-        locationsDistances.resize(locationsCount);
-        for (unsigned int i = 0; i < locationsCount; i++)
+        switch (storage)
         {
-            locationsDistances[i].resize(locationsCount, 0);
+            case SymmetricStorage:
+                symmetricDistances.resize(locationsCount);
+                break;
+            case SparseStorage:
+                //the new cells hold the default distance, which may fill
+                //distances that the last validation found missing
+                if (locationsCount > sparseDistances.size() && sparseDistances.getDefaultDistance() != 0.0f)
+                    validatedLocations = 0;
+                sparseDistances.resize(locationsCount);
+                break;
+            default:
+                locationsDistances.resize(locationsCount);
         }
     }
 
@@ -351,22 +967,32 @@ private:
         {
             dispersionVector.clear();
             dispersionVector.resize(locationsCount, 0);
-            Distance distancesSum = 0.0f;
 
-            for (unsigned int i = 0; i < locationsCount; i++)
-            {
-                Distance locationDistancesSum = 0.0f;
+            const size_t rows = std::min(locationsCount, distancesSize());
 
-                for (unsigned int j = 0; j < locationsCount; j++)
-                {
-                    locationDistancesSum += locationsDistances[i][j];
-                }
-                //the sum to all OTHER locations
-                dispersionVector[i] = locationDistancesSum;
-                //update the sum between all locations
-                distancesSum += locationDistancesSum;
+            //the sum to all OTHER locations
+            switch (storage)
+            {
+                case SymmetricStorage:
+                    Domain::parallelFor(0, rows,
+                                        RowSums<SymmetricDistanceMatrix>(symmetricDistances, rows, dispersionVector),
+                                        PARALLEL_DISPERSION_ROWS);
+                    break;
+                case SparseStorage:
+                    sparseDistances.compact();
+                    Domain::parallelFor(0, rows,
+                                        RowSums<SparseDistanceMatrix>(sparseDistances, rows, dispersionVector),
+                                        PARALLEL_DISPERSION_ROWS);
+                    break;
+                default:
+                    Domain::parallelFor(0, rows,
+                                        RowSums<DistanceMatrix>(locationsDistances, rows, dispersionVector),
+                                        PARALLEL_DISPERSION_ROWS);
             }
 
+            //the sum between all locations
+            const Distance distancesSum = pairwiseSum(&dispersionVector[0], locationsCount);
+
             for (unsigned int i = 0; i < locationsCount; i++)
             {
                 dispersionVector[i] = 1.0f - dispersionVector[i] / distancesSum;
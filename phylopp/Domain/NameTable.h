@@ -0,0 +1,189 @@
+/*
+    Copyright (C) 2011 Emmanuel Teisaire, Nicolás Bombau, Carlos Castro, Damián Domé, FuDePAN
+
+    This file is part of the Phyloloc project.
+
+    Phyloloc is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Phyloloc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef NAME_TABLE_H
+#define NAME_TABLE_H
+
+#include <string>
+#include <vector>
+#include <cstring>
+
+namespace Locations
+{
+
+static const unsigned int NAME_NOT_FOUND = 0;
+
+/**
+* Class: NameTable
+* ----------------
+* Description: Interns strings into consecutive ids starting at one.
+* Lookups hash the key once (FNV-1a) and probe an open-addressing
+* table of ids, so a miss costs no allocation and no exception.
+* Id zero (NAME_NOT_FOUND) is never assigned.
+*/
+class NameTable
+{
+public:
+
+    typedef unsigned int Id;
+
+    NameTable() :
+        mask(0)
+    {}
+
+    /**
+    * Method: find
+    * ------------
+    * Returns: The id of the name or NAME_NOT_FOUND
+    */
+    Id find(const std::string& name) const
+    {
+        return find(name.data(), name.size());
+    }
+
+    /**
+    * Method: find
+    * ------------
+    * Returns: The id of the first length characters of name or NAME_NOT_FOUND
+    */
+    Id find(const char* name, size_t length) const
+    {
+        Id id = NAME_NOT_FOUND;
+
+        if (!slots.empty())
+        {
+            const unsigned int hashValue = hash(name, length);
+            size_t slot = hashValue & mask;
+            bool found = false;
+
+            while (!found && slots[slot] != NAME_NOT_FOUND)
+            {
+                const Id candidate = slots[slot];
+                const std::string& candidateName = names[candidate - 1];
+
+                found = hashes[candidate - 1] == hashValue
+                        && candidateName.size() == length
+                        && std::memcmp(candidateName.data(), name, length) == 0;
+
+                if (found)
+                    id = candidate;
+                else
+                    slot = (slot + 1) & mask;
+            }
+        }
+
+        return id;
+    }
+
+    /**
+    * Method: insert
+    * --------------
+    * Description: Interns a name.
+    * Returns: The id of the name, which is new if the name was not
+    * already in the table
+    */
+    Id insert(const std::string& name)
+    {
+        Id id = find(name);
+
+        if (id == NAME_NOT_FOUND)
+        {
+            // keep the load factor at or below one half
+            if (2 * (names.size() + 1) > slots.size())
+                rehash(slots.empty() ? INITIAL_CAPACITY : 2 * slots.size());
+
+            names.push_back(name);
+            hashes.push_back(hash(name.data(), name.size()));
+            id = Id(names.size());
+            place(id);
+        }
+
+        return id;
+    }
+
+    /**
+    * Method: name
+    * ------------
+    * Returns: The name interned as id, which must be a valid id
+    */
+    const std::string& name(Id id) const
+    {
+        return names[id - 1];
+    }
+
+    size_t size() const
+    {
+        return names.size();
+    }
+
+    bool empty() const
+    {
+        return names.empty();
+    }
+
+    void clear()
+    {
+        names.clear();
+        hashes.clear();
+        slots.clear();
+        mask = 0;
+    }
+
+private:
+
+    // Must be a power of two
+    static const size_t INITIAL_CAPACITY = 16;
+
+    std::vector<std::string> names;
+    std::vector<unsigned int> hashes;
+    std::vector<Id> slots;
+    size_t mask;
+
+    static unsigned int hash(const char* name, size_t length)
+    {
+        unsigned int value = 2166136261u;
+        for (size_t i = 0; i < length; i++)
+        {
+            value ^= static_cast<unsigned char>(name[i]);
+            value *= 16777619u;
+        }
+        return value;
+    }
+
+    void place(Id id)
+    {
+        size_t slot = hashes[id - 1] & mask;
+        while (slots[slot] != NAME_NOT_FOUND)
+            slot = (slot + 1) & mask;
+        slots[slot] = id;
+    }
+
+    void rehash(size_t capacity)
+    {
+        slots.assign(capacity, NAME_NOT_FOUND);
+        mask = capacity - 1;
+        for (size_t i = 0; i < names.size(); i++)
+            place(Id(i + 1));
+    }
+};
+
+} // End of Namespace Locations
+
+#endif
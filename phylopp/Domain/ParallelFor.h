@@ -0,0 +1,128 @@
+/*
+    Copyright (C) 2011 Emmanuel Teisaire, Nicolás Bombau, Carlos Castro, Damián Domé, FuDePAN
+
+    This file is part of the Phyloloc project.
+
+    Phyloloc is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Phyloloc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef PARALLEL_FOR_H
+#define PARALLEL_FOR_H
+
+#include <vector>
+#include <algorithm>
+#include <pthread.h>
+#include <unistd.h>
+
+namespace Domain
+{
+
+/**
+* Class: ParallelForTask
+* ----------------------
+* Description: A range of a parallelFor handed to one thread.
+* Type Parameter Body: functor called as body(begin, end)
+*/
+template <class Body>
+struct ParallelForTask
+{
+    const Body* body;
+    size_t begin;
+    size_t end;
+
+    static void* run(void* task)
+    {
+        const ParallelForTask* const self = static_cast<ParallelForTask*>(task);
+        (*self->body)(self->begin, self->end);
+        return NULL;
+    }
+};
+
+/**
+* Method: hardwareThreads
+* -----------------------
+* Returns: The number of online processors, at least one
+*/
+inline size_t hardwareThreads()
+{
+    const long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    return processors > 1 ? size_t(processors) : 1;
+}
+
+/**
+* Method: parallelFor
+* -------------------
+* Description: Splits [begin, end) in contiguous ranges of at least
+* minRange elements and calls body(rangeBegin, rangeEnd) for each of them,
+* using at most maxThreads threads. The calling thread runs the last
+* range, and ranges whose thread can not be started run on the calling
+* thread too. body must be safe to call concurrently on disjoint ranges.
+* Type Parameter Body: functor called as body(begin, end)
+*/
+template <class Body>
+void parallelFor(size_t begin, size_t end, const Body& body, size_t minRange, size_t maxThreads)
+{
+    const size_t count = end - begin;
+    const size_t ranges = std::max<size_t>(1, count / std::max<size_t>(1, minRange));
+    const size_t threads = std::min(maxThreads, ranges);
+
+    if (threads <= 1)
+    {
+        body(begin, end);
+    }
+    else
+    {
+        std::vector<ParallelForTask<Body> > tasks(threads);
+        std::vector<pthread_t> handles(threads);
+        std::vector<bool> started(threads, false);
+
+        for (size_t i = 0; i < threads; i++)
+        {
+            tasks[i].body = &body;
+            tasks[i].begin = begin + count * i / threads;
+            tasks[i].end = begin + count * (i + 1) / threads;
+        }
+
+        for (size_t i = 0; i + 1 < threads; i++)
+            started[i] = pthread_create(&handles[i], NULL, &ParallelForTask<Body>::run, &tasks[i]) == 0;
+
+        for (size_t i = 0; i < threads; i++)
+        {
+            if (i + 1 == threads || !started[i])
+                ParallelForTask<Body>::run(&tasks[i]);
+        }
+
+        for (size_t i = 0; i + 1 < threads; i++)
+        {
+            if (started[i])
+                pthread_join(handles[i], NULL);
+        }
+    }
+}
+
+/**
+* Method: parallelFor
+* -------------------
+* Description: Same as above, with one thread per processor.
+*/
+template <class Body>
+void parallelFor(size_t begin, size_t end, const Body& body, size_t minRange)
+{
+    parallelFor(begin, end, body, minRange, hardwareThreads());
+}
+
+} // End of Namespace Domain
+
+#endif
@@ -0,0 +1,73 @@
+/*
+    Copyright (C) 2011 Emmanuel Teisaire, Nicolás Bombau, Carlos Castro, Damián Domé, FuDePAN
+
+    This file is part of the Phyloloc project.
+
+    Phyloloc is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Phyloloc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef SUPPORT_ASPECT_H
+#define SUPPORT_ASPECT_H
+
+namespace Domain
+{
+
+typedef float Support;
+
+// Support of the nodes that have not been annotated
+static const Support NO_SUPPORT = -1.0f;
+
+/**
+* Class: SupportHolder
+* --------------------
+* Description: Support value of a node, such as its bootstrap or
+* posterior support. NewickWriter writes it as the label of unnamed
+* internal nodes of any node class derived from this one.
+*/
+class SupportHolder
+{
+public:
+
+    SupportHolder() :
+        support(NO_SUPPORT)
+    {}
+
+    void setSupport(Support support)
+    {
+        this->support = support;
+    }
+
+    Support getSupport() const
+    {
+        return support;
+    }
+
+    bool hasSupport() const
+    {
+        return support != NO_SUPPORT;
+    }
+
+private:
+    Support support;
+};
+
+template <class T>
+class SupportAspect : public T, public SupportHolder
+{
+};
+
+}
+
+#endif
@@ -0,0 +1,76 @@
+/*
+    Copyright (C) 2011 Emmanuel Teisaire, Nicolás Bombau, Carlos Castro, Damián Domé, FuDePAN
+
+    This file is part of the Phyloloc project.
+
+    Phyloloc is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Phyloloc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef LOCATION_GENERATOR_H
+#define LOCATION_GENERATOR_H
+
+#include <string>
+#include "phylopp/Domain/LocationManager.h"
+#include "phylopp/Generator/RandomGenerator.h"
+#include "phylopp/Generator/Topology.h"
+
+namespace Generator
+{
+
+/**
+* Class: LocationGenerator
+* ------------------------
+* Description: Generates the locations of the leaves made by
+* TreeGenerator, and the distances between them. Locations are random
+* points of a square, and their distances are euclidean, so the
+* distances are symmetric and obey the triangle inequality.
+*/
+class LocationGenerator
+{
+public:
+
+    explicit LocationGenerator(Seed seed = DEFAULT_SEED);
+
+    /**
+    * Method: generate
+    * ----------------
+    * Description: Adds the locations and distances to the manager. The
+    * first leaves go one to each location, so every location is used,
+    * and the rest go to random locations.
+    * @param leaves amount of leaves, which must not be less than locations
+    * @param locations amount of locations, which must not be 0
+    */
+    void generate(size_t leaves, size_t locations, Locations::LocationManager& locationManager);
+
+    /**
+    * Method: saveFiles
+    * -----------------
+    * Description: Generates locations and distances, and saves them in the
+    * formats read by LocationsParser and DistancesParser
+    */
+    void saveFiles(const std::string& locationsFname, const std::string& distancesFname,
+                   size_t leaves, size_t locations);
+
+private:
+
+    //side of the square in which locations are placed
+    static const unsigned int AREA_SIDE = 1000;
+
+    RandomGenerator random;
+};
+
+} // End of Namespace Generator
+
+#endif
@@ -0,0 +1,102 @@
+/*
+    Copyright (C) 2011 Emmanuel Teisaire, Nicolás Bombau, Carlos Castro, Damián Domé, FuDePAN
+
+    This file is part of the Phyloloc project.
+
+    Phyloloc is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Phyloloc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef RANDOM_GENERATOR_H
+#define RANDOM_GENERATOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <math.h>
+
+namespace Generator
+{
+
+typedef uint64_t Seed;
+
+static const Seed DEFAULT_SEED = 1;
+
+/**
+* Class: RandomGenerator
+* ----------------------
+* Description: SplitMix64 pseudo random number generator. Unlike rand(),
+* it yields the same sequence for a given seed on every platform, so
+* generated datasets can be reproduced anywhere.
+*/
+class RandomGenerator
+{
+public:
+
+    explicit RandomGenerator(Seed seed = DEFAULT_SEED) :
+        state(seed)
+    {}
+
+    /**
+    * Method: next
+    * ------------
+    * Returns: The next 64 random bits
+    */
+    uint64_t next()
+    {
+        state += 0x9E3779B97F4A7C15ULL;
+        uint64_t z = state;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    /**
+    * Method: nextIndex
+    * -----------------
+    * Returns: A value in [0, bound), which must not be 0
+    */
+    size_t nextIndex(size_t bound)
+    {
+        return static_cast<size_t>(next() % bound);
+    }
+
+    /**
+    * Method: nextUniform
+    * -------------------
+    * Returns: A value in [0, 1)
+    */
+    double nextUniform()
+    {
+        //the 53 high bits fill the mantissa of a double
+        return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    /**
+    * Method: nextExponential
+    * -----------------------
+    * Returns: An exponentially distributed value of the given rate
+    */
+    double nextExponential(double rate)
+    {
+        return -log(1.0 - nextUniform()) / rate;
+    }
+
+private:
+
+    uint64_t state;
+};
+
+} // End of Namespace Generator
+
+#endif
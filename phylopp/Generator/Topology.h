@@ -0,0 +1,157 @@
+/*
+    Copyright (C) 2011 Emmanuel Teisaire, Nicolás Bombau, Carlos Castro, Damián Domé, FuDePAN
+
+    This file is part of the Phyloloc project.
+
+    Phyloloc is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Phyloloc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include <string>
+#include <vector>
+#include <mili/mili.h>
+#include "phylopp/Domain/INode.h"
+#include "phylopp/Generator/RandomGenerator.h"
+
+namespace Generator
+{
+
+class GeneratorExceptionHierarchy {};
+
+typedef mili::GenericException<GeneratorExceptionHierarchy> GeneratorException;
+
+/**
+* InvalidGeneratorParameters
+* --------------------
+* Description: Exception used when a dataset can not be generated with
+* the requested sizes.
+*/
+DEFINE_SPECIFIC_EXCEPTION_TEXT(InvalidGeneratorParameters,
+                               GeneratorExceptionHierarchy,
+                               "The generator parameters are not valid");
+
+/**
+* Enum: TreeModel
+* ---------------
+* Description: YuleModel grows the tree by splitting random leaves at
+* exponential waiting times. CoalescentModel merges random pairs of
+* lineages backwards in time, so the tree is ultrametric.
+* CaterpillarModel and BalancedModel build the deepest and the shallowest
+* binary tree, with unit branch lengths.
+*/
+enum TreeModel
+{
+    YuleModel,
+    CoalescentModel,
+    CaterpillarModel,
+    BalancedModel
+};
+
+typedef size_t NodeIndex;
+
+static const NodeIndex NO_NODE = static_cast<NodeIndex>(-1);
+
+/**
+* Method: leafName
+* ----------------
+* Returns: The name given to a generated leaf; leaves count from 0
+*/
+std::string leafName(size_t leaf);
+
+/**
+* Method: locationName
+* --------------------
+* Returns: The name given to a generated location; locations count from 0
+*/
+std::string locationName(size_t location);
+
+/**
+* Class: Topology
+* ---------------
+* Description: Rooted binary tree stored in arrays, on which the
+* generator runs its models and SPR moves before the result is copied
+* into an ITree.
+*/
+class Topology
+{
+public:
+
+    Topology();
+
+    /**
+    * Method: generate
+    * ----------------
+    * Description: Replaces the topology with a random tree of the given
+    * model and amount of leaves
+    */
+    void generate(TreeModel model, size_t leaves, RandomGenerator& random);
+
+    /**
+    * Method: sprMove
+    * ---------------
+    * Description: Prunes a random subtree and regrafts it on a random
+    * branch outside of it, which always changes the topology
+    * Returns: false when the tree is too small to be changed
+    */
+    bool sprMove(RandomGenerator& random);
+
+    size_t getNodeCount() const;
+    NodeIndex getRoot() const;
+    NodeIndex getLeft(NodeIndex node) const;
+    NodeIndex getRight(NodeIndex node) const;
+    NodeIndex getParent(NodeIndex node) const;
+    bool isLeaf(NodeIndex node) const;
+
+    /**
+    * Method: getLeaf
+    * ---------------
+    * Returns: The number of a leaf node, to be named with leafName
+    */
+    size_t getLeaf(NodeIndex node) const;
+
+    Domain::BranchLength getBranchLength(NodeIndex node) const;
+
+private:
+
+    struct TopologyNode
+    {
+        NodeIndex parent;
+        NodeIndex left;
+        NodeIndex right;
+        size_t leaf;
+        Domain::BranchLength length;
+    };
+
+    std::vector<TopologyNode> nodes;
+    NodeIndex root;
+
+    void generateYule(size_t leaves, RandomGenerator& random);
+    void generateCoalescent(size_t leaves, RandomGenerator& random);
+    void generateCaterpillar(size_t leaves);
+    void generateBalanced(NodeIndex parent, size_t first, size_t count);
+
+    NodeIndex addNode(size_t leaf, Domain::BranchLength length);
+    void attach(NodeIndex parent, NodeIndex child);
+    void replaceChild(NodeIndex parent, NodeIndex child, NodeIndex replacement);
+    NodeIndex getSibling(NodeIndex node) const;
+    void collectRegraftTargets(NodeIndex pruned, std::vector<NodeIndex>& targets) const;
+    void regraft(NodeIndex pruned, NodeIndex target);
+};
+
+} // End of Namespace Generator
+
+#endif
@@ -0,0 +1,178 @@
+/*
+    Copyright (C) 2011 Emmanuel Teisaire, Nicolás Bombau, Carlos Castro, Damián Domé, FuDePAN
+
+    This file is part of the Phyloloc project.
+
+    Phyloloc is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Phyloloc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef TREE_GENERATOR_H
+#define TREE_GENERATOR_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include "phylopp/Domain/ITree.h"
+#include "phylopp/Domain/ITreeCollection.h"
+#include "phylopp/Domain/LocationAspect.h"
+#include "phylopp/DataSource/NewickWriter.h"
+#include "phylopp/Generator/RandomGenerator.h"
+#include "phylopp/Generator/Topology.h"
+
+namespace Generator
+{
+
+/**
+* Class: TreeGenerator
+* --------------------
+* Description: Generates random phylogenetic trees for scale testing.
+* The same seed always gives the same trees. When a location manager is
+* given, the leaves of location aware nodes get the location ids of their
+* names, as NewickReader does.
+* Type Parameter T: T is the node type.
+*/
+template <class T>
+class TreeGenerator
+{
+public:
+
+    explicit TreeGenerator(Seed seed = DEFAULT_SEED) :
+        random(seed),
+        locationManager(NULL)
+    {}
+
+    /**
+     * Constructor
+     *
+     * @param locationManager Manager the location ids of the leaves are
+     * resolved against. It must outlive the generator.
+     * @param seed seed of the random trees
+     */
+    explicit TreeGenerator(const Locations::LocationManager& locationManager, Seed seed = DEFAULT_SEED) :
+        random(seed),
+        locationManager(&locationManager)
+    {}
+
+    /**
+    * Method: generateTree
+    * --------------------
+    * Description: Fills an empty tree with a random tree of the given
+    * model, perturbed by sprMoves random SPR moves
+    */
+    void generateTree(Domain::ITree<T>* tree, TreeModel model, size_t leaves, size_t sprMoves = 0)
+    {
+        Topology topology;
+        topology.generate(model, leaves, random);
+        perturb(topology, sprMoves);
+        buildTree(topology, tree);
+    }
+
+    /**
+    * Method: generateTrees
+    * ---------------------
+    * Description: Adds replicates to the collection. They all come from
+    * one tree of the given model, each perturbed by its own sprMoves
+    * random SPR moves, so that they share part of their clusters as
+    * replicates of a real analysis do.
+    */
+    void generateTrees(Domain::ITreeCollection<T>& trees, TreeModel model, size_t leaves,
+                       size_t replicates, size_t sprMoves = 0)
+    {
+        Topology base;
+        base.generate(model, leaves, random);
+
+        for (size_t i = 0; i < replicates; i++)
+        {
+            Topology replicate(base);
+            perturb(replicate, sprMoves);
+            buildTree(replicate, trees.addTree());
+        }
+    }
+
+    /**
+    * Method: saveTrees
+    * -----------------
+    * Description: Generates replicates as generateTrees does and saves
+    * them in newick format
+    */
+    void saveTrees(const std::string& fname, TreeModel model, size_t leaves,
+                   size_t replicates, size_t sprMoves = 0)
+    {
+        Domain::ITreeCollection<T> trees;
+        generateTrees(trees, model, leaves, replicates, sprMoves);
+
+        NewickWriter<T> writer;
+        writer.saveNewickFile(fname, trees);
+    }
+
+private:
+
+    RandomGenerator random;
+    const Locations::LocationManager* locationManager;
+
+    void perturb(Topology& topology, size_t sprMoves)
+    {
+        for (size_t i = 0; i < sprMoves; i++)
+            topology.sprMove(random);
+    }
+
+    /**
+    * Method: buildTree
+    * -----------------
+    * Description: Copies a topology into a tree, without recursion
+    */
+    void buildTree(const Topology& topology, Domain::ITree<T>* tree) const
+    {
+        typedef std::pair<NodeIndex, T*> PendingNode;
+        std::vector<PendingNode> pending(1, PendingNode(topology.getRoot(), tree->getRoot()));
+
+        while (!pending.empty())
+        {
+            const PendingNode current = pending.back();
+            pending.pop_back();
+
+            T* const node = current.second;
+            node->setBranchLength(topology.getBranchLength(current.first));
+
+            if (topology.isLeaf(current.first))
+            {
+                node->setName(leafName(topology.getLeaf(current.first)));
+                resolveLocation(node);
+            }
+            else
+            {
+                T* const left = node->template addChild<T>();
+                T* const right = node->template addChild<T>();
+                pending.push_back(PendingNode(topology.getLeft(current.first), left));
+                pending.push_back(PendingNode(topology.getRight(current.first), right));
+            }
+        }
+    }
+
+    // Nodes without a LocationAspect have no location id to resolve
+    void resolveLocation(void* /*node*/) const
+    {}
+
+    template <class Base>
+    void resolveLocation(Locations::LocationAspect<Base>* node) const
+    {
+        if (locationManager != NULL)
+            node->setLocationId(locationManager->getNameLocationId(node->getName()));
+    }
+};
+
+} // End of Namespace Generator
+
+#endif
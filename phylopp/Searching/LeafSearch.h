@@ -0,0 +1,90 @@
+/*
+    Copyright (C) 2011 Emmanuel Teisaire, Nicolás Bombau, Carlos Castro, Damián Domé, FuDePAN
+
+    This file is part of the Phyloloc project.
+
+    Phyloloc is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Phyloloc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef LEAF_SEARCH_H
+#define LEAF_SEARCH_H
+
+#include <vector>
+#include "phylopp/Domain/ITree.h"
+#include "phylopp/Domain/LocationManager.h"
+#include "phylopp/Consensor/bitset.h"
+#include "phylopp/Searching/PatternSet.h"
+
+namespace Searching
+{
+
+/**
+* Method: searchLeaves
+* --------------------
+* Description: Matches the names and locations of the leaves of a tree
+* against every pattern of the set in a single pass over the leaves.
+* Each location is matched once, however many leaves share it.
+* @param results receives one bitset per pattern, with bit i set when
+* the i-th leaf, counting from left to right, matches the pattern
+* Type Parameter T: T is the node type
+*/
+template <class T>
+void searchLeaves(
+    const Domain::ITree<T>* tree,
+    const Locations::LocationManager& locationManager,
+    const PatternSet& patterns,
+    std::vector<Consensus::bitset>& results)
+{
+    std::vector<const T*> leaves;
+    tree->getLeaves(leaves);
+
+    const size_t patternsCount = patterns.size();
+    results.assign(patternsCount, Consensus::bitset(leaves.size()));
+
+    //matches of each location, indexed by location id - 1
+    std::vector<std::vector<bool> > locationMatches(locationManager.getLocationsCount());
+    std::vector<bool> matched(patternsCount);
+
+    for (size_t i = 0; i < leaves.size(); i++)
+    {
+        const Domain::NodeName name = leaves[i]->getName();
+        matched.assign(patternsCount, false);
+        patterns.match(name, NodeNameTarget, matched);
+
+        const Locations::LocationId id = locationManager.getNameLocationId(name);
+        if (id != Locations::LOCATION_NOT_FOUND)
+        {
+            std::vector<bool>& location = locationMatches[id - 1];
+            if (location.empty())
+            {
+                location.assign(patternsCount, false);
+                patterns.match(locationManager.getLocationName(id), LocationTarget, location);
+            }
+
+            for (size_t k = 0; k < patternsCount; k++)
+                matched[k] = matched[k] || location[k];
+        }
+
+        for (size_t k = 0; k < patternsCount; k++)
+        {
+            if (matched[k])
+                results[k].set(i);
+        }
+    }
+}
+
+} // End of Namespace Searching
+
+#endif
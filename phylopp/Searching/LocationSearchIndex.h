@@ -0,0 +1,227 @@
+/*
+    Copyright (C) 2011 Emmanuel Teisaire, Nicolás Bombau, Carlos Castro, Damián Domé, FuDePAN
+
+    This file is part of the Phyloloc project.
+
+    Phyloloc is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Phyloloc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef LOCATION_SEARCH_INDEX_H
+#define LOCATION_SEARCH_INDEX_H
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include "phylopp/Domain/LocationManager.h"
+
+namespace Searching
+{
+
+enum LocationMatch
+{
+    SubstringMatch,
+    PrefixMatch
+};
+
+/**
+* Class: LocationSearchIndex
+* --------------------------
+* Description: Index over the location names of a LocationManager,
+* built once and shared by many searches. Substring queries use a
+* suffix array of the names and prefix queries a sorted list of them,
+* so both cost a binary search plus the size of the result. The index
+* must be built again after locations are added to the manager.
+*/
+class LocationSearchIndex
+{
+public:
+
+    explicit LocationSearchIndex(const Locations::LocationManager& locationManager) :
+        locationManager(locationManager)
+    {
+        const size_t locationsCount = locationManager.getLocationsCount();
+
+        //location of each character of text
+        std::vector<Locations::LocationId> textLocations;
+
+        //names separated by '\0', so that suffixes end with their name
+        for (Locations::LocationId id = 1; id <= locationsCount; id++)
+        {
+            const Locations::Location& name = locationManager.getLocationName(id);
+
+            if (!name.empty())
+            {
+                sortedLocations.push_back(id);
+                for (size_t i = 0; i < name.size(); i++)
+                    suffixes.push_back(text.size() + i);
+
+                text.insert(text.end(), name.begin(), name.end());
+                text.push_back('\0');
+                textLocations.resize(text.size(), id);
+            }
+        }
+
+        std::sort(suffixes.begin(), suffixes.end(), SuffixLess(text));
+
+        suffixLocations.resize(suffixes.size());
+        for (size_t k = 0; k < suffixes.size(); k++)
+            suffixLocations[k] = textLocations[suffixes[k]];
+
+        std::sort(sortedLocations.begin(), sortedLocations.end(), LocationLess(locationManager));
+
+        buildNodeNames();
+    }
+
+    /**
+    * Method: find
+    * ------------
+    * Description: Finds the non empty locations that contain the query,
+    * or start with it.
+    * @param ids receives the matching location ids, sorted
+    */
+    void find(const std::string& query, LocationMatch match, std::vector<Locations::LocationId>& ids) const
+    {
+        ids.clear();
+
+        if (match == PrefixMatch)
+        {
+            std::vector<Locations::LocationId>::const_iterator it =
+                std::lower_bound(sortedLocations.begin(), sortedLocations.end(), query, LocationLess(locationManager));
+
+            for (; it != sortedLocations.end() && startsWith(locationManager.getLocationName(*it), query); ++it)
+                ids.push_back(*it);
+        }
+        else
+        {
+            const std::vector<size_t>::const_iterator first =
+                std::lower_bound(suffixes.begin(), suffixes.end(), query, SuffixLess(text));
+
+            for (size_t k = first - suffixes.begin(); k < suffixes.size() && startsWith(&text[suffixes[k]], query); k++)
+                ids.push_back(suffixLocations[k]);
+
+            std::sort(ids.begin(), ids.end());
+            ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+        }
+    }
+
+    /**
+    * Method: getNodeNames
+    * --------------------
+    * Description: Collects the node names of some locations
+    * @param ids location ids
+    * @param names receives the ids of the node names at those locations
+    */
+    void getNodeNames(const std::vector<Locations::LocationId>& ids, std::vector<Locations::NodeNameId>& names) const
+    {
+        names.clear();
+        for (size_t k = 0; k < ids.size(); k++)
+            names.insert(names.end(), nodeNames.begin() + nodeOffsets[ids[k] - 1], nodeNames.begin() + nodeOffsets[ids[k]]);
+    }
+
+    const Locations::LocationManager& getLocationManager() const
+    {
+        return locationManager;
+    }
+
+private:
+
+    const Locations::LocationManager& locationManager;
+    //every location name followed by '\0'
+    std::vector<char> text;
+    //positions in text of every suffix, sorted
+    std::vector<size_t> suffixes;
+    //location of every sorted suffix
+    std::vector<Locations::LocationId> suffixLocations;
+    //non empty locations sorted by name
+    std::vector<Locations::LocationId> sortedLocations;
+    //node names of each location id, nodeNames[nodeOffsets[id - 1], nodeOffsets[id])
+    std::vector<size_t> nodeOffsets;
+    std::vector<Locations::NodeNameId> nodeNames;
+
+    class SuffixLess
+    {
+    public:
+        SuffixLess(const std::vector<char>& text) :
+            text(text)
+        {}
+
+        bool operator()(size_t a, size_t b) const
+        {
+            return std::strcmp(&text[a], &text[b]) < 0;
+        }
+
+        bool operator()(size_t suffix, const std::string& query) const
+        {
+            return std::strcmp(&text[suffix], query.c_str()) < 0;
+        }
+
+    private:
+        const std::vector<char>& text;
+    };
+
+    class LocationLess
+    {
+    public:
+        LocationLess(const Locations::LocationManager& locationManager) :
+            locationManager(locationManager)
+        {}
+
+        bool operator()(Locations::LocationId a, Locations::LocationId b) const
+        {
+            return locationManager.getLocationName(a) < locationManager.getLocationName(b);
+        }
+
+        bool operator()(Locations::LocationId id, const std::string& query) const
+        {
+            return locationManager.getLocationName(id) < query;
+        }
+
+    private:
+        const Locations::LocationManager& locationManager;
+    };
+
+    static bool startsWith(const std::string& name, const std::string& query)
+    {
+        return name.compare(0, query.size(), query) == 0;
+    }
+
+    static bool startsWith(const char* name, const std::string& query)
+    {
+        return std::strncmp(name, query.c_str(), query.size()) == 0;
+    }
+
+    void buildNodeNames()
+    {
+        const size_t locationsCount = locationManager.getLocationsCount();
+        const size_t namesCount = locationManager.getNodeNameCount();
+
+        nodeOffsets.assign(locationsCount + 1, 0);
+        for (Locations::NodeNameId name = 1; name <= namesCount; name++)
+            nodeOffsets[locationManager.getNodeNameLocationId(name)]++;
+
+        for (size_t i = 0; i < locationsCount; i++)
+            nodeOffsets[i + 1] += nodeOffsets[i];
+
+        std::vector<size_t> next(nodeOffsets.begin(), nodeOffsets.end() - 1);
+        nodeNames.resize(namesCount);
+        for (Locations::NodeNameId name = 1; name <= namesCount; name++)
+            nodeNames[next[locationManager.getNodeNameLocationId(name) - 1]++] = name;
+    }
+};
+
+} // End of Namespace Searching
+
+#endif
@@ -0,0 +1,147 @@
+/*
+    Copyright (C) 2011 Emmanuel Teisaire, Nicolás Bombau, Carlos Castro, Damián Domé, FuDePAN
+
+    This file is part of the Phyloloc project.
+
+    Phyloloc is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Phyloloc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef PATTERN_SET_H
+#define PATTERN_SET_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <regex.h>
+#include <mili/mili.h>
+
+namespace Searching
+{
+
+class SearchExceptionHierarchy {};
+
+typedef mili::GenericException<SearchExceptionHierarchy> SearchException;
+
+/**
+* InvalidPattern
+* --------------------
+* Description: Exception used when a glob or regular expression can not
+* be compiled.
+*/
+DEFINE_SPECIFIC_EXCEPTION_TEXT(InvalidPattern,
+                               SearchExceptionHierarchy,
+                               "The search pattern is not valid");
+
+/**
+* Enum: PatternKind
+* -----------------
+* Description: LiteralPattern matches texts that contain it.
+* GlobPattern matches whole texts, with '*', '?' and '[...]' wildcards.
+* RegexPattern is a POSIX extended regular expression that matches texts
+* containing a match; use '^' and '$' to anchor it.
+*/
+enum PatternKind
+{
+    LiteralPattern,
+    GlobPattern,
+    RegexPattern
+};
+
+/**
+* Enum: PatternTarget
+* -------------------
+* Description: What a pattern is matched against
+*/
+enum PatternTarget
+{
+    NodeNameTarget = 1,
+    LocationTarget = 2,
+    AnyTarget = NodeNameTarget | LocationTarget
+};
+
+/**
+* Class: PatternSet
+* -----------------
+* Description: Several search patterns compiled together. The literal
+* patterns share one Aho-Corasick automaton, so a text is scanned once
+* whatever their number; globs and regular expressions are compiled with
+* the POSIX regex library. The automaton is rebuilt on the first match
+* after a pattern is added, so do not add patterns while matching from
+* several threads.
+*/
+class PatternSet
+{
+public:
+
+    PatternSet();
+    ~PatternSet();
+
+    /**
+    * Method: add
+    * -----------
+    * Description: Adds a pattern to the set
+    * Returns: The index of the pattern
+    */
+    size_t add(const std::string& pattern, PatternKind kind, PatternTarget target = AnyTarget);
+
+    size_t size() const;
+    bool empty() const;
+    void clear();
+
+    /**
+    * Method: match
+    * -------------
+    * Description: Matches a text against the patterns aimed at target
+    * @param matched receives true at the index of every matching pattern;
+    * other entries are left untouched. Must have size() entries.
+    */
+    void match(const std::string& text, PatternTarget target, std::vector<bool>& matched) const;
+
+private:
+
+    struct AutomatonState
+    {
+        std::map<unsigned char, size_t> next;
+        size_t fail;
+        //patterns that end here, including those of the fail states
+        std::vector<size_t> patterns;
+
+        AutomatonState() : fail(0) {}
+    };
+
+    struct Expression
+    {
+        regex_t regex;
+        size_t pattern;
+    };
+
+    std::vector<PatternKind> kinds;
+    std::vector<PatternTarget> targets;
+    //literal patterns, indexed by pattern
+    std::vector<std::string> literals;
+    std::vector<Expression*> expressions;
+    mutable std::vector<AutomatonState> automaton;
+    mutable bool automatonOutdated;
+
+    PatternSet(const PatternSet&);
+    PatternSet& operator=(const PatternSet&);
+
+    void buildAutomaton() const;
+    static std::string globToRegex(const std::string& glob);
+};
+
+} // End of Namespace Searching
+
+#endif
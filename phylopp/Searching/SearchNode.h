@@ -20,7 +20,9 @@
 #ifndef SEARCHNODE_H
 #define SEARCHNODE_H
 
+#include <vector>
 #include "phylopp/Domain/LocationManager.h"
+#include "phylopp/Searching/LocationSearchIndex.h"
 #include "phylopp/Traversal/Traverser.h"
 #include "phylopp/Traversal/NodeVisitor.h"
 
@@ -42,16 +44,21 @@ template <class T>
 class SelectNodeAction
 {
 public:
-    SelectNodeAction(const std::string& searchString, const Locations::LocationManager locationManager)
+    SelectNodeAction(const std::string& searchString, const LocationSearchIndex& index, LocationMatch match) :
+        locationManager(index.getLocationManager()),
+        matchingLocations(locationManager.getLocationsCount() + 1, false)
     {
-        regExp = searchString;
-        this->locationManager = locationManager;
+        std::vector<Locations::LocationId> ids;
+        index.find(searchString, match, ids);
+
+        for (size_t i = 0; i < ids.size(); i++)
+            matchingLocations[ids[i]] = true;
     }
 
     VisitAction visitNode(T* n)
     {
-        Location location = locationManager.getLocation(n->getName());
-        if (!location.empty() && location.find(regExp, 0) != std::string::npos)
+        const Locations::LocationId id = locationManager.getNameLocationId(n->getName());
+        if (id < matchingLocations.size() && matchingLocations[id])
         {
             n->setSelected(true);
             n->update();
@@ -59,8 +66,9 @@ public:
         return ContinueTraversing;
     }
 private:
-    std::string regExp;
-    Locations::LocationManager locationManager;
+    const Locations::LocationManager& locationManager;
+    //indexed by location id, LOCATION_NOT_FOUND never matches
+    std::vector<bool> matchingLocations;
 };
 
 
@@ -73,10 +81,28 @@ public:
         node = root;
     }
 
-    void search(const std::string& expression, Locations::LocationManager locationManager)
+    /**
+    * Method: search
+    * --------------
+    * Description: Selects the leaves whose location matches the expression.
+    * Builds a location index for this search only; keep a
+    * LocationSearchIndex to search many times.
+    */
+    void search(const std::string& expression, const Locations::LocationManager& locationManager, LocationMatch match = SubstringMatch)
+    {
+        const LocationSearchIndex index(locationManager);
+        search(expression, index, match);
+    }
+
+    /**
+    * Method: search
+    * --------------
+    * Description: Selects the leaves whose location matches the expression
+    */
+    void search(const std::string& expression, const LocationSearchIndex& index, LocationMatch match = SubstringMatch)
     {
         Traverser<T, SelectNodeAction<T> , IsLeafPredicate<T> > t;
-        SelectNodeAction<T> a(expression, locationManager);
+        SelectNodeAction<T> a(expression, index, match);
 
         t.traverseDescendants(node, a);
     }
@@ -0,0 +1,485 @@
+/*
+    Copyright (C) 2011 Emmanuel Teisaire, Nicolás Bombau, Carlos Castro, Damián Domé, FuDePAN
+
+    This file is part of the Phyloloc project.
+
+    Phyloloc is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Phyloloc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cstring>
+#include "phylopp/DataSource/FileStreams.h"
+#include "phylopp/Comparison/BipartitionTable.h"
+
+namespace Comparison
+{
+
+typedef Consensus::bitset::Word Word;
+
+// Fewer pending splits are not worth sorting yet
+static const size_t MIN_PENDING_SPLITS = 4096;
+
+static size_t wordsFor(size_t taxa)
+{
+    const size_t bits = sizeof(Word) * 8;
+    return (taxa + bits - 1) / bits;
+}
+
+static size_t alignedOffset(size_t offset)
+{
+    const size_t alignment = BipartitionTableFormat::DATA_ALIGNMENT;
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+/**
+* Struct: TableLayout
+* -------------------
+* Description: Offsets of the sections of a table file
+*/
+struct TableLayout
+{
+    size_t leaves;
+    size_t hashes;
+    size_t words;
+    size_t frequencies;
+    size_t lengths;
+    size_t total;
+
+    TableLayout(size_t stride, size_t count)
+    {
+        leaves = alignedOffset(BipartitionTableFormat::MAGIC_SIZE + 6 * sizeof(uint32_t));
+        hashes = alignedOffset(leaves + stride * sizeof(Word));
+        words = alignedOffset(hashes + count * sizeof(uint64_t));
+        frequencies = alignedOffset(words + count * stride * sizeof(Word));
+        lengths = alignedOffset(frequencies + count * sizeof(uint32_t));
+        total = alignedOffset(lengths + count * sizeof(Domain::BranchLength));
+    }
+};
+
+class PendingLess
+{
+public:
+    PendingLess(const std::vector<uint64_t>& hashes, const std::vector<Word>& words, size_t stride) :
+        hashes(hashes),
+        words(words),
+        stride(stride)
+    {}
+
+    bool operator()(size_t a, size_t b) const
+    {
+        return compareSplitKeys(hashes[a], &words[a * stride], hashes[b], &words[b * stride], stride) < 0;
+    }
+
+private:
+    const std::vector<uint64_t>& hashes;
+    const std::vector<Word>& words;
+    const size_t stride;
+};
+
+SplitCounts::SplitCounts() :
+    taxa(0),
+    stride(0),
+    trees(0),
+    sorted(0),
+    sameLeaves(true)
+{}
+
+void SplitCounts::setTaxonCount(size_t taxa)
+{
+    this->taxa = taxa;
+    stride = wordsFor(taxa);
+    trees = 0;
+    sorted = 0;
+    sameLeaves = true;
+    hashes.clear();
+    words.clear();
+    frequencies.clear();
+    lengthSums.clear();
+    leaves.assign(stride, 0);
+}
+
+void SplitCounts::append(uint64_t hash, const Word* splitWords, uint32_t frequency, double lengthSum)
+{
+    hashes.push_back(hash);
+    words.insert(words.end(), splitWords, splitWords + stride);
+    frequencies.push_back(frequency);
+    lengthSums.push_back(lengthSum);
+}
+
+void SplitCounts::add(const std::vector<Bipartition>& bipartitions, const Consensus::bitset& treeLeaves)
+{
+    std::vector<Word> splitWords(stride);
+
+    for (size_t i = 0; i < bipartitions.size(); i++)
+    {
+        const Consensus::bitset& split = bipartitions[i].split;
+
+        for (size_t w = 0; w < stride; w++)
+            splitWords[w] = split.getWord(w);
+        append(split.hash(), splitWords.empty() ? NULL : &splitWords[0], 1, bipartitions[i].length);
+    }
+
+    for (size_t w = 0; w < stride; w++)
+    {
+        //while every tree has the same leaves, their union is the leaves of each one
+        sameLeaves = sameLeaves && (trees == 0 || leaves[w] == treeLeaves.getWord(w));
+        leaves[w] |= treeLeaves.getWord(w);
+    }
+    trees++;
+
+    //sorting in batches at least as big as the table keeps adding linear on average
+    if (hashes.size() - sorted > std::max(sorted, MIN_PENDING_SPLITS))
+        compact();
+}
+
+void SplitCounts::merge(SplitCounts& other)
+{
+    for (size_t i = 0; i < other.hashes.size(); i++)
+        append(other.hashes[i], &other.words[i * stride], other.frequencies[i], other.lengthSums[i]);
+
+    sameLeaves = sameLeaves && other.sameLeaves;
+    for (size_t w = 0; w < stride; w++)
+    {
+        sameLeaves = sameLeaves && (trees == 0 || other.trees == 0 || leaves[w] == other.leaves[w]);
+        leaves[w] |= other.leaves[w];
+    }
+    trees += other.trees;
+
+    other.setTaxonCount(taxa);
+}
+
+void SplitCounts::compact()
+{
+    const size_t total = hashes.size();
+    std::vector<size_t> order;
+
+    for (size_t i = sorted; i < total; i++)
+        order.push_back(i);
+    std::sort(order.begin(), order.end(), PendingLess(hashes, words, stride));
+
+    SplitCounts merged;
+    merged.setTaxonCount(taxa);
+    merged.hashes.reserve(total);
+    merged.words.reserve(words.size());
+    merged.frequencies.reserve(total);
+    merged.lengthSums.reserve(total);
+
+    size_t table = 0;
+    size_t pending = 0;
+    while (table < sorted || pending < order.size())
+    {
+        size_t next;
+        if (pending == order.size())
+        {
+            next = table++;
+        }
+        else if (table == sorted ||
+                 compareSplitKeys(hashes[order[pending]], &words[order[pending] * stride],
+                                  hashes[table], &words[table * stride], stride) < 0)
+        {
+            next = order[pending++];
+        }
+        else
+        {
+            next = table++;
+        }
+
+        const size_t last = merged.hashes.size();
+        if (last > 0 && compareSplitKeys(merged.hashes[last - 1], &merged.words[(last - 1) * stride],
+                                         hashes[next], &words[next * stride], stride) == 0)
+        {
+            merged.frequencies[last - 1] += frequencies[next];
+            merged.lengthSums[last - 1] += lengthSums[next];
+        }
+        else
+        {
+            merged.append(hashes[next], &words[next * stride], frequencies[next], lengthSums[next]);
+        }
+    }
+
+    hashes.swap(merged.hashes);
+    words.swap(merged.words);
+    frequencies.swap(merged.frequencies);
+    lengthSums.swap(merged.lengthSums);
+    sorted = hashes.size();
+}
+
+size_t SplitCounts::getTaxonCount() const
+{
+    return taxa;
+}
+
+size_t SplitCounts::getStride() const
+{
+    return stride;
+}
+
+size_t SplitCounts::getTreeCount() const
+{
+    return trees;
+}
+
+bool SplitCounts::hasSameLeaves() const
+{
+    return sameLeaves;
+}
+
+size_t SplitCounts::size() const
+{
+    return hashes.size();
+}
+
+const std::vector<uint64_t>& SplitCounts::getHashes() const
+{
+    return hashes;
+}
+
+const std::vector<Word>& SplitCounts::getWords() const
+{
+    return words;
+}
+
+const std::vector<uint32_t>& SplitCounts::getFrequencies() const
+{
+    return frequencies;
+}
+
+const std::vector<double>& SplitCounts::getLengthSums() const
+{
+    return lengthSums;
+}
+
+const std::vector<Word>& SplitCounts::getLeaves() const
+{
+    return leaves;
+}
+
+BipartitionTable::BipartitionTable() :
+    taxa(0),
+    stride(0),
+    count(0),
+    trees(0),
+    leaves(NULL),
+    hashes(NULL),
+    words(NULL),
+    frequencies(NULL),
+    lengths(NULL)
+{}
+
+void BipartitionTable::assign(const SplitCounts& counts)
+{
+    file.close();
+
+    taxa = counts.getTaxonCount();
+    stride = counts.getStride();
+    count = counts.size();
+    trees = counts.getTreeCount();
+
+    ownLeaves = counts.getLeaves();
+    ownHashes = counts.getHashes();
+    ownWords = counts.getWords();
+    ownFrequencies = counts.getFrequencies();
+    ownLengths.resize(count);
+    for (size_t i = 0; i < count; i++)
+        ownLengths[i] = static_cast<Domain::BranchLength>(counts.getLengthSums()[i] / ownFrequencies[i]);
+
+    leaves = ownLeaves.empty() ? NULL : &ownLeaves[0];
+    hashes = ownHashes.empty() ? NULL : &ownHashes[0];
+    words = ownWords.empty() ? NULL : &ownWords[0];
+    frequencies = ownFrequencies.empty() ? NULL : &ownFrequencies[0];
+    lengths = ownLengths.empty() ? NULL : &ownLengths[0];
+}
+
+static void writeUInt(std::ostream& os, uint32_t value)
+{
+    os.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// Writes a section, padded with zeros up to the next one
+static void writeSection(std::ostream& os, const void* data, size_t bytes, size_t& offset, size_t next)
+{
+    os.write(static_cast<const char*>(data), bytes);
+    const std::vector<char> padding(next - offset - bytes, 0);
+    os.write(padding.empty() ? NULL : &padding[0], padding.size());
+    offset = next;
+}
+
+void BipartitionTable::save(const std::string& fname) const
+{
+    const TableLayout layout(stride, count);
+    DataSource::OutputFileStream os(fname);
+
+    os.write(BipartitionTableFormat::MAGIC, BipartitionTableFormat::MAGIC_SIZE);
+    writeUInt(os, BipartitionTableFormat::BYTE_ORDER_MARK);
+    writeUInt(os, BipartitionTableFormat::VERSION);
+    writeUInt(os, static_cast<uint32_t>(taxa));
+    writeUInt(os, static_cast<uint32_t>(stride));
+    writeUInt(os, static_cast<uint32_t>(count));
+    writeUInt(os, static_cast<uint32_t>(trees));
+
+    size_t offset = BipartitionTableFormat::MAGIC_SIZE + 6 * sizeof(uint32_t);
+    writeSection(os, NULL, 0, offset, layout.leaves);
+    writeSection(os, leaves, stride * sizeof(Word), offset, layout.hashes);
+    writeSection(os, hashes, count * sizeof(uint64_t), offset, layout.words);
+    writeSection(os, words, count * stride * sizeof(Word), offset, layout.frequencies);
+    writeSection(os, frequencies, count * sizeof(uint32_t), offset, layout.lengths);
+    writeSection(os, lengths, count * sizeof(Domain::BranchLength), offset, layout.total);
+}
+
+static uint32_t readUInt(const char* data, size_t index)
+{
+    uint32_t value;
+    memcpy(&value, data + BipartitionTableFormat::MAGIC_SIZE + index * sizeof(value), sizeof(value));
+    return value;
+}
+
+void BipartitionTable::load(const std::string& fname)
+{
+    BipartitionTable loaded;
+
+    if (!loaded.file.open(fname))
+        throw BipartitionTableFileNotFound();
+
+    const char* const data = loaded.file.data();
+    const size_t size = loaded.file.size();
+
+    if (size < BipartitionTableFormat::MAGIC_SIZE + 6 * sizeof(uint32_t)
+            || memcmp(data, BipartitionTableFormat::MAGIC, BipartitionTableFormat::MAGIC_SIZE) != 0)
+        throw MalformedBipartitionTableFile("bad magic");
+
+    if (readUInt(data, 0) != BipartitionTableFormat::BYTE_ORDER_MARK)
+        throw MalformedBipartitionTableFile("byte order mismatch");
+
+    if (readUInt(data, 1) != BipartitionTableFormat::VERSION)
+        throw MalformedBipartitionTableFile("unknown version");
+
+    loaded.taxa = readUInt(data, 2);
+    loaded.stride = readUInt(data, 3);
+    loaded.count = readUInt(data, 4);
+    loaded.trees = readUInt(data, 5);
+
+    const TableLayout layout(loaded.stride, loaded.count);
+    if (loaded.stride != wordsFor(loaded.taxa) || size != layout.total)
+        throw MalformedBipartitionTableFile("wrong table size");
+
+    loaded.leaves = reinterpret_cast<const Word*>(data + layout.leaves);
+    loaded.hashes = reinterpret_cast<const uint64_t*>(data + layout.hashes);
+    loaded.words = reinterpret_cast<const Word*>(data + layout.words);
+    loaded.frequencies = reinterpret_cast<const uint32_t*>(data + layout.frequencies);
+    loaded.lengths = reinterpret_cast<const Domain::BranchLength*>(data + layout.lengths);
+
+    swap(loaded);
+}
+
+void BipartitionTable::swap(BipartitionTable& other)
+{
+    std::swap(taxa, other.taxa);
+    std::swap(stride, other.stride);
+    std::swap(count, other.count);
+    std::swap(trees, other.trees);
+    std::swap(leaves, other.leaves);
+    std::swap(hashes, other.hashes);
+    std::swap(words, other.words);
+    std::swap(frequencies, other.frequencies);
+    std::swap(lengths, other.lengths);
+    ownLeaves.swap(other.ownLeaves);
+    ownHashes.swap(other.ownHashes);
+    ownWords.swap(other.ownWords);
+    ownFrequencies.swap(other.ownFrequencies);
+    ownLengths.swap(other.ownLengths);
+    file.swap(other.file);
+}
+
+size_t BipartitionTable::size() const
+{
+    return count;
+}
+
+size_t BipartitionTable::getTaxonCount() const
+{
+    return taxa;
+}
+
+size_t BipartitionTable::getTreeCount() const
+{
+    return trees;
+}
+
+size_t BipartitionTable::find(const Consensus::bitset& split) const
+{
+    size_t ret = SPLIT_NOT_FOUND;
+
+    if (split.size() == taxa && count > 0)
+    {
+        Consensus::bitset canonical(split);
+        Consensus::bitset allLeaves;
+        getLeaves(allLeaves);
+        canonical &= allLeaves;
+        canonicalize(canonical, allLeaves);
+
+        std::vector<Word> key(stride);
+        for (size_t w = 0; w < stride; w++)
+            key[w] = canonical.getWord(w);
+        const uint64_t hash = canonical.hash();
+        const Word* const keyWords = key.empty() ? NULL : &key[0];
+
+        //lower bound over the sorted splits
+        size_t first = 0;
+        size_t last = count;
+        while (first < last)
+        {
+            const size_t middle = first + (last - first) / 2;
+            if (compareSplitKeys(hashes[middle], words + middle * stride, hash, keyWords, stride) < 0)
+                first = middle + 1;
+            else
+                last = middle;
+        }
+
+        if (first < count && compareSplitKeys(hashes[first], words + first * stride, hash, keyWords, stride) == 0)
+            ret = first;
+    }
+
+    return ret;
+}
+
+void BipartitionTable::getSplit(size_t index, Consensus::bitset& split) const
+{
+    split = Consensus::bitset(taxa);
+    for (size_t w = 0; w < stride; w++)
+        split.setWord(w, words[index * stride + w]);
+}
+
+void BipartitionTable::getLeaves(Consensus::bitset& allLeaves) const
+{
+    allLeaves = Consensus::bitset(taxa);
+    for (size_t w = 0; w < stride; w++)
+        allLeaves.setWord(w, leaves[w]);
+}
+
+size_t BipartitionTable::getFrequency(size_t index) const
+{
+    return frequencies[index];
+}
+
+double BipartitionTable::getSupport(size_t index) const
+{
+    return trees > 0 ? double(frequencies[index]) / double(trees) : 0.0;
+}
+
+Domain::BranchLength BipartitionTable::getMeanLength(size_t index) const
+{
+    return lengths[index];
+}
+
+} // End of Namespace Comparison
@@ -0,0 +1,201 @@
+/*
+    Copyright (C) 2011 Emmanuel Teisaire, Nicolás Bombau, Carlos Castro, Damián Domé, FuDePAN
+
+    This file is part of the Phyloloc project.
+
+    Phyloloc is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Phyloloc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <math.h>
+#include "phylopp/Comparison/Bipartitions.h"
+
+namespace Comparison
+{
+
+typedef Consensus::bitset::Word Word;
+
+int compareSplitKeys(uint64_t hashA, const Word* wordsA, uint64_t hashB, const Word* wordsB, size_t stride)
+{
+    int order = (hashA < hashB) ? -1 : (hashA > hashB ? 1 : 0);
+
+    for (size_t i = 0; i < stride && order == 0; i++)
+        order = (wordsA[i] < wordsB[i]) ? -1 : (wordsA[i] > wordsB[i] ? 1 : 0);
+
+    return order;
+}
+
+class BipartitionLess
+{
+public:
+    BipartitionLess(const std::vector<Bipartition>& bipartitions, const std::vector<size_t>& hashes,
+                    std::vector<Word>& wordsA, std::vector<Word>& wordsB) :
+        bipartitions(bipartitions),
+        hashes(hashes),
+        wordsA(wordsA),
+        wordsB(wordsB)
+    {}
+
+    bool operator()(size_t a, size_t b) const
+    {
+        const Consensus::bitset& splitA = bipartitions[a].split;
+        const Consensus::bitset& splitB = bipartitions[b].split;
+
+        for (size_t i = 0; i < wordsA.size(); i++)
+        {
+            wordsA[i] = splitA.getWord(i);
+            wordsB[i] = splitB.getWord(i);
+        }
+        return compareSplitKeys(hashes[a], wordsA.empty() ? NULL : &wordsA[0],
+                                hashes[b], wordsB.empty() ? NULL : &wordsB[0], wordsA.size()) < 0;
+    }
+
+private:
+    const std::vector<Bipartition>& bipartitions;
+    const std::vector<size_t>& hashes;
+    std::vector<Word>& wordsA;
+    std::vector<Word>& wordsB;
+};
+
+void canonicalize(Consensus::bitset& split, const Consensus::bitset& leaves)
+{
+    const size_t inside = split.count();
+    const size_t outside = leaves.count() - inside;
+    bool complement = inside > outside;
+
+    if (inside == outside && inside > 0)
+    {
+        //the lowest leaf decides
+        size_t word = 0;
+        while (leaves.getWord(word) == 0)
+            word++;
+        const Word lowest = leaves.getWord(word) & (~leaves.getWord(word) + 1);
+        complement = (split.getWord(word) & lowest) != 0;
+    }
+
+    if (complement)
+    {
+        split.flip();
+        split &= leaves;
+    }
+}
+
+void mergeDuplicates(std::vector<Bipartition>& bipartitions)
+{
+    const size_t count = bipartitions.size();
+    const size_t stride = count > 0 ? bipartitions[0].split.wordCount() : 0;
+    std::vector<size_t> hashes(count);
+    std::vector<size_t> order(count);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        hashes[i] = bipartitions[i].split.hash();
+        order[i] = i;
+    }
+
+    std::vector<Word> wordsA(stride);
+    std::vector<Word> wordsB(stride);
+    std::sort(order.begin(), order.end(), BipartitionLess(bipartitions, hashes, wordsA, wordsB));
+
+    std::vector<Bipartition> merged;
+    merged.reserve(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        Bipartition& current = bipartitions[order[i]];
+
+        if (!merged.empty() && merged.back().split == current.split)
+        {
+            merged.back().length += current.length;
+        }
+        else
+        {
+            merged.push_back(Bipartition());
+            merged.back().split.swap(current.split);
+            merged.back().length = current.length;
+        }
+    }
+    bipartitions.swap(merged);
+}
+
+SplitSignature::SplitSignature() :
+    stride(0)
+{}
+
+void SplitSignature::assign(const std::vector<Bipartition>& bipartitions)
+{
+    const size_t count = bipartitions.size();
+
+    stride = count > 0 ? bipartitions[0].split.wordCount() : 0;
+    hashes.resize(count);
+    words.resize(count * stride);
+    lengths.resize(count);
+    trivial.resize(count);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const Consensus::bitset& split = bipartitions[i].split;
+
+        hashes[i] = split.hash();
+        for (size_t w = 0; w < stride; w++)
+            words[i * stride + w] = split.getWord(w);
+        lengths[i] = bipartitions[i].length;
+        trivial[i] = split.count() <= 1;
+    }
+}
+
+size_t SplitSignature::size() const
+{
+    return hashes.size();
+}
+
+int SplitSignature::compareSplits(const SplitSignature& a, size_t i, const SplitSignature& b, size_t j)
+{
+    return compareSplitKeys(a.hashes[i], &a.words[i * a.stride], b.hashes[j], &b.words[j * b.stride], a.stride);
+}
+
+void SplitSignature::compare(const SplitSignature& a, const SplitSignature& b,
+                             size_t& different, Locations::Distance& weighted)
+{
+    size_t i = 0;
+    size_t j = 0;
+    double weight = 0.0;
+
+    different = 0;
+    while (i < a.size() || j < b.size())
+    {
+        const int order = (i == a.size()) ? 1 : (j == b.size() ? -1 : compareSplits(a, i, b, j));
+
+        if (order < 0)
+        {
+            different += a.trivial[i] ? 0 : 1;
+            weight += fabs(a.lengths[i]);
+            i++;
+        }
+        else if (order > 0)
+        {
+            different += b.trivial[j] ? 0 : 1;
+            weight += fabs(b.lengths[j]);
+            j++;
+        }
+        else
+        {
+            weight += fabs(a.lengths[i] - b.lengths[j]);
+            i++;
+            j++;
+        }
+    }
+    weighted = static_cast<Locations::Distance>(weight);
+}
+
+} // End of Namespace Comparison
@@ -0,0 +1,140 @@
+/*
+    Copyright (C) 2011 Emmanuel Teisaire, Nicolás Bombau, Carlos Castro, Damián Domé, FuDePAN
+
+    This file is part of the Phyloloc project.
+
+    Phyloloc is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Phyloloc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "phylopp/DataSource/FileStreams.h"
+#include "phylopp/DataSource/FileBuffer.h"
+
+namespace DataSource
+{
+
+static const size_t MAGIC_SIZE = 4;
+static const size_t DECOMPRESS_BLOCK_SIZE = 1 << 20;
+
+FileBuffer::FileBuffer() :
+    mapping(NULL),
+    mappingSize(0),
+    begin(NULL),
+    length(0)
+{}
+
+FileBuffer::~FileBuffer()
+{
+    close();
+}
+
+bool FileBuffer::open(const std::string& fname)
+{
+    close();
+
+    const int fd = ::open(fname.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+    bool ok = fstat(fd, &info) == 0;
+
+    if (ok && info.st_size > 0)
+    {
+        mappingSize = static_cast<size_t>(info.st_size);
+        mapping = mmap(NULL, mappingSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        ok = mapping != MAP_FAILED;
+        if (!ok)
+            mapping = NULL;
+    }
+    ::close(fd);
+
+    if (ok && mapping != NULL)
+    {
+        madvise(mapping, mappingSize, MADV_SEQUENTIAL);
+        begin = static_cast<const char*>(mapping);
+        length = mappingSize;
+
+        const unsigned char* header = static_cast<const unsigned char*>(mapping);
+        if (detectCompression(header, std::min(mappingSize, MAGIC_SIZE)) != NoCompression)
+            ok = decompress(fname);
+    }
+
+    return ok;
+}
+
+bool FileBuffer::decompress(const std::string& fname)
+{
+    munmap(mapping, mappingSize);
+    mapping = NULL;
+    mappingSize = 0;
+
+    InputFileStream f(fname);
+    size_t filled = 0;
+
+    while (f)
+    {
+        contents.resize(filled + DECOMPRESS_BLOCK_SIZE);
+        f.read(&contents[filled], DECOMPRESS_BLOCK_SIZE);
+        filled += static_cast<size_t>(f.gcount());
+    }
+    contents.resize(filled);
+
+    begin = contents.empty() ? NULL : &contents[0];
+    length = filled;
+    return f.is_open();
+}
+
+void FileBuffer::close()
+{
+    if (mapping != NULL)
+    {
+        munmap(mapping, mappingSize);
+        mapping = NULL;
+        mappingSize = 0;
+    }
+    std::vector<char>().swap(contents);
+    begin = NULL;
+    length = 0;
+}
+
+void FileBuffer::swap(FileBuffer& other)
+{
+    std::swap(mapping, other.mapping);
+    std::swap(mappingSize, other.mappingSize);
+    contents.swap(other.contents);
+    std::swap(begin, other.begin);
+    std::swap(length, other.length);
+}
+
+const char* FileBuffer::data() const
+{
+    return begin;
+}
+
+const char* FileBuffer::end() const
+{
+    return begin + length;
+}
+
+size_t FileBuffer::size() const
+{
+    return length;
+}
+
+}
@@ -0,0 +1,495 @@
+/*
+    Copyright (C) 2011 Emmanuel Teisaire, Nicolás Bombau, Carlos Castro, Damián Domé, FuDePAN
+
+    This file is part of the Phyloloc project.
+
+    Phyloloc is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Phyloloc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cstring>
+#include <zlib.h>
+#ifdef PHYLOPP_ZSTD
+#include <zstd.h>
+#endif
+#include "phylopp/DataSource/FileStreams.h"
+
+namespace DataSource
+{
+
+static const size_t STREAM_BUFFER_SIZE = 1 << 16;
+static const int ZSTD_LEVEL = 3;
+// zlib window bits, plus 32 to accept both zlib and gzip headers on input
+static const int GZIP_READ_WINDOW = 15 + 32;
+// zlib window bits, plus 16 to write a gzip header on output
+static const int GZIP_WRITE_WINDOW = 15 + 16;
+static const int GZIP_MEMORY_LEVEL = 8;
+
+Compression detectCompression(const unsigned char* header, size_t size)
+{
+    Compression compression = NoCompression;
+
+    if (size >= 2 && header[0] == 0x1f && header[1] == 0x8b)
+        compression = GzipCompression;
+    else if (size >= 4 && header[0] == 0x28 && header[1] == 0xb5 && header[2] == 0x2f && header[3] == 0xfd)
+        compression = ZstdCompression;
+
+    return compression;
+}
+
+static bool endsWith(const std::string& s, const std::string& suffix)
+{
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+Compression compressionFromFileName(const std::string& fname)
+{
+    Compression compression = NoCompression;
+
+    if (endsWith(fname, ".gz"))
+        compression = GzipCompression;
+    else if (endsWith(fname, ".zst"))
+        compression = ZstdCompression;
+
+    return compression;
+}
+
+/* DecompressingStreamBuf
+ */
+
+struct DecompressingStreamBuf::Decoder
+{
+    z_stream gzip;
+#ifdef PHYLOPP_ZSTD
+    ZSTD_DStream* zstd;
+#endif
+    // true while a compressed frame has been started but not finished
+    bool frameOpen;
+};
+
+DecompressingStreamBuf::DecompressingStreamBuf() :
+    file(NULL),
+    compression(NoCompression),
+    decoder(NULL),
+    input(STREAM_BUFFER_SIZE),
+    output(STREAM_BUFFER_SIZE),
+    inputBegin(0),
+    inputEnd(0)
+{}
+
+DecompressingStreamBuf::~DecompressingStreamBuf()
+{
+    close();
+}
+
+bool DecompressingStreamBuf::open(const std::string& fname)
+{
+    close();
+    file = fopen(fname.c_str(), "rb");
+
+    if (file != NULL)
+    {
+        fillInput();
+        compression = detectCompression(reinterpret_cast<unsigned char*>(&input[0]), inputEnd);
+
+        if (compression != NoCompression)
+        {
+            decoder = new Decoder;
+            decoder->frameOpen = false;
+        }
+
+        switch (compression)
+        {
+            case GzipCompression:
+                memset(&decoder->gzip, 0, sizeof(decoder->gzip));
+                if (inflateInit2(&decoder->gzip, GZIP_READ_WINDOW) != Z_OK)
+                    throw CorruptedCompressedFile();
+                break;
+            case ZstdCompression:
+#ifdef PHYLOPP_ZSTD
+                decoder->zstd = ZSTD_createDStream();
+                ZSTD_initDStream(decoder->zstd);
+                break;
+#else
+                close();
+                throw UnsupportedCompression("zstd");
+#endif
+            case NoCompression:
+                break;
+        }
+    }
+    return file != NULL;
+}
+
+void DecompressingStreamBuf::close()
+{
+    if (decoder != NULL)
+    {
+        if (compression == GzipCompression)
+            inflateEnd(&decoder->gzip);
+#ifdef PHYLOPP_ZSTD
+        else if (compression == ZstdCompression)
+            ZSTD_freeDStream(decoder->zstd);
+#endif
+        delete decoder;
+        decoder = NULL;
+    }
+
+    if (file != NULL)
+    {
+        fclose(file);
+        file = NULL;
+    }
+    inputBegin = inputEnd = 0;
+    compression = NoCompression;
+    setg(NULL, NULL, NULL);
+}
+
+bool DecompressingStreamBuf::is_open() const
+{
+    return file != NULL;
+}
+
+Compression DecompressingStreamBuf::getCompression() const
+{
+    return compression;
+}
+
+bool DecompressingStreamBuf::fillInput()
+{
+    inputBegin = 0;
+    inputEnd = fread(&input[0], 1, input.size(), file);
+    return inputEnd > 0;
+}
+
+DecompressingStreamBuf::int_type DecompressingStreamBuf::underflow()
+{
+    if (gptr() < egptr())
+        return traits_type::to_int_type(*gptr());
+
+    if (file == NULL)
+        return traits_type::eof();
+
+    if (compression == NoCompression)
+    {
+        //plain files are served straight from the read buffer
+        if (inputBegin == inputEnd && !fillInput())
+            return traits_type::eof();
+
+        char* const begin = &input[0];
+        setg(begin + inputBegin, begin + inputBegin, begin + inputEnd);
+        inputBegin = inputEnd;
+    }
+    else
+    {
+        const size_t produced = decode();
+        if (produced == 0)
+            return traits_type::eof();
+
+        setg(&output[0], &output[0], &output[0] + produced);
+    }
+
+    return traits_type::to_int_type(*gptr());
+}
+
+size_t DecompressingStreamBuf::decode()
+{
+    size_t produced = 0;
+
+    while (produced == 0)
+    {
+        if (inputBegin == inputEnd && !fillInput())
+        {
+            if (decoder->frameOpen)
+                throw CorruptedCompressedFile("unexpected end of file");
+            return 0;
+        }
+
+        if (compression == GzipCompression)
+        {
+            z_stream& stream = decoder->gzip;
+            stream.next_in = reinterpret_cast<Bytef*>(&input[inputBegin]);
+            stream.avail_in = static_cast<uInt>(inputEnd - inputBegin);
+            stream.next_out = reinterpret_cast<Bytef*>(&output[0]);
+            stream.avail_out = static_cast<uInt>(output.size());
+
+            const int ret = inflate(&stream, Z_NO_FLUSH);
+            if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR)
+                throw CorruptedCompressedFile();
+
+            inputBegin = inputEnd - stream.avail_in;
+            produced = output.size() - stream.avail_out;
+
+            if (ret == Z_STREAM_END)
+            {
+                //concatenated gzip members are read as a single stream
+                inflateReset(&stream);
+                decoder->frameOpen = false;
+            }
+            else
+                decoder->frameOpen = true;
+        }
+#ifdef PHYLOPP_ZSTD
+        else
+        {
+            ZSTD_inBuffer in = { &input[inputBegin], inputEnd - inputBegin, 0 };
+            ZSTD_outBuffer out = { &output[0], output.size(), 0 };
+
+            const size_t ret = ZSTD_decompressStream(decoder->zstd, &out, &in);
+            if (ZSTD_isError(ret))
+                throw CorruptedCompressedFile(ZSTD_getErrorName(ret));
+
+            inputBegin += in.pos;
+            produced = out.pos;
+            decoder->frameOpen = (ret != 0);
+        }
+#endif
+    }
+
+    return produced;
+}
+
+/* CompressingStreamBuf
+ */
+
+struct CompressingStreamBuf::Encoder
+{
+    z_stream gzip;
+#ifdef PHYLOPP_ZSTD
+    ZSTD_CStream* zstd;
+#endif
+};
+
+CompressingStreamBuf::CompressingStreamBuf() :
+    file(NULL),
+    compression(NoCompression),
+    encoder(NULL),
+    input(STREAM_BUFFER_SIZE),
+    output(STREAM_BUFFER_SIZE)
+{}
+
+CompressingStreamBuf::~CompressingStreamBuf()
+{
+    close();
+}
+
+bool CompressingStreamBuf::open(const std::string& fname, Compression c)
+{
+    close();
+
+#ifndef PHYLOPP_ZSTD
+    if (c == ZstdCompression)
+        throw UnsupportedCompression("zstd");
+#endif
+
+    file = fopen(fname.c_str(), "wb");
+
+    if (file != NULL)
+    {
+        compression = c;
+        if (compression != NoCompression)
+            encoder = new Encoder;
+
+        if (compression == GzipCompression)
+        {
+            memset(&encoder->gzip, 0, sizeof(encoder->gzip));
+            if (deflateInit2(&encoder->gzip, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                             GZIP_WRITE_WINDOW, GZIP_MEMORY_LEVEL, Z_DEFAULT_STRATEGY) != Z_OK)
+                throw CorruptedCompressedFile();
+        }
+#ifdef PHYLOPP_ZSTD
+        else if (compression == ZstdCompression)
+        {
+            encoder->zstd = ZSTD_createCStream();
+            ZSTD_initCStream(encoder->zstd, ZSTD_LEVEL);
+        }
+#endif
+        setp(&input[0], &input[0] + input.size());
+    }
+    return file != NULL;
+}
+
+void CompressingStreamBuf::close()
+{
+    if (file != NULL)
+    {
+        flushInput(true);
+
+        if (compression == GzipCompression)
+            deflateEnd(&encoder->gzip);
+#ifdef PHYLOPP_ZSTD
+        else if (compression == ZstdCompression)
+            ZSTD_freeCStream(encoder->zstd);
+#endif
+        delete encoder;
+        encoder = NULL;
+
+        fclose(file);
+        file = NULL;
+    }
+    setp(NULL, NULL);
+}
+
+bool CompressingStreamBuf::is_open() const
+{
+    return file != NULL;
+}
+
+CompressingStreamBuf::int_type CompressingStreamBuf::overflow(int_type c)
+{
+    if (file == NULL || !flushInput(false))
+        return traits_type::eof();
+
+    if (!traits_type::eq_int_type(c, traits_type::eof()))
+    {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+    return traits_type::not_eof(c);
+}
+
+std::streamsize CompressingStreamBuf::xsputn(const char* s, std::streamsize n)
+{
+    std::streamsize written;
+
+    //large blocks skip the copy into the put area
+    if (file != NULL && static_cast<size_t>(n) >= input.size())
+        written = (flushInput(false) && encode(s, n, false)) ? n : 0;
+    else
+        written = std::streambuf::xsputn(s, n);
+
+    return written;
+}
+
+int CompressingStreamBuf::sync()
+{
+    bool ok = true;
+    if (file != NULL)
+        ok = flushInput(false) && fflush(file) == 0;
+
+    return ok ? 0 : -1;
+}
+
+bool CompressingStreamBuf::flushInput(bool finish)
+{
+    const bool ok = encode(pbase(), pptr() - pbase(), finish);
+    setp(&input[0], &input[0] + input.size());
+    return ok;
+}
+
+bool CompressingStreamBuf::encode(const char* data, size_t size, bool finish)
+{
+    bool ok = true;
+
+    if (compression == NoCompression)
+    {
+        ok = fwrite(data, 1, size, file) == size;
+    }
+    else if (compression == GzipCompression)
+    {
+        z_stream& stream = encoder->gzip;
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+        stream.avail_in = static_cast<uInt>(size);
+
+        int ret;
+        do
+        {
+            stream.next_out = reinterpret_cast<Bytef*>(&output[0]);
+            stream.avail_out = static_cast<uInt>(output.size());
+            ret = deflate(&stream, finish ? Z_FINISH : Z_NO_FLUSH);
+
+            const size_t produced = output.size() - stream.avail_out;
+            ok = ret != Z_STREAM_ERROR && fwrite(&output[0], 1, produced, file) == produced;
+        }
+        while (ok && (stream.avail_out == 0 || (finish && ret != Z_STREAM_END)));
+    }
+#ifdef PHYLOPP_ZSTD
+    else
+    {
+        ZSTD_inBuffer in = { data, size, 0 };
+        while (ok && in.pos < in.size)
+        {
+            ZSTD_outBuffer out = { &output[0], output.size(), 0 };
+            ok = !ZSTD_isError(ZSTD_compressStream(encoder->zstd, &out, &in))
+                 && fwrite(&output[0], 1, out.pos, file) == out.pos;
+        }
+
+        size_t remaining = finish ? 1 : 0;
+        while (ok && remaining != 0)
+        {
+            ZSTD_outBuffer out = { &output[0], output.size(), 0 };
+            remaining = ZSTD_endStream(encoder->zstd, &out);
+            ok = !ZSTD_isError(remaining) && fwrite(&output[0], 1, out.pos, file) == out.pos;
+        }
+    }
+#endif
+
+    return ok;
+}
+
+/* InputFileStream
+ */
+
+InputFileStream::InputFileStream(const std::string& fname) :
+    std::istream(NULL)
+{
+    rdbuf(&buffer);
+    //decoding errors are thrown from the buffer up to the parsers
+    exceptions(std::ios::badbit);
+
+    if (!buffer.open(fname))
+        setstate(std::ios::failbit);
+}
+
+bool InputFileStream::is_open() const
+{
+    return buffer.is_open();
+}
+
+Compression InputFileStream::getCompression() const
+{
+    return buffer.getCompression();
+}
+
+/* OutputFileStream
+ */
+
+OutputFileStream::OutputFileStream(const std::string& fname, Compression compression) :
+    std::ostream(NULL)
+{
+    rdbuf(&buffer);
+
+    if (!buffer.open(fname, compression))
+        setstate(std::ios::failbit);
+}
+
+OutputFileStream::OutputFileStream(const std::string& fname) :
+    std::ostream(NULL)
+{
+    rdbuf(&buffer);
+
+    if (!buffer.open(fname, compressionFromFileName(fname)))
+        setstate(std::ios::failbit);
+}
+
+bool OutputFileStream::is_open() const
+{
+    return buffer.is_open();
+}
+
+void OutputFileStream::close()
+{
+    buffer.close();
+}
+
+}
@@ -0,0 +1,80 @@
+/*
+    Copyright (C) 2011 Emmanuel Teisaire, Nicolás Bombau, Carlos Castro, Damián Domé, FuDePAN
+
+    This file is part of the Phyloloc project.
+
+    Phyloloc is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Phyloloc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <vector>
+#include <math.h>
+#include "phylopp/Generator/LocationGenerator.h"
+#include "phylopp/DataSource/LocationsWriter.h"
+#include "phylopp/DataSource/DistancesWriter.h"
+
+namespace Generator
+{
+
+LocationGenerator::LocationGenerator(Seed seed) :
+    random(seed)
+{}
+
+void LocationGenerator::generate(size_t leaves, size_t locations, Locations::LocationManager& locationManager)
+{
+    if (locations == 0 || leaves < locations)
+        throw InvalidGeneratorParameters("every location needs at least one leaf");
+
+    for (size_t leaf = 0; leaf < leaves; leaf++)
+    {
+        const size_t location = (leaf < locations) ? leaf : random.nextIndex(locations);
+        locationManager.addLocation(locationName(location), leafName(leaf));
+    }
+
+    std::vector<double> x(locations);
+    std::vector<double> y(locations);
+    for (size_t i = 0; i < locations; i++)
+    {
+        x[i] = random.nextUniform() * AREA_SIDE;
+        y[i] = random.nextUniform() * AREA_SIDE;
+    }
+
+    std::vector<Locations::LocationId> ids(locations);
+    std::vector<Locations::Distance> matrix(locations * locations);
+    for (size_t i = 0; i < locations; i++)
+    {
+        ids[i] = locationManager.getLocationId(locationName(i));
+        for (size_t j = 0; j < locations; j++)
+        {
+            const double dx = x[i] - x[j];
+            const double dy = y[i] - y[j];
+            matrix[i * locations + j] = static_cast<Locations::Distance>(sqrt(dx * dx + dy * dy));
+        }
+    }
+    locationManager.addDistances(ids, &matrix[0]);
+}
+
+void LocationGenerator::saveFiles(const std::string& locationsFname, const std::string& distancesFname,
+                                  size_t leaves, size_t locations)
+{
+    Locations::LocationManager locationManager;
+    generate(leaves, locations, locationManager);
+
+    LocationsWriter locationsWriter;
+    locationsWriter.saveLocationsFile(locationsFname, locationManager);
+
+    DistancesWriter distancesWriter;
+    distancesWriter.saveDistancesFile(distancesFname, locationManager);
+}
+
+} // End of Namespace Generator
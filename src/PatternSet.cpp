@@ -0,0 +1,265 @@
+/*
+    Copyright (C) 2011 Emmanuel Teisaire, Nicolás Bombau, Carlos Castro, Damián Domé, FuDePAN
+
+    This file is part of the Phyloloc project.
+
+    Phyloloc is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Phyloloc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <queue>
+#include <cctype>
+#include "phylopp/Searching/PatternSet.h"
+
+namespace Searching
+{
+
+static const size_t ROOT_STATE = 0;
+
+PatternSet::PatternSet() :
+    automatonOutdated(true)
+{}
+
+PatternSet::~PatternSet()
+{
+    clear();
+}
+
+size_t PatternSet::add(const std::string& pattern, PatternKind kind, PatternTarget target)
+{
+    const size_t index = targets.size();
+
+    if (kind == LiteralPattern)
+    {
+        literals.resize(index + 1);
+        literals[index] = pattern;
+        automatonOutdated = true;
+    }
+    else
+    {
+        Expression* const expression = new Expression;
+        const std::string regex = (kind == GlobPattern) ? globToRegex(pattern) : pattern;
+
+        if (regcomp(&expression->regex, regex.c_str(), REG_EXTENDED | REG_NOSUB) != 0)
+        {
+            delete expression;
+            throw InvalidPattern(pattern);
+        }
+
+        expression->pattern = index;
+        expressions.push_back(expression);
+        literals.resize(index + 1);
+    }
+
+    kinds.push_back(kind);
+    targets.push_back(target);
+    return index;
+}
+
+size_t PatternSet::size() const
+{
+    return targets.size();
+}
+
+bool PatternSet::empty() const
+{
+    return targets.empty();
+}
+
+void PatternSet::clear()
+{
+    for (size_t i = 0; i < expressions.size(); i++)
+    {
+        regfree(&expressions[i]->regex);
+        delete expressions[i];
+    }
+    expressions.clear();
+    kinds.clear();
+    targets.clear();
+    literals.clear();
+    automaton.clear();
+    automatonOutdated = true;
+}
+
+void PatternSet::match(const std::string& text, PatternTarget target, std::vector<bool>& matched) const
+{
+    if (automatonOutdated)
+        buildAutomaton();
+
+    //literals: one pass of the automaton over the text
+    size_t state = ROOT_STATE;
+    for (size_t i = 0; i <= text.size(); i++)
+    {
+        const std::vector<size_t>& patterns = automaton[state].patterns;
+        for (size_t k = 0; k < patterns.size(); k++)
+        {
+            if (targets[patterns[k]] & target)
+                matched[patterns[k]] = true;
+        }
+
+        if (i < text.size())
+        {
+            const unsigned char c = static_cast<unsigned char>(text[i]);
+            std::map<unsigned char, size_t>::const_iterator next = automaton[state].next.find(c);
+
+            while (state != ROOT_STATE && next == automaton[state].next.end())
+            {
+                state = automaton[state].fail;
+                next = automaton[state].next.find(c);
+            }
+
+            state = (next == automaton[state].next.end()) ? ROOT_STATE : next->second;
+        }
+    }
+
+    for (size_t i = 0; i < expressions.size(); i++)
+    {
+        const size_t pattern = expressions[i]->pattern;
+
+        if ((targets[pattern] & target) && !matched[pattern])
+            matched[pattern] = regexec(&expressions[i]->regex, text.c_str(), 0, NULL, 0) == 0;
+    }
+}
+
+void PatternSet::buildAutomaton() const
+{
+    automaton.assign(1, AutomatonState());
+
+    //trie of the literals
+    for (size_t pattern = 0; pattern < literals.size(); pattern++)
+    {
+        if (kinds[pattern] == LiteralPattern)
+        {
+            size_t state = ROOT_STATE;
+
+            for (size_t i = 0; i < literals[pattern].size(); i++)
+            {
+                const unsigned char c = static_cast<unsigned char>(literals[pattern][i]);
+                std::map<unsigned char, size_t>::const_iterator next = automaton[state].next.find(c);
+
+                if (next == automaton[state].next.end())
+                {
+                    automaton[state].next[c] = automaton.size();
+                    state = automaton.size();
+                    automaton.push_back(AutomatonState());
+                }
+                else
+                {
+                    state = next->second;
+                }
+            }
+
+            automaton[state].patterns.push_back(pattern);
+        }
+    }
+
+    //fail links, breadth first so that shorter states are done first
+    std::queue<size_t> pending;
+    for (std::map<unsigned char, size_t>::const_iterator it = automaton[ROOT_STATE].next.begin(); it != automaton[ROOT_STATE].next.end(); ++it)
+        pending.push(it->second);
+
+    while (!pending.empty())
+    {
+        const size_t state = pending.front();
+        pending.pop();
+
+        for (std::map<unsigned char, size_t>::const_iterator it = automaton[state].next.begin(); it != automaton[state].next.end(); ++it)
+        {
+            size_t fail = automaton[state].fail;
+            std::map<unsigned char, size_t>::const_iterator next = automaton[fail].next.find(it->first);
+
+            while (fail != ROOT_STATE && next == automaton[fail].next.end())
+            {
+                fail = automaton[fail].fail;
+                next = automaton[fail].next.find(it->first);
+            }
+
+            AutomatonState& child = automaton[it->second];
+            child.fail = (next == automaton[fail].next.end()) ? ROOT_STATE : next->second;
+            child.patterns.insert(child.patterns.end(),
+                                  automaton[child.fail].patterns.begin(),
+                                  automaton[child.fail].patterns.end());
+            pending.push(it->second);
+        }
+    }
+
+    automatonOutdated = false;
+}
+
+std::string PatternSet::globToRegex(const std::string& glob)
+{
+    std::string regex = "^";
+
+    for (size_t i = 0; i < glob.size(); i++)
+    {
+        const char c = glob[i];
+
+        switch (c)
+        {
+            case '*':
+                regex += ".*";
+                break;
+            case '?':
+                regex += '.';
+                break;
+            case '[':
+            {
+                const size_t close = glob.find(']', (i + 2 < glob.size() && glob[i + 1] == '!') ? i + 3 : i + 2);
+                if (close == std::string::npos)
+                {
+                    regex += "\\[";
+                }
+                else
+                {
+                    regex += '[';
+                    size_t j = i + 1;
+                    if (glob[j] == '!')
+                    {
+                        regex += '^';
+                        j++;
+                    }
+                    regex.append(glob, j, close - j);
+                    regex += ']';
+                    i = close;
+                }
+                break;
+            }
+            case '\\':
+                //the next character is literal
+                if (i + 1 < glob.size())
+                    i++;
+                if (!isalnum(static_cast<unsigned char>(glob[i])))
+                    regex += '\\';
+                regex += glob[i];
+                break;
+            case '.':
+            case '^':
+            case '$':
+            case '+':
+            case '(':
+            case ')':
+            case '{':
+            case '}':
+            case '|':
+                regex += '\\';
+                regex += c;
+                break;
+            default:
+                regex += c;
+        }
+    }
+
+    return regex + "$";
+}
+
+} // End of Namespace Searching
@@ -0,0 +1,347 @@
+/*
+    Copyright (C) 2011 Emmanuel Teisaire, Nicolás Bombau, Carlos Castro, Damián Domé, FuDePAN
+
+    This file is part of the Phyloloc project.
+
+    Phyloloc is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Phyloloc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <sstream>
+#include "phylopp/Generator/Topology.h"
+
+namespace Generator
+{
+
+static const size_t NO_LEAF = static_cast<size_t>(-1);
+
+std::string leafName(size_t leaf)
+{
+    std::stringstream name;
+    name << "t" << leaf;
+    return name.str();
+}
+
+std::string locationName(size_t location)
+{
+    std::stringstream name;
+    name << "loc" << location;
+    return name.str();
+}
+
+Topology::Topology() :
+    root(NO_NODE)
+{}
+
+void Topology::generate(TreeModel model, size_t leaves, RandomGenerator& random)
+{
+    if (leaves == 0)
+        throw InvalidGeneratorParameters("a tree needs at least one leaf");
+
+    nodes.clear();
+    nodes.reserve(2 * leaves - 1);
+
+    switch (model)
+    {
+        case YuleModel:
+            generateYule(leaves, random);
+            break;
+        case CoalescentModel:
+            generateCoalescent(leaves, random);
+            break;
+        case CaterpillarModel:
+            generateCaterpillar(leaves);
+            break;
+        case BalancedModel:
+            root = addNode(NO_LEAF, 0.0f);
+            generateBalanced(NO_NODE, 0, leaves);
+            break;
+    }
+    nodes[root].length = 0.0f;
+}
+
+bool Topology::sprMove(RandomGenerator& random)
+{
+    //with less than 3 leaves every SPR move gives back the same tree
+    const bool possible = (nodes.size() >= 5);
+    bool moved = false;
+    std::vector<NodeIndex> targets;
+
+    while (possible && !moved)
+    {
+        const NodeIndex pruned = random.nextIndex(nodes.size());
+
+        if (pruned != root)
+        {
+            collectRegraftTargets(pruned, targets);
+            if (!targets.empty())
+            {
+                regraft(pruned, targets[random.nextIndex(targets.size())]);
+                moved = true;
+            }
+        }
+    }
+    return moved;
+}
+
+size_t Topology::getNodeCount() const
+{
+    return nodes.size();
+}
+
+NodeIndex Topology::getRoot() const
+{
+    return root;
+}
+
+NodeIndex Topology::getLeft(NodeIndex node) const
+{
+    return nodes[node].left;
+}
+
+NodeIndex Topology::getRight(NodeIndex node) const
+{
+    return nodes[node].right;
+}
+
+NodeIndex Topology::getParent(NodeIndex node) const
+{
+    return nodes[node].parent;
+}
+
+bool Topology::isLeaf(NodeIndex node) const
+{
+    return nodes[node].leaf != NO_LEAF;
+}
+
+size_t Topology::getLeaf(NodeIndex node) const
+{
+    return nodes[node].leaf;
+}
+
+Domain::BranchLength Topology::getBranchLength(NodeIndex node) const
+{
+    return nodes[node].length;
+}
+
+void Topology::generateYule(size_t leaves, RandomGenerator& random)
+{
+    //birth time of every node, and the time at which leaves split
+    std::vector<double> births(1, 0.0);
+    std::vector<NodeIndex> tips(1, addNode(NO_LEAF, 0.0f));
+    double time = 0.0;
+
+    root = tips[0];
+    while (tips.size() < leaves)
+    {
+        time += random.nextExponential(static_cast<double>(tips.size()));
+
+        const size_t split = random.nextIndex(tips.size());
+        const NodeIndex parent = tips[split];
+        nodes[parent].length = static_cast<Domain::BranchLength>(time - births[parent]);
+
+        for (size_t i = 0; i < 2; i++)
+        {
+            const NodeIndex child = addNode(NO_LEAF, 0.0f);
+            attach(parent, child);
+            births.push_back(time);
+            if (i == 0)
+                tips[split] = child;
+            else
+                tips.push_back(child);
+        }
+    }
+
+    time += random.nextExponential(static_cast<double>(tips.size()));
+    for (size_t i = 0; i < tips.size(); i++)
+    {
+        nodes[tips[i]].leaf = i;
+        nodes[tips[i]].length = static_cast<Domain::BranchLength>(time - births[tips[i]]);
+    }
+}
+
+void Topology::generateCoalescent(size_t leaves, RandomGenerator& random)
+{
+    std::vector<double> heights(leaves, 0.0);
+    std::vector<NodeIndex> lineages(leaves);
+    double time = 0.0;
+
+    for (size_t i = 0; i < leaves; i++)
+        lineages[i] = addNode(i, 0.0f);
+
+    while (lineages.size() > 1)
+    {
+        const double k = static_cast<double>(lineages.size());
+        time += random.nextExponential(k * (k - 1.0) / 2.0);
+
+        const size_t first = random.nextIndex(lineages.size());
+        size_t second = random.nextIndex(lineages.size() - 1);
+        if (second >= first)
+            second++;
+
+        const NodeIndex parent = addNode(NO_LEAF, 0.0f);
+        heights.push_back(time);
+        attach(parent, lineages[first]);
+        attach(parent, lineages[second]);
+        nodes[lineages[first]].length = static_cast<Domain::BranchLength>(time - heights[lineages[first]]);
+        nodes[lineages[second]].length = static_cast<Domain::BranchLength>(time - heights[lineages[second]]);
+
+        lineages[first] = parent;
+        lineages[second] = lineages.back();
+        lineages.pop_back();
+    }
+    root = lineages[0];
+}
+
+void Topology::generateCaterpillar(size_t leaves)
+{
+    NodeIndex spine = addNode(NO_LEAF, 1.0f);
+
+    root = spine;
+    for (size_t i = 0; i + 1 < leaves; i++)
+    {
+        const NodeIndex leaf = addNode(i, 1.0f);
+        const NodeIndex next = addNode(NO_LEAF, 1.0f);
+        attach(spine, leaf);
+        attach(spine, next);
+        spine = next;
+    }
+    nodes[spine].leaf = leaves - 1;
+}
+
+void Topology::generateBalanced(NodeIndex parent, size_t first, size_t count)
+{
+    //the root is added by the caller
+    const NodeIndex node = (parent == NO_NODE) ? root : addNode(NO_LEAF, 1.0f);
+
+    if (parent != NO_NODE)
+        attach(parent, node);
+
+    if (count == 1)
+    {
+        nodes[node].leaf = first;
+    }
+    else
+    {
+        generateBalanced(node, first, count / 2);
+        generateBalanced(node, first + count / 2, count - count / 2);
+    }
+}
+
+NodeIndex Topology::addNode(size_t leaf, Domain::BranchLength length)
+{
+    TopologyNode node;
+    node.parent = NO_NODE;
+    node.left = NO_NODE;
+    node.right = NO_NODE;
+    node.leaf = leaf;
+    node.length = length;
+    nodes.push_back(node);
+    return nodes.size() - 1;
+}
+
+void Topology::attach(NodeIndex parent, NodeIndex child)
+{
+    if (nodes[parent].left == NO_NODE)
+        nodes[parent].left = child;
+    else
+        nodes[parent].right = child;
+    nodes[child].parent = parent;
+}
+
+void Topology::replaceChild(NodeIndex parent, NodeIndex child, NodeIndex replacement)
+{
+    if (nodes[parent].left == child)
+        nodes[parent].left = replacement;
+    else
+        nodes[parent].right = replacement;
+    nodes[replacement].parent = parent;
+}
+
+NodeIndex Topology::getSibling(NodeIndex node) const
+{
+    const TopologyNode& parent = nodes[nodes[node].parent];
+    return (parent.left == node) ? parent.right : parent.left;
+}
+
+void Topology::collectRegraftTargets(NodeIndex pruned, std::vector<NodeIndex>& targets) const
+{
+    std::vector<bool> excluded(nodes.size(), false);
+    std::vector<NodeIndex> pending(1, pruned);
+
+    //regrafting inside the subtree is not allowed
+    while (!pending.empty())
+    {
+        const NodeIndex node = pending.back();
+        pending.pop_back();
+        excluded[node] = true;
+        if (!isLeaf(node))
+        {
+            pending.push_back(nodes[node].left);
+            pending.push_back(nodes[node].right);
+        }
+    }
+    //and regrafting next to where it was leaves the tree unchanged
+    excluded[nodes[pruned].parent] = true;
+    excluded[getSibling(pruned)] = true;
+
+    targets.clear();
+    for (NodeIndex node = 0; node < nodes.size(); node++)
+    {
+        if (!excluded[node])
+            targets.push_back(node);
+    }
+}
+
+void Topology::regraft(NodeIndex pruned, NodeIndex target)
+{
+    //the parent of the pruned subtree is unlinked, and its sibling takes its place
+    const NodeIndex parent = nodes[pruned].parent;
+    const NodeIndex sibling = getSibling(pruned);
+    const NodeIndex grandparent = nodes[parent].parent;
+
+    if (grandparent == NO_NODE)
+    {
+        root = sibling;
+        nodes[sibling].parent = NO_NODE;
+        nodes[sibling].length = 0.0f;
+    }
+    else
+    {
+        replaceChild(grandparent, parent, sibling);
+        nodes[sibling].length += nodes[parent].length;
+    }
+
+    //then the parent splits the branch above the target in two
+    const NodeIndex above = nodes[target].parent;
+
+    if (above == NO_NODE)
+    {
+        root = parent;
+        nodes[parent].parent = NO_NODE;
+        nodes[parent].length = 0.0f;
+        nodes[target].length = nodes[pruned].length;
+    }
+    else
+    {
+        replaceChild(above, target, parent);
+        nodes[parent].length = nodes[target].length / 2.0f;
+        nodes[target].length -= nodes[parent].length;
+    }
+
+    nodes[parent].left = target;
+    nodes[parent].right = pruned;
+    nodes[target].parent = parent;
+}
+
+} // End of Namespace Generator
@@ -17,6 +17,8 @@
     along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
+#include <iostream>
 #include <mili/mili.h>
 #include "phylopp/Consensor/bitset.h"
 
@@ -97,50 +99,90 @@ bitset::bit& bitset::bit::flip()
 }
 
 
-bitset::bitset() { }
+static const size_t WORD_BITS = 64;
+static const bitset::Word ALL_ONES = ~bitset::Word(0);
 
-bitset::bitset(size_t size)
+static size_t wordsFor(size_t bits)
 {
-    resize(size);
+    return (bits + WORD_BITS - 1) / WORD_BITS;
+}
+
+static bitset::Word bitMask(size_t index)
+{
+    return bitset::Word(1) << (index % WORD_BITS);
 }
 
-bitset::bitset(const bitset& b)
+// Bits from..to of the word that holds bit index word * WORD_BITS
+static bitset::Word rangeMask(size_t word, size_t from, size_t to)
 {
-    bits.resize(b.size());
+    const size_t first = word * WORD_BITS;
+    const size_t low = (from > first) ? from - first : 0;
+    const size_t high = (to < first + WORD_BITS - 1) ? to - first : WORD_BITS - 1;
 
-    for (unsigned int i = 0; i < b.size(); i++)
-        bits[i] = b[i];
+    return (ALL_ONES >> (WORD_BITS - 1 - high)) & (ALL_ONES << low);
 }
 
+static size_t popCount(bitset::Word word)
+{
+    return static_cast<size_t>(__builtin_popcountll(word));
+}
 
-bitset& bitset::operator=(const bitset& b)
+bitset::bitset() :
+    bitCount(0)
+{ }
+
+bitset::bitset(size_t size) :
+    bitCount(0)
 {
-    bits.clear();
-    resize(b.size());
+    resize(size);
+}
 
-    for (unsigned int i = 0; i < bits.size(); i++)
-    {
-        bits[i] = b[i];
-    }
-    return *this;
+bitset::bitset(const bitset& b) :
+    words(b.words),
+    bitCount(b.bitCount)
+{
+}
 
+
+bitset& bitset::operator=(const bitset& b)
+{
+    //vector assignment keeps the capacity, so reused bitsets do not allocate
+    words.assign(b.words.begin(), b.words.end());
+    bitCount = b.bitCount;
+    return *this;
 }
 
 void bitset::resize(size_t n, const bit& v)
 {
-    bits.resize(n, v);
+    const size_t oldCount = bitCount;
+
+    words.resize(wordsFor(n), 0);
+    bitCount = n;
+
+    if (v && n > oldCount)
+        set(oldCount, n - 1);
+    else
+        clearUnusedBits();
 }
+
 void bitset::clear()
 {
-    bits.clear();
+    words.clear();
+    bitCount = 0;
+}
+
+void bitset::swap(bitset& b)
+{
+    words.swap(b.words);
+    std::swap(bitCount, b.bitCount);
 }
 
 bitset& bitset::operator&=(const bitset& b)
 {
     if (b.size() != this->size()) throw InvalidSizeException();
 
-    for (unsigned int i = 0; i < b.size(); i++)
-        bits[i] &= b[i];
+    for (size_t i = 0; i < words.size(); i++)
+        words[i] &= b.words[i];
     return *this;
 }
 
@@ -148,8 +190,8 @@ bitset& bitset::operator|=(const bitset& b)
 {
     if (b.size() != this->size()) throw InvalidSizeException();
 
-    for (unsigned int i = 0; i < b.size(); i++)
-        bits[i] |= b[i];
+    for (size_t i = 0; i < words.size(); i++)
+        words[i] |= b.words[i];
     return *this;
 }
 
@@ -157,8 +199,8 @@ bitset& bitset::operator^=(const bitset& b)
 {
     if (b.size() != this->size()) throw InvalidSizeException();
 
-    for (unsigned int i = 0; i < b.size(); i++)
-        bits[i] ^= b[i];
+    for (size_t i = 0; i < words.size(); i++)
+        words[i] ^= b.words[i];
     return *this;
 }
 
@@ -166,34 +208,59 @@ bitset& bitset::operator-=(const bitset& b)
 {
     if (b.size() != this->size()) throw InvalidSizeException();
 
-    for (unsigned int i = 0; i < b.size(); i++)
-        bits[i] -= b[i];
+    for (size_t i = 0; i < words.size(); i++)
+        words[i] &= ~b.words[i];
     return *this;
 }
 
+//moves every bit n positions towards index 0
 bitset& bitset::operator<<=(size_t n)
 {
     if (n >= this->size()) throw IndexOutOfRangeException();
 
-    for (unsigned int i = 0; i < n; i++)
+    const size_t wordShift = n / WORD_BITS;
+    const size_t bitShift = n % WORD_BITS;
+    const size_t count = words.size();
+
+    for (size_t i = 0; i < count; i++)
     {
-        bitset::bit last;
-        bits.erase(bits.begin());
-        bits.push_back(last);
+        const size_t source = i + wordShift;
+        Word word = 0;
+
+        if (source < count)
+        {
+            word = words[source] >> bitShift;
+            if (bitShift != 0 && source + 1 < count)
+                word |= words[source + 1] << (WORD_BITS - bitShift);
+        }
+        words[i] = word;
     }
     return *this;
 }
 
+//moves every bit n positions away from index 0
 bitset& bitset::operator>>=(size_t n)
 {
     if (n >= this->size()) throw IndexOutOfRangeException();
 
-    for (unsigned int i = 0; i < n; i++)
+    const size_t wordShift = n / WORD_BITS;
+    const size_t bitShift = n % WORD_BITS;
+
+    for (size_t i = words.size(); i > 0; i--)
     {
-        bitset::bit first;
-        bits.erase(bits.end());
-        bits.insert(bits.begin(), first);
+        const size_t target = i - 1;
+        Word word = 0;
+
+        if (target >= wordShift)
+        {
+            const size_t source = target - wordShift;
+            word = words[source] << bitShift;
+            if (bitShift != 0 && source > 0)
+                word |= words[source - 1] >> (WORD_BITS - bitShift);
+        }
+        words[target] = word;
     }
+    clearUnusedBits();
 
     return *this;
 }
@@ -214,20 +281,15 @@ bitset bitset::operator>>(size_t n) const
 
 bitset bitset::operator&(const bitset& b)
 {
-    if (b.size() != this->size()) throw InvalidSizeException();
-
-    bitset bs(b.size());
-    for (unsigned int i = 0; i < b.size(); ++i)
-        if (b[i] == bit::true_bit && bits[i] == bit::true_bit)
-            bs.set(i);
-
+    bitset bs(*this);
+    bs &= b;
     return bs;
 }
 
 bitset& bitset::set()
 {
-    for (unsigned int i = 0; i < this->size(); i++)
-        bits[i] = true;
+    std::fill(words.begin(), words.end(), ALL_ONES);
+    clearUnusedBits();
     return *this;
 }
 
@@ -235,7 +297,10 @@ bitset& bitset::set(size_t index, const bit& value)
 {
     if (index >= this->size()) throw IndexOutOfRangeException();
 
-    bits[index] = value;
+    if (value)
+        words[index / WORD_BITS] |= bitMask(index);
+    else
+        words[index / WORD_BITS] &= ~bitMask(index);
     return *this;
 }
 
@@ -244,9 +309,12 @@ bitset& bitset::set(size_t from, size_t to, const bit& value)
     if (from >= this->size() || to >= this->size() || from > to)
         throw IndexOutOfRangeException();
 
-    for (unsigned int i = from; i <= to; i++)
+    for (size_t i = from / WORD_BITS; i <= to / WORD_BITS; i++)
     {
-        bits[i] = value;
+        if (value)
+            words[i] |= rangeMask(i, from, to);
+        else
+            words[i] &= ~rangeMask(i, from, to);
     }
 
     return *this;
@@ -254,8 +322,7 @@ bitset& bitset::set(size_t from, size_t to, const bit& value)
 
 bitset& bitset::reset()
 {
-    for (unsigned int i = 0; i < this->size(); i++)
-        bits[i] = false;
+    std::fill(words.begin(), words.end(), Word(0));
     return *this;
 }
 
@@ -263,7 +330,7 @@ bitset& bitset::reset(size_t n)
 {
     if (n >= this->size()) throw IndexOutOfRangeException();
 
-    bits[n] = false;
+    words[n / WORD_BITS] &= ~bitMask(n);
     return *this;
 }
 
@@ -274,8 +341,9 @@ bitset& bitset::reset(size_t from, size_t to)
 
 bitset& bitset::flip()
 {
-    for (unsigned int i = 0; i < this->size(); i++)
-        bits[i] = bits[i].flip();
+    for (size_t i = 0; i < words.size(); i++)
+        words[i] = ~words[i];
+    clearUnusedBits();
     return *this;
 }
 
@@ -283,7 +351,7 @@ bitset& bitset::flip(size_t index)
 {
     if (index >= this->size()) throw IndexOutOfRangeException();
 
-    bits[index] = bits[index].flip();
+    words[index / WORD_BITS] ^= bitMask(index);
     return *this;
 }
 
@@ -292,10 +360,8 @@ bitset& bitset::flip(size_t from, size_t to)
     if (from >= this->size() || to >= this->size() || from > to)
         throw IndexOutOfRangeException();
 
-    for (unsigned int i = from; i <= to; i++)
-    {
-        bits[i] = bits[i].flip();
-    }
+    for (size_t i = from / WORD_BITS; i <= to / WORD_BITS; i++)
+        words[i] ^= rangeMask(i, from, to);
 
     return *this;
 }
@@ -303,8 +369,7 @@ bitset& bitset::flip(size_t from, size_t to)
 bitset bitset::operator~() const
 {
     bitset b(*this);
-    for (unsigned int i = 0; i < b.size(); i++)
-        b.bits[i] = ~b.bits[i];
+    b.flip();
     return b;
 }
 
@@ -312,47 +377,101 @@ const bitset::bit bitset::operator[](size_t pos)
 {
     if (pos >= this->size()) throw IndexOutOfRangeException();
 
-    return bits[pos];
+    return bit((words[pos / WORD_BITS] & bitMask(pos)) != 0);
 }
 
 bitset::bit bitset::operator[](size_t pos) const
 {
     if (pos >= this->size()) throw IndexOutOfRangeException();
 
-    return bits[pos];
+    return bit((words[pos / WORD_BITS] & bitMask(pos)) != 0);
 }
 
 size_t bitset::size() const
 {
-    return bits.size();
+    return bitCount;
 }
 
 bool bitset::empty() const
 {
-    return bits.empty();
+    return bitCount == 0;
+}
+
+size_t bitset::count() const
+{
+    size_t total = 0;
+    for (size_t i = 0; i < words.size(); i++)
+        total += popCount(words[i]);
+    return total;
+}
+
+bool bitset::isSubsetOf(const bitset& b) const
+{
+    if (b.size() != this->size()) throw InvalidSizeException();
+
+    bool subset = true;
+    for (size_t i = 0; i < words.size() && subset; i++)
+        subset = (words[i] & ~b.words[i]) == 0;
+    return subset;
+}
+
+size_t bitset::hash() const
+{
+    //FNV-1a over the words, mixed with the size
+    Word h = 14695981039346656037ULL ^ bitCount;
+    for (size_t i = 0; i < words.size(); i++)
+    {
+        h ^= words[i];
+        h *= 1099511628211ULL;
+        h ^= h >> 32;
+    }
+    return static_cast<size_t>(h);
+}
+
+size_t bitset::wordCount() const
+{
+    return words.size();
+}
+
+bitset::Word bitset::getWord(size_t index) const
+{
+    return words[index];
+}
+
+void bitset::setWord(size_t index, Word word)
+{
+    words[index] = word;
+    if (index + 1 == words.size())
+        clearUnusedBits();
 }
 
 void bitset::print()
 {
     for (unsigned int i = 0; i < size(); ++i)
-        std::cout << bits[i];
+        std::cout << (*this)[i];
     std::cout << "\n\n";
 }
 
+void bitset::clearUnusedBits()
+{
+    const size_t used = bitCount % WORD_BITS;
+    if (used != 0)
+        words.back() &= ~(ALL_ONES << used);
+}
+
 bool operator==(const bitset& a, const bitset& b)
 {
     if (a.size() != b.size()) throw InvalidSizeException();
 
     bool eq = true;
-    unsigned int i = 0;
+    size_t i = 0;
 
-    while (i < a.size() && eq == true)
+    while (i < a.wordCount() && eq)
     {
-        eq = (a[i] == b[i]);
+        eq = (a.getWord(i) == b.getWord(i));
         i++;
     }
 
-
     return eq;
 }
 
@@ -361,17 +480,25 @@ bool operator!=(const bitset& a, const bitset& b)
     return !(a == b);
 }
 
+//lexicographic order, index 0 being the most significant bit
 bool operator<(const bitset& a, const bitset& b)
 {
     if (a.size() != b.size()) throw InvalidSizeException();
 
     bool lt = false;
-    unsigned int i = 0;
+    bool found = false;
+    size_t i = 0;
 
-    while (i < a.size() && lt == false)
+    while (i < a.wordCount() && !found)
     {
-        if (a[i] != b[i])
-            return a[i] == bitset::bit::false_bit;
+        const bitset::Word difference = a.getWord(i) ^ b.getWord(i);
+        if (difference != 0)
+        {
+            //the lowest differing bit decides
+            const bitset::Word lowest = difference & (~difference + 1);
+            lt = (a.getWord(i) & lowest) == 0;
+            found = true;
+        }
         i++;
     }
 
@@ -379,4 +506,3 @@ bool operator<(const bitset& a, const bitset& b)
 }
 
 }
-
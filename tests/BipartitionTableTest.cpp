@@ -0,0 +1,190 @@
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+
+#include "phylopp/Domain/ITreeCollection.h"
+#include "phylopp/Domain/LocationAspect.h"
+#include "phylopp/Comparison/BipartitionTable.h"
+#include "phylopp/Generator/TreeGenerator.h"
+#include "phylopp/Generator/LocationGenerator.h"
+
+using namespace Comparison;
+using namespace Domain;
+using ::testing::Test;
+
+typedef Locations::LocationAspect<Node> TableNode;
+
+static const char TABLE_FILE[] = "bipartitions.bpt";
+
+static void addLeaf(TableNode* parent, const NodeName& name)
+{
+    TableNode* const leaf = parent->addChild<TableNode>();
+    leaf->setName(name);
+    leaf->setBranchLength(1);
+}
+
+// Builds ((a,b):left,(c,d):3,E), with every leaf of length 1
+static void buildTree(ITree<TableNode>* tree, const NodeName& a, const NodeName& b, BranchLength left,
+                      const NodeName& c, const NodeName& d)
+{
+    TableNode* const root = tree->getRoot();
+    TableNode* const leftChild = root->addChild<TableNode>();
+    TableNode* const rightChild = root->addChild<TableNode>();
+
+    leftChild->setBranchLength(left);
+    rightChild->setBranchLength(3);
+    addLeaf(leftChild, a);
+    addLeaf(leftChild, b);
+    addLeaf(rightChild, c);
+    addLeaf(rightChild, d);
+    addLeaf(root, "E");
+}
+
+// A split over the five taxa, given by the names of its leaves
+static Consensus::bitset split(const Locations::LocationManager& locationManager, const char* names)
+{
+    Consensus::bitset ret(locationManager.getNodeNameCount());
+    for (; *names != '\0'; names++)
+        ret.set(locationManager.getNodeNameId(NodeName(1, *names)) - 1);
+    return ret;
+}
+
+class BipartitionTableTest : public Test
+{
+protected:
+    Locations::LocationManager locationManager;
+    ITreeCollection<TableNode> trees;
+
+    virtual void SetUp()
+    {
+        const char* const names[] = { "A", "B", "C", "D", "E" };
+        for (size_t i = 0; i < 5; i++)
+            locationManager.addLocation("X", names[i]);
+
+        buildTree(trees.addTree(), "A", "B", 2, "C", "D");
+        buildTree(trees.addTree(), "A", "C", 2, "B", "D");
+        buildTree(trees.addTree(), "B", "A", 5, "D", "C");
+    }
+
+    virtual void TearDown()
+    {
+        remove(TABLE_FILE);
+    }
+
+    void expectKnownTable(const BipartitionTable& table)
+    {
+        ASSERT_EQ(3u, table.getTreeCount());
+        ASSERT_EQ(5u, table.getTaxonCount());
+        //five trivial splits and four others
+        EXPECT_EQ(9u, table.size());
+
+        const size_t ab = table.find(split(locationManager, "AB"));
+        ASSERT_NE(SPLIT_NOT_FOUND, ab);
+        EXPECT_EQ(ab, table.find(split(locationManager, "CDE")));
+        EXPECT_EQ(2u, table.getFrequency(ab));
+        EXPECT_FLOAT_EQ(3.5f, table.getMeanLength(ab));
+        EXPECT_DOUBLE_EQ(2.0 / 3.0, table.getSupport(ab));
+
+        Consensus::bitset found;
+        table.getSplit(ab, found);
+        EXPECT_TRUE(found == split(locationManager, "AB"));
+
+        const size_t e = table.find(split(locationManager, "E"));
+        ASSERT_NE(SPLIT_NOT_FOUND, e);
+        EXPECT_EQ(3u, table.getFrequency(e));
+        EXPECT_FLOAT_EQ(1.0f, table.getMeanLength(e));
+
+        const size_t ac = table.find(split(locationManager, "AC"));
+        ASSERT_NE(SPLIT_NOT_FOUND, ac);
+        EXPECT_EQ(1u, table.getFrequency(ac));
+
+        EXPECT_EQ(SPLIT_NOT_FOUND, table.find(split(locationManager, "AD")));
+    }
+};
+
+// Frequencies and mean lengths of small trees, known by hand
+TEST_F(BipartitionTableTest, BuildTest)
+{
+    BipartitionTable table;
+    table.build(trees, locationManager);
+    expectKnownTable(table);
+}
+
+// A saved table is loaded back, mapped, with the same contents
+TEST_F(BipartitionTableTest, SaveLoadTest)
+{
+    BipartitionTable table;
+    table.build(trees, locationManager);
+    table.save(TABLE_FILE);
+
+    BipartitionTable loaded;
+    loaded.load(TABLE_FILE);
+    expectKnownTable(loaded);
+
+    //loading replaces a built table too
+    table.load(TABLE_FILE);
+    expectKnownTable(table);
+}
+
+TEST_F(BipartitionTableTest, MalformedFileTest)
+{
+    BipartitionTable table;
+    EXPECT_THROW(table.load("missing.bpt"), BipartitionTableFileNotFound);
+
+    std::ofstream(TABLE_FILE) << "this is not a table";
+    EXPECT_THROW(table.load(TABLE_FILE), MalformedBipartitionTableFile);
+
+    BipartitionTable built;
+    built.build(trees, locationManager);
+    built.save(TABLE_FILE);
+    std::ofstream(TABLE_FILE, std::ios::app) << "trailing";
+    EXPECT_THROW(table.load(TABLE_FILE), MalformedBipartitionTableFile);
+}
+
+// Trees over different leaves are rejected
+TEST_F(BipartitionTableTest, DifferentLeavesTest)
+{
+    locationManager.addLocation("X", "F");
+    buildTree(trees.addTree(), "A", "B", 2, "C", "F");
+
+    BipartitionTable table;
+    EXPECT_THROW(table.build(trees, locationManager), DifferentLeafSetsException);
+}
+
+// Every split of every tree is counted once per tree
+TEST(BipartitionTableGeneratedTest, CountsTest)
+{
+    const size_t leaves = 64;
+    const size_t count = 200;
+
+    Locations::LocationManager locationManager;
+    Generator::LocationGenerator().generate(leaves, 8, locationManager);
+
+    ITreeCollection<TableNode> trees;
+    Generator::TreeGenerator<TableNode>(5).generateTrees(trees, Generator::YuleModel, leaves, count, 3);
+
+    BipartitionTable table;
+    table.build(trees, locationManager);
+    ASSERT_EQ(count, table.getTreeCount());
+
+    size_t splits = 0;
+    std::vector<Bipartition> bipartitions;
+    ITreeCollection<TableNode>::iterator it = trees.getIterator();
+    for (; !it.end(); it.next())
+    {
+        getBipartitions(it.get(), locationManager, bipartitions);
+        splits += bipartitions.size();
+        for (size_t i = 0; i < bipartitions.size(); i++)
+        {
+            const size_t index = table.find(bipartitions[i].split);
+            ASSERT_NE(SPLIT_NOT_FOUND, index);
+            EXPECT_LE(1u, table.getFrequency(index));
+        }
+    }
+
+    size_t frequencies = 0;
+    for (size_t i = 0; i < table.size(); i++)
+        frequencies += table.getFrequency(i);
+    EXPECT_EQ(splits, frequencies);
+    EXPECT_LT(table.size(), splits);
+}
@@ -0,0 +1,98 @@
+#include <string>
+#include <gtest/gtest.h>
+
+#include "phylopp/DataSource/DelimitedTextScanner.h"
+
+using namespace DataSource;
+using ::testing::Test;
+
+static DelimitedTextScanner scannerFor(const std::string& text)
+{
+    return DelimitedTextScanner(text.data(), text.data() + text.size(), ',');
+}
+
+// Lines are split in trimmed fields
+TEST(DelimitedTextScannerTest, SplitLinesTest)
+{
+    const std::string text = "a, placeA\r\n  b ,\tplaceB ,3\nc";
+    DelimitedTextScanner scanner = scannerFor(text);
+
+    ASSERT_TRUE(scanner.nextLine());
+    ASSERT_EQ(2u, scanner.fieldCount());
+    EXPECT_EQ("a", scanner.field(0).str());
+    EXPECT_EQ("placeA", scanner.field(1).str());
+
+    ASSERT_TRUE(scanner.nextLine());
+    ASSERT_EQ(3u, scanner.fieldCount());
+    EXPECT_EQ("b", scanner.field(0).str());
+    EXPECT_EQ("placeB", scanner.field(1).str());
+    EXPECT_EQ("3", scanner.field(2).str());
+
+    ASSERT_TRUE(scanner.nextLine());
+    ASSERT_EQ(1u, scanner.fieldCount());
+    EXPECT_EQ("c", scanner.field(0).str());
+    EXPECT_EQ(3u, scanner.lineNumber());
+
+    EXPECT_FALSE(scanner.nextLine());
+}
+
+// Empty lines have one empty field, and the trailing newline adds no line
+TEST(DelimitedTextScannerTest, EmptyLinesTest)
+{
+    const std::string text = "a,b\n\n";
+    DelimitedTextScanner scanner = scannerFor(text);
+
+    ASSERT_TRUE(scanner.nextLine());
+    ASSERT_TRUE(scanner.nextLine());
+    ASSERT_EQ(1u, scanner.fieldCount());
+    EXPECT_TRUE(scanner.field(0).empty());
+    EXPECT_FALSE(scanner.nextLine());
+
+    DelimitedTextScanner empty = scannerFor("");
+    EXPECT_FALSE(empty.nextLine());
+}
+
+// Lines with more fields than stored are still counted
+TEST(DelimitedTextScannerTest, ManyFieldsTest)
+{
+    const std::string text = "1,2,3,4,5,6,7,8,9,10";
+    DelimitedTextScanner scanner = scannerFor(text);
+
+    ASSERT_TRUE(scanner.nextLine());
+    EXPECT_EQ(10u, scanner.fieldCount());
+    EXPECT_EQ("8", scanner.field(7).str());
+}
+
+TEST(DelimitedTextScannerTest, ParseFloatTest)
+{
+    const std::string text = "45.0,-0.25,1e3,2.5E-2,.5,000.125,12345678901234567890";
+    DelimitedTextScanner scanner = scannerFor(text);
+    ASSERT_TRUE(scanner.nextLine());
+
+    float value;
+    ASSERT_TRUE(parseFloat(scanner.field(0), value));
+    EXPECT_FLOAT_EQ(45.0f, value);
+    ASSERT_TRUE(parseFloat(scanner.field(1), value));
+    EXPECT_FLOAT_EQ(-0.25f, value);
+    ASSERT_TRUE(parseFloat(scanner.field(2), value));
+    EXPECT_FLOAT_EQ(1000.0f, value);
+    ASSERT_TRUE(parseFloat(scanner.field(3), value));
+    EXPECT_FLOAT_EQ(0.025f, value);
+    ASSERT_TRUE(parseFloat(scanner.field(4), value));
+    EXPECT_FLOAT_EQ(0.5f, value);
+    ASSERT_TRUE(parseFloat(scanner.field(5), value));
+    EXPECT_FLOAT_EQ(0.125f, value);
+    ASSERT_TRUE(parseFloat(scanner.field(6), value));
+    EXPECT_FLOAT_EQ(12345678901234567890.0f, value);
+}
+
+TEST(DelimitedTextScannerTest, ParseMalformedFloatTest)
+{
+    const std::string text = "....,,1.0x,e5,-,1e,1 2";
+    DelimitedTextScanner scanner = scannerFor(text);
+    ASSERT_TRUE(scanner.nextLine());
+
+    float value;
+    for (size_t i = 0; i < scanner.fieldCount(); ++i)
+        EXPECT_FALSE(parseFloat(scanner.field(i), value)) << scanner.field(i).str();
+}
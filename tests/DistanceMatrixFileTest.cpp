@@ -0,0 +1,143 @@
+#include <stddef.h>
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+
+#include "phylopp/Domain/LocationManager.h"
+#include "phylopp/DataSource/DistanceMatrixParser.h"
+#include "phylopp/DataSource/DistanceMatrixWriter.h"
+
+using namespace Locations;
+using ::testing::Test;
+
+static void addLocations(LocationManager& locationManager, bool reversed)
+{
+    const char* const names[] = { "placeA", "placeB", "placeC" };
+
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        const unsigned int index = reversed ? 2 - i : i;
+        locationManager.addLocation(names[index], names[index]);
+    }
+}
+
+static void addDistances(LocationManager& locationManager)
+{
+    locationManager.addDistance(1.5f, "placeA", "placeB");
+    locationManager.addDistance(2.0f, "placeA", "placeC");
+    locationManager.addDistance(3.0f, "placeB", "placeA");
+    locationManager.addDistance(4.25f, "placeB", "placeC");
+    locationManager.addDistance(5.0f, "placeC", "placeA");
+    locationManager.addDistance(6.0f, "placeC", "placeB");
+}
+
+static void expectSameDistances(const LocationManager& expected, const LocationManager& actual)
+{
+    const char* const names[] = { "placeA", "placeB", "placeC" };
+
+    for (unsigned int i = 0; i < 3; i++)
+        for (unsigned int j = 0; j < 3; j++)
+            EXPECT_EQ(expected.distance(expected.getLocationId(names[i]), expected.getLocationId(names[j])),
+                      actual.distance(actual.getLocationId(names[i]), actual.getLocationId(names[j])));
+}
+
+// Removes the files written by the tests
+class DistanceMatrixFileTest : public Test
+{
+protected:
+    virtual void TearDown()
+    {
+        std::remove("distances.dm");
+        std::remove("distances.dm.gz");
+        std::remove("truncated.dm");
+        std::remove("wrongcount.dm");
+    }
+};
+
+// Saved matrices are loaded back with the same distances
+TEST_F(DistanceMatrixFileTest, SaveAndLoadTest)
+{
+    LocationManager original;
+    addLocations(original, false);
+    addDistances(original);
+
+    DistanceMatrixWriter writer;
+    writer.saveDistanceMatrixFile("distances.dm", original);
+    EXPECT_TRUE(DistanceMatrixParser::isDistanceMatrixFile("distances.dm"));
+
+    LocationManager loaded;
+    addLocations(loaded, false);
+    DistanceMatrixParser parser;
+    parser.loadDistanceMatrixFile("distances.dm", loaded);
+
+    expectSameDistances(original, loaded);
+    EXPECT_TRUE(loaded.isValid());
+}
+
+// Locations are matched by name, whatever ids they have
+TEST_F(DistanceMatrixFileTest, LoadReorderedLocationsTest)
+{
+    LocationManager original;
+    addLocations(original, false);
+    addDistances(original);
+
+    DistanceMatrixWriter writer;
+    writer.saveDistanceMatrixFile("distances.dm.gz", original);
+
+    LocationManager loaded;
+    addLocations(loaded, true);
+    DistanceMatrixParser parser;
+    parser.loadDistanceMatrixFile("distances.dm.gz", loaded);
+
+    expectSameDistances(original, loaded);
+}
+
+TEST_F(DistanceMatrixFileTest, LoadUnknownLocationTest)
+{
+    LocationManager original;
+    addLocations(original, false);
+    addDistances(original);
+
+    DistanceMatrixWriter writer;
+    writer.saveDistanceMatrixFile("distances.dm", original);
+
+    LocationManager loaded;
+    loaded.addLocation("placeA", "placeA");
+    DistanceMatrixParser parser;
+    ASSERT_THROW(parser.loadDistanceMatrixFile("distances.dm", loaded), InvalidLocation);
+}
+
+TEST_F(DistanceMatrixFileTest, LoadMalformedTest)
+{
+    LocationManager locationManager;
+    DistanceMatrixParser parser;
+
+    EXPECT_FALSE(DistanceMatrixParser::isDistanceMatrixFile("./ref/distances3.dist"));
+    ASSERT_THROW(parser.loadDistanceMatrixFile("./ref/distances3.dist", locationManager), MalformedDistanceMatrixFile);
+    ASSERT_THROW(parser.loadDistanceMatrixFile("./ref/missing.dm", locationManager), DistanceMatrixFileNotFound);
+
+    std::ofstream truncated("truncated.dm");
+    truncated.write(DataSource::DistanceMatrixFormat::MAGIC, DataSource::DistanceMatrixFormat::MAGIC_SIZE);
+    truncated.close();
+    ASSERT_THROW(parser.loadDistanceMatrixFile("truncated.dm", locationManager), MalformedDistanceMatrixFile);
+}
+
+// Huge location counts are rejected before anything is allocated for them
+TEST_F(DistanceMatrixFileTest, LoadWrongCountTest)
+{
+    LocationManager locationManager;
+    DistanceMatrixParser parser;
+    const uint32_t header[] =
+    {
+        DataSource::DistanceMatrixFormat::BYTE_ORDER_MARK,
+        DataSource::DistanceMatrixFormat::VERSION,
+        0xFFFFFFFF
+    };
+
+    std::ofstream wrongCount("wrongcount.dm");
+    wrongCount.write(DataSource::DistanceMatrixFormat::MAGIC, DataSource::DistanceMatrixFormat::MAGIC_SIZE);
+    wrongCount.write(reinterpret_cast<const char*>(header), sizeof(header));
+    wrongCount.write(reinterpret_cast<const char*>(header), sizeof(header));
+    wrongCount.close();
+    ASSERT_THROW(parser.loadDistanceMatrixFile("wrongcount.dm", locationManager), MalformedDistanceMatrixFile);
+}
@@ -0,0 +1,74 @@
+#include <vector>
+#include <stdint.h>
+#include <gtest/gtest.h>
+
+#include "phylopp/Domain/DistanceMatrix.h"
+
+using namespace Locations;
+using ::testing::Test;
+
+// Growing keeps the distances and fills new cells with zero
+TEST(DistanceMatrixTest, ResizeTest)
+{
+    DistanceMatrix matrix;
+    EXPECT_TRUE(matrix.empty());
+
+    matrix.resize(2);
+    matrix(0, 1) = 1.0f;
+    matrix(1, 0) = 2.0f;
+
+    matrix.resize(100);
+    EXPECT_EQ(100u, matrix.size());
+    EXPECT_LE(100u, matrix.stride());
+    EXPECT_EQ(1.0f, matrix(0, 1));
+    EXPECT_EQ(2.0f, matrix(1, 0));
+
+    for (size_t i = 0; i < matrix.size(); i++)
+    {
+        for (size_t j = 0; j < matrix.size(); j++)
+        {
+            if (i + j != 1)
+            {
+                EXPECT_EQ(0.0f, matrix(i, j));
+            }
+        }
+    }
+}
+
+// Every row starts on a cache line
+TEST(DistanceMatrixTest, AlignmentTest)
+{
+    DistanceMatrix matrix;
+    matrix.resize(7);
+
+    EXPECT_EQ(0u, matrix.stride() * sizeof(Distance) % DistanceMatrix::ROW_ALIGNMENT);
+    for (size_t i = 0; i < matrix.size(); i++)
+        EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(matrix.row(i)) % DistanceMatrix::ROW_ALIGNMENT);
+}
+
+TEST(DistanceMatrixTest, CopyTest)
+{
+    DistanceMatrix matrix;
+    matrix.resize(3);
+    matrix(2, 1) = 5.0f;
+
+    DistanceMatrix copy(matrix);
+    matrix(2, 1) = 6.0f;
+
+    EXPECT_EQ(3u, copy.size());
+    EXPECT_EQ(5.0f, copy(2, 1));
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(copy.row(1)) % DistanceMatrix::ROW_ALIGNMENT);
+
+    copy.clear();
+    EXPECT_TRUE(copy.empty());
+    EXPECT_EQ(6.0f, matrix(2, 1));
+}
+
+TEST(DistanceMatrixTest, PairwiseSumTest)
+{
+    std::vector<Distance> values(100003, 0.1f);
+
+    EXPECT_EQ(0.0f, pairwiseSum(NULL, 0));
+    EXPECT_FLOAT_EQ(0.3f, pairwiseSum(&values[0], 3));
+    EXPECT_NEAR(10000.3, pairwiseSum(&values[0], values.size()), 0.01);
+}
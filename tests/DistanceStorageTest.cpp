@@ -0,0 +1,190 @@
+#include <sstream>
+#include <gtest/gtest.h>
+
+#include "phylopp/Domain/LocationManager.h"
+#include "phylopp/DataSource/LocationsParser.h"
+#include "phylopp/DataSource/DistancesParser.h"
+
+using namespace Locations;
+using ::testing::Test;
+
+static void addLocations(LocationManager& locationManager)
+{
+    locationManager.addLocation("Bs As", "B");
+    locationManager.addLocation("Santa Fe", "S");
+    locationManager.addLocation("Cordoba", "C");
+}
+
+// Symmetric storage answers both directions with a single distance
+TEST(DistanceStorageTest, SymmetricTest)
+{
+    LocationManager locationManager;
+    locationManager.setDistanceStorage(SymmetricStorage);
+    addLocations(locationManager);
+
+    locationManager.addDistance(10, "Bs As", "Santa Fe");
+    locationManager.addDistance(20, "Cordoba", "Bs As");
+    EXPECT_FALSE(locationManager.isValid());
+
+    locationManager.addDistance(30, "Santa Fe", "Cordoba");
+    EXPECT_TRUE(locationManager.isValid());
+
+    const LocationId b = locationManager.getLocationId("Bs As");
+    const LocationId s = locationManager.getLocationId("Santa Fe");
+    const LocationId c = locationManager.getLocationId("Cordoba");
+    EXPECT_EQ(10, locationManager.distance(s, b));
+    EXPECT_EQ(20, locationManager.distance(b, c));
+    EXPECT_EQ(30, locationManager.distance(c, s));
+    EXPECT_EQ(0, locationManager.distance(c, c));
+
+    const DistanceVector& dispersion = locationManager.getDispersionVector();
+    EXPECT_FLOAT_EQ(1.0f - 30.0f / 120.0f, dispersion[b - 1]);
+    EXPECT_FLOAT_EQ(1.0f - 40.0f / 120.0f, dispersion[s - 1]);
+    EXPECT_FLOAT_EQ(1.0f - 50.0f / 120.0f, dispersion[c - 1]);
+}
+
+// Sparse storage answers the default distance for missing pairs
+TEST(DistanceStorageTest, SparseTest)
+{
+    LocationManager locationManager;
+    locationManager.setDistanceStorage(SparseStorage, 100);
+    addLocations(locationManager);
+
+    locationManager.addDistance(10, "Bs As", "Santa Fe");
+    locationManager.addDistance(5, "Bs As", "Santa Fe");
+    EXPECT_TRUE(locationManager.isValid());
+
+    const LocationId b = locationManager.getLocationId("Bs As");
+    const LocationId s = locationManager.getLocationId("Santa Fe");
+    const LocationId c = locationManager.getLocationId("Cordoba");
+    EXPECT_EQ(5, locationManager.distance(b, s));
+    EXPECT_EQ(100, locationManager.distance(s, b));
+    EXPECT_EQ(100, locationManager.distance(b, c));
+    EXPECT_EQ(0, locationManager.distance(c, c));
+
+    const DistanceVector& dispersion = locationManager.getDispersionVector();
+    EXPECT_FLOAT_EQ(1.0f - 105.0f / 505.0f, dispersion[b - 1]);
+    EXPECT_FLOAT_EQ(1.0f - 200.0f / 505.0f, dispersion[c - 1]);
+
+    locationManager.addDistance(0, "Cordoba", "Bs As");
+    EXPECT_FALSE(locationManager.isValid());
+}
+
+// Sparse lookups do not modify the storage, so they may run in threads
+TEST(DistanceStorageTest, SparseReadOnlyTest)
+{
+    LocationManager locationManager;
+    locationManager.setDistanceStorage(SparseStorage, 100);
+    addLocations(locationManager);
+
+    const LocationId b = locationManager.getLocationId("Bs As");
+    const LocationId s = locationManager.getLocationId("Santa Fe");
+    locationManager.addDistance(10, "Bs As", "Santa Fe");
+    locationManager.addDistance(20, "Santa Fe", "Bs As");
+    locationManager.addDistance(5, "Bs As", "Santa Fe");
+
+    const size_t buffered = locationManager.getDistancesBytes();
+    EXPECT_EQ(5, locationManager.distance(b, s));
+    EXPECT_EQ(20, locationManager.distance(s, b));
+    EXPECT_EQ(buffered, locationManager.getDistancesBytes());
+
+    locationManager.compactDistances();
+    const size_t compacted = locationManager.getDistancesBytes();
+    EXPECT_EQ(5, locationManager.distance(b, s));
+    EXPECT_EQ(20, locationManager.distance(s, b));
+    EXPECT_EQ(100, locationManager.distance(s, locationManager.getLocationId("Cordoba")));
+    EXPECT_EQ(compacted, locationManager.getDistancesBytes());
+}
+
+// Without a default distance every pair must be given
+TEST(DistanceStorageTest, SparseWithoutDefaultTest)
+{
+    LocationManager locationManager;
+    locationManager.setDistanceStorage(SparseStorage);
+    addLocations(locationManager);
+
+    locationManager.addDistance(10, "Bs As", "Santa Fe");
+    EXPECT_FALSE(locationManager.isValid());
+    EXPECT_EQ(0, locationManager.distance(locationManager.getLocationId("Santa Fe"),
+                                          locationManager.getLocationId("Cordoba")));
+}
+
+// Distances already added survive a change of storage
+TEST(DistanceStorageTest, ConvertTest)
+{
+    LocationManager locationManager;
+    addLocations(locationManager);
+    locationManager.addDistance(10, "Bs As", "Santa Fe");
+    locationManager.addDistance(20, "Cordoba", "Bs As");
+
+    locationManager.setDistanceStorage(SparseStorage, 50);
+    EXPECT_EQ(SparseStorage, locationManager.getDistanceStorage());
+
+    const LocationId b = locationManager.getLocationId("Bs As");
+    const LocationId s = locationManager.getLocationId("Santa Fe");
+    const LocationId c = locationManager.getLocationId("Cordoba");
+    EXPECT_EQ(10, locationManager.distance(b, s));
+    EXPECT_EQ(20, locationManager.distance(c, b));
+    EXPECT_EQ(0, locationManager.distance(b, c));
+    EXPECT_EQ(0, locationManager.distance(c, s));
+
+    locationManager.setDistanceStorage(DenseStorage);
+    EXPECT_EQ(10, locationManager.distance(b, s));
+    EXPECT_EQ(0, locationManager.distance(b, c));
+    EXPECT_EQ(locationManager.getDistanceMatrix().size(), 3u);
+}
+
+// DistancesParser chooses the storage of the loaded distances
+TEST(DistanceStorageTest, LoadTest)
+{
+    const DistanceStorage storages[] = { DenseStorage, SymmetricStorage, SparseStorage };
+
+    for (size_t i = 0; i < sizeof(storages) / sizeof(storages[0]); i++)
+    {
+        LocationManager locationManager;
+        LocationsParser locationsParser;
+        locationsParser.loadLocationsFile("ref/locations3.dat", locationManager);
+
+        DistancesParser distancesParser(storages[i], 1);
+        distancesParser.loadDistancesFile("ref/distances3.dist", locationManager);
+
+        EXPECT_EQ(storages[i], locationManager.getDistanceStorage());
+        EXPECT_EQ(40, locationManager.distance(locationManager.getLocationId("placeA"),
+                                               locationManager.getLocationId("placeB")));
+    }
+}
+
+// Symmetric and sparse data use less memory than a dense matrix
+TEST(DistanceStorageTest, MemoryTest)
+{
+    const size_t count = 200;
+    LocationManager dense;
+    LocationManager symmetric;
+    LocationManager sparse;
+    symmetric.setDistanceStorage(SymmetricStorage);
+    sparse.setDistanceStorage(SparseStorage, 1000);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        std::stringstream name;
+        name << i;
+        dense.addLocation(name.str(), name.str());
+        symmetric.addLocation(name.str(), name.str());
+        sparse.addLocation(name.str(), name.str());
+    }
+
+    for (size_t i = 1; i < count; i++)
+    {
+        std::stringstream from;
+        std::stringstream to;
+        from << i - 1;
+        to << i;
+        dense.addDistance(1, from.str(), to.str());
+        symmetric.addDistance(1, from.str(), to.str());
+        sparse.addDistance(1, from.str(), to.str());
+    }
+    sparse.getDispersionVector();
+
+    EXPECT_LT(symmetric.getDistancesBytes(), dense.getDistancesBytes() * 3 / 5);
+    EXPECT_LT(sparse.getDistancesBytes(), dense.getDistancesBytes() / 20);
+}
@@ -20,6 +20,8 @@
 #ifndef DUMMY_OBSERVER_H
 #define DUMMY_OBSERVER_H
 
+#include "phylopp/Consensor/ObserverTraits.h"
+
 template <class Node>
 class DummyObserver //: public Consensus::IConsensorObserver<Node>
 {
@@ -32,8 +34,18 @@ public:
     {}
     void onExclude(Node* /*node*/, const Consensus::bitset& /*cluster*/)
     {}
-    void onEnd(Domain::ITree<Node>& /*consensed*/)
+    void onEnd(Domain::ITree<Node>* /*consensed*/)
     {}
 };
 
+namespace Consensus
+{
+// Takes the fast path: no per cluster calls
+template <class Node>
+struct ObserverTraits<DummyObserver<Node> > : DefaultObserverTraits
+{
+    static const bool wants_cluster_events = false;
+};
+}
+
 #endif
@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <sstream>
 #include <stddef.h>
 #include <gtest/gtest.h>
 
@@ -260,7 +262,7 @@ protected:
     static void assertTreeCollectionsEquals(
         const ITreeCollection<TestNode>& expectedTrees,
         const ITreeCollection<TestNode>& actualTrees,
-        const Locations::LocationManager locationManager)
+        const Locations::LocationManager& locationManager)
     {
 
         ITreeCollection<TestNode>::iterator iterExpected = expectedTrees.getIterator();
@@ -276,7 +278,7 @@ protected:
         }
     }
 
-    static void assertLocationsEquals(const ITreeCollection<TestNode>& actualTrees, const Locations::LocationManager locationManager, LocationsMap& expectedLocationsMap)
+    static void assertLocationsEquals(const ITreeCollection<TestNode>& actualTrees, const Locations::LocationManager& locationManager, LocationsMap& expectedLocationsMap)
     {
         ITreeCollection<TestNode>::iterator treesIterator = actualTrees.getIterator();
 
@@ -297,7 +299,7 @@ protected:
 
 private:
 
-    static void assertNodeLocationsEquals(const TestNode* actualNode, const Locations::LocationManager locationManager, LocationsMap& expectedLocationsMap)
+    static void assertNodeLocationsEquals(const TestNode* actualNode, const Locations::LocationManager& locationManager, LocationsMap& expectedLocationsMap)
     {
         ASSERT_EQ(expectedLocationsMap[actualNode->getName()], locationManager.getLocation(actualNode->getName()));
 
@@ -309,7 +311,7 @@ private:
         }
     }
 
-    static void assertNodesEquals(const TestNode* expectedNode, const TestNode* actualNode, const Locations::LocationManager locationManager)
+    static void assertNodesEquals(const TestNode* expectedNode, const TestNode* actualNode, const Locations::LocationManager& locationManager)
     {
 
         ASSERT_EQ(expectedNode->getName(), actualNode->getName());
@@ -331,7 +333,7 @@ private:
         }
     }
 
-    static void assertTreesEquals(const ITree<TestNode>* expectedTree, const ITree<TestNode>* actualTree, const Locations::LocationManager locationManager)
+    static void assertTreesEquals(const ITree<TestNode>* expectedTree, const ITree<TestNode>* actualTree, const Locations::LocationManager& locationManager)
     {
         assertNodesEquals(expectedTree->getRoot(), actualTree->getRoot(), locationManager);
     }
@@ -572,6 +574,117 @@ TEST_F(FileDataSourceTest, saveTest2)
     EXPECT_EQ(expected_str, tree_str);
 }
 
+// Branch lengths are written with the shortest round-trip digits, or the requested precision
+TEST_F(FileDataSourceTest, savePrecisionTest)
+{
+    Locations::LocationManager locationManager;
+
+    ITreeCollection<TestNode> trees;
+    TestNode* root = trees.addTree()->getRoot();
+    setNodeAttrs(root->addChild<TestNode>(), "A", 0.123456789f, "", locationManager);
+    setNodeAttrs(root->addChild<TestNode>(), "B", 12.5f, "", locationManager);
+
+    std::stringstream shortest;
+    NewickWriter<TestNode> writer;
+    writer.saveNewickStream(shortest, trees);
+    EXPECT_EQ("(A:0.12345679,B:12.5):0;\n", shortest.str());
+
+    std::stringstream fixed;
+    writer.setPrecision(2);
+    writer.saveNewickStream(fixed, trees);
+    EXPECT_EQ("(A:0.12,B:12):0;\n", fixed.str());
+}
+
+// Deep trees are written without recursion
+TEST_F(FileDataSourceTest, saveDeepTreeTest)
+{
+    const unsigned int depth = 5000;
+    Locations::LocationManager locationManager;
+
+    ITreeCollection<TestNode> trees;
+    TestNode* node = trees.addTree()->getRoot();
+    for (unsigned int i = 0; i < depth; ++i)
+    {
+        node->addChild<TestNode>()->setName("L");
+        node = node->addChild<TestNode>();
+    }
+
+    std::stringstream os;
+    NewickWriter<TestNode> writer;
+    writer.saveNewickStream(os, trees);
+
+    const std::string output = os.str();
+    EXPECT_EQ(depth, static_cast<unsigned int>(std::count(output.begin(), output.end(), '(')));
+    EXPECT_EQ(depth, static_cast<unsigned int>(std::count(output.begin(), output.end(), ')')));
+    EXPECT_EQ("(L:0,(L:0,", output.substr(0, 10));
+}
+
+// Compressed trees, locations and distances are read transparently
+TEST_F(FileDataSourceTest, loadCompressedTest)
+{
+    Locations::LocationManager locationManager;
+
+    ITreeCollection<TestNode> myTrees;
+    loadTree6(myTrees.addTree(), locationManager);
+
+    ITreeCollection<TestNode> trees;
+    loadTreeFromFile("tree6.nwk.gz", "trees.dat", "distances2.dist", trees, locationManager);
+
+    assertTreeCollectionsEquals(myTrees, trees, locationManager);
+}
+
+TEST_F(FileDataSourceTest, loadCompressedLocationsTest)
+{
+    Locations::LocationManager locationManager;
+
+    ITreeCollection<TestNode> trees;
+    loadTreeFromFile("fullTree.nwk.gz", "locations3.dat.gz", "distances3.dist.gz", trees, locationManager);
+
+    LocationsMap map;
+    map["a"] = "placeA";
+    map["b"] = "placeB";
+    map["c"] = "placeC";
+    map["d"] = "placeD";
+    map["e"] = "placeE";
+    map["f"] = "placeF";
+
+    assertLocationsEquals(trees, locationManager, map);
+
+    ListIterator<TestNode, Domain::Node> it = trees.elementAt(0)->getRoot()->getChildrenIterator<TestNode>();
+    const TestNode* a = it.get();
+    it.next();
+    EXPECT_EQ(40, locationManager.distance(a, it.get()));
+}
+
+// Try to load a truncated compressed file
+TEST_F(FileDataSourceTest, loadTruncatedCompressedTree)
+{
+    Locations::LocationManager locationManager;
+    ITreeCollection<TestNode> trees;
+
+    ASSERT_THROW(loadTreeFromFile("truncated.nwk.gz", "trees.dat", "distances2.dist", trees, locationManager), CorruptedCompressedFile);
+
+    assertConsistency(trees, locationManager);
+}
+
+// Files named *.gz are saved compressed
+TEST_F(FileDataSourceTest, saveCompressedTest)
+{
+    Locations::LocationManager locationManager;
+
+    ITreeCollection<TestNode> trees;
+    loadTree7(trees.addTree(), locationManager);
+
+    saveTreeToFile("outTree.nwk.gz", trees);
+
+    DataSource::InputFileStream f("outTree.nwk.gz");
+    EXPECT_EQ(GzipCompression, f.getCompression());
+
+    std::string line;
+    getline(f, line);
+    EXPECT_EQ("(A:0.1,B:0.2,(C:0.3,D:0.4)E:0.5)F:0;", line);
+}
+
 // Empty file. Tree with no places loaded.
 TEST_F(FileDataSourceTest, loadLocations1)
 {
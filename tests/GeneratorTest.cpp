@@ -0,0 +1,237 @@
+#include <cstdio>
+#include <set>
+#include <sstream>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "phylopp/Domain/ITreeCollection.h"
+#include "phylopp/Domain/LocationAspect.h"
+#include "phylopp/DataSource/NewickParser.h"
+#include "phylopp/DataSource/NewickWriter.h"
+#include "phylopp/DataSource/LocationsParser.h"
+#include "phylopp/DataSource/DistancesParser.h"
+#include "phylopp/Generator/TreeGenerator.h"
+#include "phylopp/Generator/LocationGenerator.h"
+
+using namespace Domain;
+using namespace Generator;
+using ::testing::Test;
+
+typedef Locations::LocationAspect<Node> GeneratedNode;
+
+static std::string toNewick(const ITree<Node>* tree)
+{
+    std::stringstream ss;
+    NewickWriter<Node> writer;
+    writer.saveNewickTree(ss, tree);
+    return ss.str();
+}
+
+static std::string generateNewick(Seed seed, TreeModel model, size_t leaves, size_t sprMoves)
+{
+    ITreeCollection<Node> trees;
+    TreeGenerator<Node> generator(seed);
+    generator.generateTree(trees.addTree(), model, leaves, sprMoves);
+    return toNewick(trees.elementAt(0));
+}
+
+static size_t depth(const Node* node)
+{
+    size_t ret = 0;
+    for (; !node->isRoot(); node = node->getParent<Node>())
+        ret++;
+    return ret;
+}
+
+// Checks that the tree is binary, with leaves t0 .. t(leaves - 1)
+static void expectBinaryTree(ITree<Node>* tree, size_t leaves)
+{
+    std::vector<const Node*> tips;
+    tree->getLeaves(tips);
+    ASSERT_EQ(leaves, tips.size());
+
+    std::set<std::string> names;
+    for (size_t i = 0; i < tips.size(); i++)
+        names.insert(tips[i]->getName());
+    EXPECT_EQ(leaves, names.size());
+    EXPECT_EQ(1u, names.count(leafName(0)));
+    EXPECT_EQ(1u, names.count(leafName(leaves - 1)));
+
+    std::vector<const Node*> pending(1, tree->getRoot());
+    while (!pending.empty())
+    {
+        const Node* const node = pending.back();
+        pending.pop_back();
+        if (!node->isLeaf())
+        {
+            ListIterator<Node, Node> it = node->getChildrenIterator<Node>();
+            EXPECT_EQ(2u, it.count());
+            for (; !it.end(); it.next())
+                pending.push_back(it.get());
+        }
+    }
+}
+
+// The same seed always gives the same tree
+TEST(GeneratorTest, DeterministicTest)
+{
+    EXPECT_EQ(generateNewick(7, YuleModel, 50, 3), generateNewick(7, YuleModel, 50, 3));
+    EXPECT_EQ(generateNewick(7, CoalescentModel, 50, 0), generateNewick(7, CoalescentModel, 50, 0));
+    EXPECT_NE(generateNewick(7, YuleModel, 50, 0), generateNewick(8, YuleModel, 50, 0));
+}
+
+TEST(GeneratorTest, ModelsTest)
+{
+    const TreeModel models[] = {YuleModel, CoalescentModel, CaterpillarModel, BalancedModel};
+
+    for (size_t i = 0; i < 4; i++)
+    {
+        ITreeCollection<Node> trees;
+        TreeGenerator<Node> generator;
+        generator.generateTree(trees.addTree(), models[i], 64);
+        expectBinaryTree(trees.elementAt(0), 64);
+    }
+
+    ITreeCollection<Node> trees;
+    TreeGenerator<Node> generator;
+    generator.generateTree(trees.addTree(), CaterpillarModel, 64);
+    generator.generateTree(trees.addTree(), BalancedModel, 64);
+
+    std::vector<const Node*> caterpillar;
+    trees.elementAt(0)->getLeaves(caterpillar);
+    EXPECT_EQ(63u, depth(caterpillar.back()));
+
+    std::vector<const Node*> balanced;
+    trees.elementAt(1)->getLeaves(balanced);
+    for (size_t i = 0; i < balanced.size(); i++)
+        EXPECT_EQ(6u, depth(balanced[i]));
+
+    EXPECT_EQ("(t0:1,t1:1):1", toNewick(trees.elementAt(1)).substr(5, 13));
+}
+
+TEST(GeneratorTest, SingleLeafTest)
+{
+    ITreeCollection<Node> trees;
+    TreeGenerator<Node> generator;
+    generator.generateTree(trees.addTree(), YuleModel, 1, 5);
+    EXPECT_EQ("t0:0;\n", toNewick(trees.elementAt(0)));
+
+    EXPECT_THROW(generator.generateTree(trees.addTree(), YuleModel, 0), InvalidGeneratorParameters);
+}
+
+// SPR moves change the topology and keep the leaves
+TEST(GeneratorTest, SprMoveTest)
+{
+    RandomGenerator random;
+    Topology original;
+    original.generate(BalancedModel, 16, random);
+
+    for (size_t move = 0; move < 20; move++)
+    {
+        Topology moved(original);
+        ASSERT_TRUE(moved.sprMove(random));
+        EXPECT_EQ(original.getNodeCount(), moved.getNodeCount());
+        EXPECT_EQ(NO_NODE, moved.getParent(moved.getRoot()));
+
+        ITreeCollection<Node> trees;
+        TreeGenerator<Node> generator;
+        generator.generateTree(trees.addTree(), BalancedModel, 16, move + 1);
+        expectBinaryTree(trees.elementAt(0), 16);
+    }
+
+    EXPECT_NE(generateNewick(1, CaterpillarModel, 16, 0), generateNewick(1, CaterpillarModel, 16, 1));
+
+    Topology tiny;
+    tiny.generate(YuleModel, 2, random);
+    EXPECT_FALSE(tiny.sprMove(random));
+}
+
+// Replicates come from the same tree, each one perturbed differently
+TEST(GeneratorTest, ReplicatesTest)
+{
+    ITreeCollection<Node> trees;
+    TreeGenerator<Node> generator;
+    generator.generateTrees(trees, YuleModel, 32, 3);
+    ASSERT_EQ(3u, trees.getIterator().count());
+    EXPECT_EQ(toNewick(trees.elementAt(0)), toNewick(trees.elementAt(2)));
+
+    trees.clear();
+    generator.generateTrees(trees, YuleModel, 32, 3, 2);
+    ASSERT_EQ(3u, trees.getIterator().count());
+    for (size_t i = 0; i < 3; i++)
+        expectBinaryTree(trees.elementAt(i), 32);
+    EXPECT_NE(toNewick(trees.elementAt(0)), toNewick(trees.elementAt(1)));
+}
+
+// Leaves get the location ids of their names when a manager is given
+TEST(GeneratorTest, LocationIdsTest)
+{
+    Locations::LocationManager locationManager;
+    LocationGenerator().generate(32, 4, locationManager);
+
+    ITree<GeneratedNode> unresolved;
+    TreeGenerator<GeneratedNode>(5).generateTree(&unresolved, YuleModel, 32);
+    ITree<GeneratedNode> resolved;
+    TreeGenerator<GeneratedNode>(locationManager, 5).generateTree(&resolved, YuleModel, 32);
+
+    std::vector<const GeneratedNode*> unresolvedLeaves;
+    unresolved.getLeaves(unresolvedLeaves);
+    std::vector<const GeneratedNode*> leaves;
+    resolved.getLeaves(leaves);
+    ASSERT_EQ(32u, leaves.size());
+
+    EXPECT_EQ(Locations::LOCATION_NOT_FOUND, unresolvedLeaves[0]->getLocationId());
+    EXPECT_EQ(Locations::LOCATION_NOT_FOUND, resolved.getRoot()->getLocationId());
+    for (size_t i = 1; i < leaves.size(); i++)
+    {
+        EXPECT_EQ(locationManager.getNameLocationId(leaves[i]->getName()), leaves[i]->getLocationId());
+        EXPECT_EQ(locationManager.distance(unresolvedLeaves[i - 1], unresolvedLeaves[i]),
+                  locationManager.distanceByCachedId(leaves[i - 1], leaves[i]));
+    }
+}
+
+// Generated files are read back by the parsers
+TEST(GeneratorTest, SaveFilesTest)
+{
+    TreeGenerator<GeneratedNode> treeGenerator(3);
+    treeGenerator.saveTrees("generated.nwk", CoalescentModel, 40, 4, 1);
+
+    LocationGenerator locationGenerator(3);
+    locationGenerator.saveFiles("generated.locations", "generated.distances", 40, 5);
+
+    Locations::LocationManager generated;
+    LocationGenerator(3).generate(40, 5, generated);
+    EXPECT_TRUE(generated.isValid());
+
+    Locations::LocationManager loaded;
+    LocationsParser locationsParser;
+    locationsParser.loadLocationsFile("generated.locations", loaded);
+    DistancesParser distancesParser;
+    distancesParser.loadDistancesFile("generated.distances", loaded);
+    EXPECT_TRUE(loaded.isValid());
+
+    ASSERT_EQ(5u, loaded.getLocationsCount());
+    ASSERT_EQ(40u, loaded.getNodeNameCount());
+    for (size_t i = 0; i < 40; i++)
+        EXPECT_EQ(generated.getLocation(leafName(i)), loaded.getLocation(leafName(i)));
+    for (Locations::LocationId i = 1; i <= 5; i++)
+    {
+        EXPECT_EQ(0, loaded.distance(i, i));
+        for (Locations::LocationId j = 1; j <= 5; j++)
+        {
+            EXPECT_FLOAT_EQ(generated.distance(i, j), loaded.distance(i, j));
+            EXPECT_FLOAT_EQ(loaded.distance(i, j), loaded.distance(j, i));
+        }
+    }
+
+    ITreeCollection<GeneratedNode> trees;
+    NewickParser<GeneratedNode> newickParser;
+    newickParser.loadNewickFile("generated.nwk", loaded, trees);
+    EXPECT_EQ(4u, trees.getIterator().count());
+
+    EXPECT_THROW(locationGenerator.generate(4, 5, loaded), InvalidGeneratorParameters);
+
+    std::remove("generated.nwk");
+    std::remove("generated.locations");
+    std::remove("generated.distances");
+}
@@ -0,0 +1,180 @@
+#include <map>
+#include <gtest/gtest.h>
+
+#include "phylopp/Domain/ITreeCollection.h"
+#include "phylopp/Domain/LocationAspect.h"
+#include "phylopp/Consensor/ConsensorAspect.h"
+#include "phylopp/Consensor/StrictConsensor.h"
+#include "phylopp/Consensor/IncrementalConsensor.h"
+#include "phylopp/Generator/TreeGenerator.h"
+#include "phylopp/Generator/LocationGenerator.h"
+#include "DummyObserver.h"
+
+using namespace Consensus;
+using namespace Domain;
+using ::testing::Test;
+
+typedef ConsensorAspect<Locations::LocationAspect<Node> > ConsensedNode;
+typedef std::map<bitset, std::pair<NodeName, BranchLength> > ClusterMap;
+
+// The cluster, name and branch length of every non root node of a consensus
+static void getClusterMap(ITree<ConsensedNode>* tree, ClusterMap& clusters)
+{
+    std::vector<ConsensedNode*> pending(1, tree->getRoot());
+
+    clusters.clear();
+    while (!pending.empty())
+    {
+        ConsensedNode* const node = pending.back();
+        pending.pop_back();
+
+        if (!node->isRoot())
+            clusters[node->cluster] = std::make_pair(node->getName(), node->getBranchLength());
+
+        ListIterator<ConsensedNode, Node> it = node->getChildrenIterator<ConsensedNode>();
+        for (; !it.end(); it.next())
+            pending.push_back(it.get());
+    }
+}
+
+static void addLeaf(ConsensedNode* parent, const NodeName& name)
+{
+    ConsensedNode* const leaf = parent->addChild<ConsensedNode>();
+    leaf->setName(name);
+    leaf->setBranchLength(1);
+}
+
+// Builds ((a,b):2,(c,d):3,e)
+static void buildTree(ITree<ConsensedNode>* tree, const char* names)
+{
+    ConsensedNode* const root = tree->getRoot();
+    ConsensedNode* const leftChild = root->addChild<ConsensedNode>();
+    ConsensedNode* const rightChild = root->addChild<ConsensedNode>();
+
+    leftChild->setBranchLength(2);
+    rightChild->setBranchLength(3);
+    addLeaf(leftChild, NodeName(1, names[0]));
+    addLeaf(leftChild, NodeName(1, names[1]));
+    addLeaf(rightChild, NodeName(1, names[2]));
+    addLeaf(rightChild, NodeName(1, names[3]));
+    addLeaf(root, NodeName(1, names[4]));
+}
+
+class IncrementalConsensorTest : public Test
+{
+protected:
+    Locations::LocationManager locationManager;
+    ITreeCollection<ConsensedNode> trees;
+
+    virtual void SetUp()
+    {
+        const char* const names[] = { "A", "B", "C", "D", "E", "F" };
+        for (size_t i = 0; i < 6; i++)
+            locationManager.addLocation("X", names[i]);
+
+        buildTree(trees.addTree(), "ABCDE");
+        buildTree(trees.addTree(), "BACED");
+        buildTree(trees.addTree(), "ACBDE");
+    }
+
+    bitset cluster(const char* names)
+    {
+        bitset ret(locationManager.getNodeNameCount());
+        for (; *names != '\0'; names++)
+            ret.set(locationManager.getNodeNameId(NodeName(1, *names)) - 1);
+        return ret;
+    }
+};
+
+// Clusters in more than half of the trees, known by hand
+TEST_F(IncrementalConsensorTest, MajorityTest)
+{
+    IncrementalConsensor<ConsensedNode> consensor(locationManager, MajorityRule);
+    for (size_t i = 0; i < 3; i++)
+        consensor.addTree(trees.elementAt(i));
+
+    EXPECT_EQ(3u, consensor.getTreeCount());
+    EXPECT_EQ(2u, consensor.getFrequency(cluster("AB")));
+    EXPECT_EQ(1u, consensor.getFrequency(cluster("CD")));
+    EXPECT_EQ(0u, consensor.getFrequency(cluster("AE")));
+
+    ClusterMap clusters;
+    ITree<ConsensedNode>* const majority = consensor.majorityConsensus();
+    getClusterMap(majority, clusters);
+    delete majority;
+    //(A,B), its two leaves and the other three leaves
+    EXPECT_EQ(6u, clusters.size());
+    EXPECT_EQ(1u, clusters.count(cluster("AB")));
+
+    ITree<ConsensedNode>* const strict = consensor.strictConsensus();
+    getClusterMap(strict, clusters);
+    delete strict;
+    EXPECT_EQ(5u, clusters.size());
+    EXPECT_EQ(0u, clusters.count(cluster("AB")));
+}
+
+TEST_F(IncrementalConsensorTest, ErrorsTest)
+{
+    IncrementalConsensor<ConsensedNode> consensor(locationManager);
+    EXPECT_THROW(consensor.strictConsensus(), EmptyTreeCollectionException);
+
+    consensor.addTree(trees.elementAt(0));
+    EXPECT_THROW(consensor.majorityConsensus(), MissingFrequenciesException);
+
+    ITree<ConsensedNode> disjoint;
+    buildTree(&disjoint, "ABCDF");
+    EXPECT_THROW(consensor.addTree(&disjoint), DisjointTerminalsException);
+
+    ITree<ConsensedNode> duplicate;
+    buildTree(&duplicate, "ABCDA");
+    EXPECT_THROW(consensor.addTree(&duplicate), DuplicateNameException);
+
+    //failed trees are not added
+    EXPECT_EQ(1u, consensor.getTreeCount());
+    consensor.addTree(trees.elementAt(1));
+    EXPECT_EQ(2u, consensor.getTreeCount());
+}
+
+// After every tree, the consensus is the one of StrictConsensor
+TEST(IncrementalConsensorGeneratedTest, StrictTest)
+{
+    const size_t leaves = 32;
+    const size_t count = 8;
+
+    Locations::LocationManager locationManager;
+    Generator::LocationGenerator().generate(leaves, 4, locationManager);
+
+    ITreeCollection<ConsensedNode> trees;
+    Generator::TreeGenerator<ConsensedNode>(11).generateTrees(trees, Generator::YuleModel, leaves, count, 1);
+
+    IncrementalConsensor<ConsensedNode> consensor(locationManager);
+    IncrementalConsensor<ConsensedNode> counter(locationManager, MajorityRule);
+    for (size_t i = 0; i < count; i++)
+    {
+        consensor.addTree(trees.elementAt(i));
+        counter.addTree(trees.elementAt(i));
+
+        //the same seed generates the same first trees
+        ITreeCollection<ConsensedNode> added;
+        Generator::TreeGenerator<ConsensedNode>(11).generateTrees(added, Generator::YuleModel, leaves, i + 1, 1);
+
+        DummyObserver<ConsensedNode> observer;
+        StrictConsensor<ConsensedNode, DummyObserver<ConsensedNode> > strictConsensor;
+        ITree<ConsensedNode>* const expected = strictConsensor.consensus(added, observer, locationManager);
+        ITree<ConsensedNode>* const incremental = consensor.strictConsensus();
+        ITree<ConsensedNode>* const counted = counter.strictConsensus();
+
+        ClusterMap expectedClusters;
+        ClusterMap incrementalClusters;
+        ClusterMap countedClusters;
+        getClusterMap(expected, expectedClusters);
+        getClusterMap(incremental, incrementalClusters);
+        getClusterMap(counted, countedClusters);
+        delete expected;
+        delete incremental;
+        delete counted;
+
+        EXPECT_TRUE(expectedClusters == incrementalClusters);
+        EXPECT_TRUE(expectedClusters == countedClusters);
+    }
+}
@@ -1,3 +1,4 @@
+#include <sstream>
 #include <gtest/gtest.h>
 
 #include "phylopp/Domain/LocationAspect.h"
@@ -74,7 +75,179 @@ TEST(LocationAspectTest, DistancesTest)
     nodeM.setName(name4);
     nodeM.setLocationId(locationManager.getNameLocationId(name4));
 
-    //EXPECT_TRUE(nodeB.distanceTo(&nodeS) == 10);
-    //EXPECT_TRUE(nodeS.distanceTo(&nodeB) == 5);
-    //EXPECT_TRUE(nodeC.distanceTo(&nodeM) == 5);
+    EXPECT_EQ(10, locationManager.distanceByCachedId(&nodeB, &nodeS));
+    EXPECT_EQ(5, locationManager.distanceByCachedId(&nodeS, &nodeB));
+    EXPECT_EQ(20, locationManager.distanceByCachedId(&nodeC, &nodeM));
+
+    TestNode unknown;
+    EXPECT_EQ(LOCATION_NOT_FOUND, unknown.getLocationId());
+    EXPECT_THROW(locationManager.distanceByCachedId(&nodeB, &unknown), InvalidLocation);
+}
+
+// Check that location ids are refreshed after the locations change
+TEST(LocationAspectTest, ResolveLocationIdsTest)
+{
+    LocationManager locationManager;
+    locationManager.addLocation("Bs As", "B");
+    locationManager.addLocation("Santa Fe", "S");
+
+    Domain::ITreeCollection<TestNode> trees;
+    Domain::ITree<TestNode>* const tree = trees.addTree();
+    TestNode* const root = tree->getRoot();
+    TestNode* const nodeB = root->addChild<TestNode>();
+    nodeB->setName("B");
+    TestNode* const inner = root->addChild<TestNode>();
+    TestNode* const nodeS = inner->addChild<TestNode>();
+    nodeS->setName("S");
+    TestNode* const nodeC = inner->addChild<TestNode>();
+    nodeC->setName("C");
+
+    resolveLocationIds(trees, locationManager);
+
+    EXPECT_EQ(locationManager.getLocationId("Bs As"), nodeB->getLocationId());
+    EXPECT_EQ(locationManager.getLocationId("Santa Fe"), nodeS->getLocationId());
+    EXPECT_EQ(LOCATION_NOT_FOUND, nodeC->getLocationId());
+    EXPECT_EQ(LOCATION_NOT_FOUND, inner->getLocationId());
+
+    locationManager.addLocation("Cordoba", "C");
+    locationManager.addDistance(7, "Santa Fe", "Cordoba");
+    resolveLocationIds(tree, locationManager);
+
+    EXPECT_EQ(locationManager.getLocationId("Cordoba"), nodeC->getLocationId());
+    EXPECT_EQ(7, locationManager.distanceByCachedId(nodeS, nodeC));
+}
+
+// Check that the dispersion vector follows distance updates
+TEST(LocationAspectTest, DispersionVectorTest)
+{
+    LocationManager locationManager;
+    locationManager.addLocation("Bs As", "B");
+    locationManager.addLocation("Santa Fe", "S");
+    locationManager.addDistance(10, "Bs As", "Santa Fe");
+    locationManager.addDistance(30, "Santa Fe", "Bs As");
+
+    const DistanceVector& dispersion = locationManager.getDispersionVector();
+    ASSERT_EQ(2u, dispersion.size());
+    EXPECT_FLOAT_EQ(0.75f, dispersion[0]);
+    EXPECT_FLOAT_EQ(0.25f, dispersion[1]);
+
+    locationManager.addDistance(30, "Bs As", "Santa Fe");
+    locationManager.getDispersionVector();
+    EXPECT_FLOAT_EQ(0.5f, dispersion[0]);
+    EXPECT_FLOAT_EQ(0.5f, dispersion[1]);
+}
+
+// Large matrices are summed in parallel and without accumulated rounding
+TEST(LocationAspectTest, LargeDispersionVectorTest)
+{
+    const size_t count = 3000;
+    LocationManager locationManager;
+    std::vector<LocationId> ids(count);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        std::stringstream name;
+        name << i;
+        locationManager.addLocation(name.str(), name.str());
+        ids[i] = locationManager.getLocationId(name.str());
+    }
+
+    std::vector<Distance> matrix(count * count, 0.1f);
+    for (size_t i = 0; i < count; i++)
+        matrix[i * count + i] = 0.0f;
+    locationManager.addDistances(ids, &matrix[0]);
+
+    const DistanceVector& dispersion = locationManager.getDispersionVector();
+    ASSERT_EQ(count, dispersion.size());
+    for (size_t i = 0; i < count; i++)
+        EXPECT_NEAR(1.0f - 1.0f / count, dispersion[i], 1e-6f);
+}
+
+// Check batch distance queries
+TEST(LocationAspectTest, BatchDistancesTest)
+{
+    LocationManager locationManager;
+    locationManager.addLocation("Bs As", "B");
+    locationManager.addLocation("Santa Fe", "S");
+    locationManager.addLocation("Cordoba", "C");
+    locationManager.addDistance(10, "Bs As", "Santa Fe");
+    locationManager.addDistance(20, "Cordoba", "Bs As");
+    locationManager.addDistance(30, "Santa Fe", "Cordoba");
+
+    const LocationId b = locationManager.getLocationId("Bs As");
+    const LocationId s = locationManager.getLocationId("Santa Fe");
+    const LocationId c = locationManager.getLocationId("Cordoba");
+
+    const LocationId from[] = { b, c, s, b };
+    const LocationId to[] = { s, b, c, b };
+    Distance result[4];
+    locationManager.distances(from, to, 4, result);
+
+    for (size_t k = 0; k < 4; k++)
+        EXPECT_EQ(locationManager.distance(from[k], to[k]), result[k]);
+
+    const LocationId invalid[] = { b, LOCATION_NOT_FOUND };
+    EXPECT_THROW(locationManager.distances(from, invalid, 2, result), InvalidLocation);
+}
+
+// Check the distances among the leaves of a tree
+TEST(LocationAspectTest, LeafDistancesTest)
+{
+    const DistanceStorage storages[] = { DenseStorage, SymmetricStorage, SparseStorage };
+
+    for (size_t k = 0; k < sizeof(storages) / sizeof(storages[0]); k++)
+    {
+        LocationManager locationManager;
+        locationManager.setDistanceStorage(storages[k]);
+        locationManager.addLocation("Bs As", "B");
+        locationManager.addLocation("Santa Fe", "S");
+        locationManager.addLocation("Cordoba", "C");
+        locationManager.addDistance(10, "Bs As", "Santa Fe");
+        locationManager.addDistance(30, "Santa Fe", "Cordoba");
+
+        Domain::ITree<TestNode> tree;
+        TestNode* const inner = tree.getRoot()->addChild<TestNode>();
+        inner->addChild<TestNode>()->setName("C");
+        inner->addChild<TestNode>()->setName("S");
+        tree.getRoot()->addChild<TestNode>()->setName("B");
+        resolveLocationIds(&tree, locationManager);
+
+        std::vector<LocationId> ids;
+        getLeafLocationIds(&tree, ids);
+        ASSERT_EQ(3u, ids.size());
+        EXPECT_EQ(locationManager.getLocationId("Cordoba"), ids[0]);
+        EXPECT_EQ(locationManager.getLocationId("Santa Fe"), ids[1]);
+        EXPECT_EQ(locationManager.getLocationId("Bs As"), ids[2]);
+
+        DistanceMatrix distances;
+        getLeafDistances(&tree, locationManager, distances);
+        ASSERT_EQ(3u, distances.size());
+        for (size_t i = 0; i < 3; i++)
+            for (size_t j = 0; j < 3; j++)
+                EXPECT_EQ(locationManager.distance(ids[i], ids[j]), distances(i, j));
+    }
+}
+
+// Large batches are split across threads
+TEST(LocationAspectTest, LargeBatchDistancesTest)
+{
+    LocationManager locationManager;
+    locationManager.addLocation("Bs As", "B");
+    locationManager.addLocation("Santa Fe", "S");
+    locationManager.addDistance(10, "Bs As", "Santa Fe");
+
+    const size_t count = 200000;
+    std::vector<LocationId> from(count);
+    std::vector<LocationId> to(count);
+    for (size_t k = 0; k < count; k++)
+    {
+        from[k] = 1 + k % 2;
+        to[k] = 2 - k % 3 % 2;
+    }
+
+    std::vector<Distance> result(count);
+    locationManager.distances(&from[0], &to[0], count, &result[0]);
+
+    for (size_t k = 0; k < count; k++)
+        ASSERT_EQ(locationManager.distance(from[k], to[k]), result[k]);
 }
@@ -0,0 +1,123 @@
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "phylopp/Domain/ITree.h"
+#include "phylopp/Searching/LocationSearchIndex.h"
+#include "phylopp/Searching/SearchNode.h"
+
+using namespace Searching;
+using namespace Locations;
+using ::testing::Test;
+
+class SelectableNode : public Domain::Node
+{
+public:
+    SelectableNode() :
+        selected(false)
+    {}
+
+    void setSelected(bool selected)
+    {
+        this->selected = selected;
+    }
+
+    bool isSelected() const
+    {
+        return selected;
+    }
+
+    void update()
+    {}
+
+private:
+    bool selected;
+};
+
+static void addLocations(LocationManager& locationManager)
+{
+    locationManager.addLocation("Buenos Aires", "B");
+    locationManager.addLocation("Santa Fe", "S");
+    locationManager.addLocation("Santa Rosa", "R");
+    locationManager.addLocation("Santa Fe", "F");
+    locationManager.addLocation("Salta", "T");
+}
+
+TEST(LocationSearchIndexTest, SubstringTest)
+{
+    LocationManager locationManager;
+    addLocations(locationManager);
+    LocationSearchIndex index(locationManager);
+
+    std::vector<LocationId> ids;
+    index.find("a F", SubstringMatch, ids);
+    ASSERT_EQ(1u, ids.size());
+    EXPECT_EQ(locationManager.getLocationId("Santa Fe"), ids[0]);
+
+    index.find("Sa", SubstringMatch, ids);
+    EXPECT_EQ(3u, ids.size());
+
+    index.find("res", SubstringMatch, ids);
+    ASSERT_EQ(1u, ids.size());
+    EXPECT_EQ(locationManager.getLocationId("Buenos Aires"), ids[0]);
+
+    index.find("aS", SubstringMatch, ids);
+    EXPECT_TRUE(ids.empty());
+
+    index.find("", SubstringMatch, ids);
+    EXPECT_EQ(4u, ids.size());
+}
+
+TEST(LocationSearchIndexTest, PrefixTest)
+{
+    LocationManager locationManager;
+    addLocations(locationManager);
+    LocationSearchIndex index(locationManager);
+
+    std::vector<LocationId> ids;
+    index.find("Santa", PrefixMatch, ids);
+    ASSERT_EQ(2u, ids.size());
+    EXPECT_EQ(locationManager.getLocationId("Santa Fe"), ids[0]);
+    EXPECT_EQ(locationManager.getLocationId("Santa Rosa"), ids[1]);
+
+    index.find("Aires", PrefixMatch, ids);
+    EXPECT_TRUE(ids.empty());
+
+    std::vector<NodeNameId> names;
+    index.find("Santa F", PrefixMatch, ids);
+    index.getNodeNames(ids, names);
+    ASSERT_EQ(2u, names.size());
+    EXPECT_EQ(locationManager.getNodeNameId("S"), names[0]);
+    EXPECT_EQ(locationManager.getNodeNameId("F"), names[1]);
+}
+
+TEST(LocationSearchIndexTest, SearchNodeTest)
+{
+    LocationManager locationManager;
+    addLocations(locationManager);
+
+    Domain::ITree<SelectableNode> tree;
+    SelectableNode* const inner = tree.getRoot()->addChild<SelectableNode>();
+    SelectableNode* const nodeS = inner->addChild<SelectableNode>();
+    nodeS->setName("S");
+    SelectableNode* const nodeR = inner->addChild<SelectableNode>();
+    nodeR->setName("R");
+    SelectableNode* const nodeB = tree.getRoot()->addChild<SelectableNode>();
+    nodeB->setName("B");
+    SelectableNode* const unknown = tree.getRoot()->addChild<SelectableNode>();
+    unknown->setName("U");
+
+    SearchNode<SelectableNode> searcher;
+    searcher.setRoot(tree.getRoot());
+
+    LocationSearchIndex index(locationManager);
+    searcher.search("Fe", index);
+    EXPECT_TRUE(nodeS->isSelected());
+    EXPECT_FALSE(nodeR->isSelected());
+    EXPECT_FALSE(nodeB->isSelected());
+    EXPECT_FALSE(unknown->isSelected());
+
+    searcher.search("Bue", locationManager, PrefixMatch);
+    EXPECT_TRUE(nodeB->isSelected());
+    EXPECT_FALSE(nodeR->isSelected());
+    EXPECT_FALSE(inner->isSelected());
+}
@@ -0,0 +1,143 @@
+#include <sstream>
+#include <gtest/gtest.h>
+
+#include "phylopp/Domain/LocationManager.h"
+
+using namespace Locations;
+using ::testing::Test;
+
+static std::string locationName(unsigned int i)
+{
+    std::stringstream name;
+    name << "location" << i;
+    return name.str();
+}
+
+// Every violation is reported, not only the first one
+TEST(LocationValidationTest, ReportTest)
+{
+    LocationManager locationManager;
+    locationManager.addLocation("Bs As", "B");
+    locationManager.addLocation("Santa Fe", "S");
+    locationManager.addLocation("", "X");
+    locationManager.addDistance(10, "Bs As", "Santa Fe");
+
+    ValidationReport report;
+    locationManager.validate(report);
+    EXPECT_FALSE(report.isValid());
+    EXPECT_FALSE(locationManager.isValid());
+
+    ASSERT_EQ(1u, report.nodesWithoutLocation.size());
+    EXPECT_EQ(locationManager.getNodeNameId("X"), report.nodesWithoutLocation[0]);
+
+    const LocationId b = locationManager.getLocationId("Bs As");
+    const LocationId s = locationManager.getLocationId("Santa Fe");
+    const LocationId x = locationManager.getLocationId("");
+    std::vector<LocationPair> expected;
+    expected.push_back(LocationPair(b, x));
+    expected.push_back(LocationPair(s, b));
+    expected.push_back(LocationPair(s, x));
+    expected.push_back(LocationPair(x, b));
+    expected.push_back(LocationPair(x, s));
+    std::sort(expected.begin(), expected.end());
+    EXPECT_EQ(expected, report.missingDistances);
+}
+
+// Revalidation after incremental changes matches a full validation
+TEST(LocationValidationTest, IncrementalTest)
+{
+    const DistanceStorage storages[] = { DenseStorage, SymmetricStorage, SparseStorage };
+
+    for (size_t k = 0; k < sizeof(storages) / sizeof(storages[0]); k++)
+    {
+        LocationManager locationManager;
+        locationManager.setDistanceStorage(storages[k]);
+        unsigned int locations = 0;
+        unsigned int random = 12345;
+
+        for (unsigned int step = 0; step < 300; step++)
+        {
+            random = random * 1103515245u + 12345u;
+
+            if (locations < 2 || random % 7 == 0)
+            {
+                locationManager.addLocation(locationName(locations), locationName(locations));
+                locations++;
+            }
+            else
+            {
+                const unsigned int from = (random >> 8) % locations;
+                const unsigned int to = (random >> 16) % locations;
+                const Distance distance = ((random >> 24) % 4 == 0) ? 0.0f : 1.0f;
+                locationManager.addDistance(distance, locationName(from), locationName(to));
+            }
+
+            ValidationReport incremental;
+            locationManager.validate(incremental);
+
+            //changing the storage forgets the previous validation
+            LocationManager fresh = locationManager;
+            fresh.setDistanceStorage(storages[k]);
+            ValidationReport full;
+            fresh.validate(full);
+
+            ASSERT_EQ(full.missingDistances, incremental.missingDistances);
+            ASSERT_EQ(full.isValid(), locationManager.isValid());
+        }
+    }
+}
+
+// Growing a sparse matrix with a default distance fills missing distances
+TEST(LocationValidationTest, SparseDefaultTest)
+{
+    LocationManager locationManager;
+    locationManager.setDistanceStorage(SparseStorage, 2.0f);
+    locationManager.addLocation(locationName(0), locationName(0));
+    locationManager.addLocation(locationName(1), locationName(1));
+
+    ValidationReport report;
+    locationManager.validate(report);
+    EXPECT_EQ(2u, report.missingDistances.size());
+
+    locationManager.addDistance(3.0f, locationName(0), locationName(1));
+    locationManager.validate(report);
+
+    LocationManager fresh = locationManager;
+    fresh.setDistanceStorage(SparseStorage, 2.0f);
+    ValidationReport full;
+    fresh.validate(full);
+
+    EXPECT_TRUE(full.missingDistances.empty());
+    EXPECT_EQ(full.missingDistances, report.missingDistances);
+    EXPECT_TRUE(locationManager.isValid());
+}
+
+// Validation across threads on a large matrix
+TEST(LocationValidationTest, LargeTest)
+{
+    const unsigned int count = 1500;
+    LocationManager locationManager;
+    std::vector<LocationId> ids(count);
+
+    for (unsigned int i = 0; i < count; i++)
+    {
+        locationManager.addLocation(locationName(i), locationName(i));
+        ids[i] = locationManager.getLocationId(locationName(i));
+    }
+
+    std::vector<Distance> matrix(count * count, 1.0f);
+    matrix[7 * count + 1000] = 0.0f;
+    matrix[1400 * count + 3] = 0.0f;
+    locationManager.addDistances(ids, &matrix[0]);
+
+    ValidationReport report;
+    locationManager.validate(report);
+    ASSERT_EQ(2u, report.missingDistances.size());
+    EXPECT_EQ(LocationPair(ids[7], ids[1000]), report.missingDistances[0]);
+    EXPECT_EQ(LocationPair(ids[1400], ids[3]), report.missingDistances[1]);
+
+    locationManager.addDistance(2.0f, locationName(7), locationName(1000));
+    locationManager.validate(report);
+    ASSERT_EQ(1u, report.missingDistances.size());
+    EXPECT_EQ(LocationPair(ids[1400], ids[3]), report.missingDistances[0]);
+}
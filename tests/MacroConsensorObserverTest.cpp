@@ -0,0 +1,174 @@
+#include <gtest/gtest.h>
+
+#include "phylopp/Domain/ITreeCollection.h"
+#include "phylopp/Domain/LocationAspect.h"
+#include "phylopp/Consensor/ConsensorAspect.h"
+#include "phylopp/Consensor/StrictConsensor.h"
+#include "phylopp/Consensor/ProfilingConsensorObserver.h"
+#include "phylopp/Consensor/MacroConsensorObserver.h"
+#include "phylopp/Generator/TreeGenerator.h"
+#include "phylopp/Generator/LocationGenerator.h"
+#include "DummyObserver.h"
+
+using namespace Consensus;
+using namespace Domain;
+using ::testing::Test;
+
+typedef ConsensorAspect<Locations::LocationAspect<Node> > MacroNode;
+
+static size_t countTrueBits(const bitset& cluster)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < cluster.size(); i++)
+        count += cluster[i] ? 1 : 0;
+    return count;
+}
+
+// Gets the cluster events one by one
+class SingleObserver
+{
+public:
+    SingleObserver() :
+        included(0),
+        excluded(0),
+        includedBits(0),
+        ended(false)
+    {}
+    void onStart(const ITreeCollection<MacroNode>& /*trees*/)
+    {}
+    void onInclude(MacroNode* /*node*/, const bitset& cluster)
+    {
+        included++;
+        includedBits += countTrueBits(cluster);
+    }
+    void onExclude(MacroNode* /*node*/, const bitset& /*cluster*/)
+    {
+        excluded++;
+    }
+    void onEnd(ITree<MacroNode>* /*consensed*/)
+    {
+        ended = true;
+    }
+
+    size_t included;
+    size_t excluded;
+    size_t includedBits;
+    bool ended;
+};
+
+// Gets the cluster events in batches
+class BatchObserver
+{
+public:
+    BatchObserver() :
+        included(0),
+        excluded(0),
+        includedBits(0),
+        batches(0),
+        largestBatch(0)
+    {}
+    void onStart(const ITreeCollection<MacroNode>& /*trees*/)
+    {}
+    void onIncludeBatch(MacroNode* const* nodes, const bitset* clusters, size_t count)
+    {
+        addBatch(count);
+        included += count;
+        for (size_t i = 0; i < count; i++)
+        {
+            EXPECT_TRUE(nodes[i] != NULL);
+            includedBits += countTrueBits(clusters[i]);
+        }
+    }
+    void onExcludeBatch(MacroNode* const* /*nodes*/, const bitset* /*clusters*/, size_t count)
+    {
+        addBatch(count);
+        excluded += count;
+    }
+    void onEnd(ITree<MacroNode>* /*consensed*/)
+    {}
+
+    size_t included;
+    size_t excluded;
+    size_t includedBits;
+    size_t batches;
+    size_t largestBatch;
+
+private:
+    void addBatch(size_t count)
+    {
+        batches++;
+        largestBatch = std::max(largestBatch, count);
+    }
+};
+
+namespace Consensus
+{
+template <>
+struct ObserverTraits<BatchObserver> : DefaultObserverTraits
+{
+    static const bool wants_cluster_batches = true;
+};
+}
+
+// Every observer gets every event it asks for
+TEST(MacroConsensorObserverTest, FanOutTest)
+{
+    typedef ProfilingConsensorObserver<MacroNode> Profiler;
+    typedef MacroConsensorObserver<MacroNode, SingleObserver, BatchObserver, Profiler, DummyObserver<MacroNode> > Macro;
+
+    EXPECT_TRUE(bool(ObserverTraits<Macro>::wants_cluster_events));
+    EXPECT_TRUE(bool(ObserverTraits<Macro>::wants_phase_events));
+
+    Locations::LocationManager locationManager;
+    Generator::LocationGenerator().generate(100, 5, locationManager);
+    ITreeCollection<MacroNode> trees;
+    Generator::TreeGenerator<MacroNode>().generateTrees(trees, Generator::YuleModel, 100, 5, 3);
+
+    SingleObserver single;
+    BatchObserver batch;
+    Profiler profiler;
+    DummyObserver<MacroNode> dummy;
+    Macro macro(single, batch, profiler, dummy);
+
+    StrictConsensor<MacroNode, Macro> consensor;
+    delete consensor.consensus(trees, macro, locationManager);
+
+    EXPECT_TRUE(single.ended);
+    EXPECT_LE(199u, single.included);
+    EXPECT_LT(0u, single.excluded);
+
+    EXPECT_EQ(single.included, batch.included);
+    EXPECT_EQ(single.excluded, batch.excluded);
+    EXPECT_EQ(single.includedBits, batch.includedBits);
+    EXPECT_EQ(OBSERVER_BATCH_SIZE, batch.largestBatch);
+    EXPECT_GT(single.included + single.excluded, batch.batches);
+
+    EXPECT_EQ(single.included, profiler.getIncludedCount());
+    EXPECT_EQ(single.excluded, profiler.getExcludedCount());
+    EXPECT_EQ(5u, profiler.getTreeCount());
+}
+
+// A macro of observers that want no events gets no calls either
+TEST(MacroConsensorObserverTest, NoEventsTest)
+{
+    typedef MacroConsensorObserver<MacroNode, DummyObserver<MacroNode> > Macro;
+
+    EXPECT_FALSE(bool(ObserverTraits<Macro>::wants_cluster_events));
+    EXPECT_FALSE(bool(ObserverTraits<Macro>::wants_phase_events));
+    EXPECT_FALSE(bool(Macro::batches_cluster_events));
+
+    Locations::LocationManager locationManager;
+    Generator::LocationGenerator().generate(10, 2, locationManager);
+    ITreeCollection<MacroNode> trees;
+    Generator::TreeGenerator<MacroNode>().generateTrees(trees, Generator::BalancedModel, 10, 2);
+
+    DummyObserver<MacroNode> dummy;
+    Macro macro(dummy);
+    StrictConsensor<MacroNode, Macro> consensor;
+    ITree<MacroNode>* const consensed = consensor.consensus(trees, macro, locationManager);
+
+    std::vector<const MacroNode*> leaves;
+    consensed->getLeaves(leaves);
+    EXPECT_EQ(10u, leaves.size());
+    delete consensed;
+}
@@ -0,0 +1,57 @@
+#include <string>
+#include <sstream>
+#include <gtest/gtest.h>
+
+#include "phylopp/Domain/NameTable.h"
+
+using namespace Locations;
+using ::testing::Test;
+
+TEST(NameTableTest, InsertFindTest)
+{
+    NameTable table;
+    EXPECT_TRUE(table.empty());
+    EXPECT_EQ(NAME_NOT_FOUND, table.find("Cordoba"));
+
+    const NameTable::Id cordoba = table.insert("Cordoba");
+    const NameTable::Id salta = table.insert("Salta");
+
+    EXPECT_EQ(1u, cordoba);
+    EXPECT_EQ(2u, salta);
+    EXPECT_EQ(cordoba, table.insert("Cordoba"));
+    EXPECT_EQ(2u, table.size());
+
+    EXPECT_EQ(salta, table.find("Salta"));
+    EXPECT_EQ(salta, table.find("Salta, Argentina", 5));
+    EXPECT_EQ(NAME_NOT_FOUND, table.find("Salt"));
+    EXPECT_EQ(std::string("Cordoba"), table.name(cordoba));
+
+    table.clear();
+    EXPECT_TRUE(table.empty());
+    EXPECT_EQ(NAME_NOT_FOUND, table.find("Salta"));
+}
+
+// Ids stay stable while the table grows
+TEST(NameTableTest, GrowTest)
+{
+    NameTable table;
+
+    for (unsigned int i = 0; i < 1000; i++)
+    {
+        std::stringstream name;
+        name << "location" << i;
+        EXPECT_EQ(i + 1, table.insert(name.str()));
+    }
+
+    for (unsigned int i = 0; i < 1000; i++)
+    {
+        std::stringstream name;
+        name << "location" << i;
+        EXPECT_EQ(i + 1, table.find(name.str()));
+        EXPECT_EQ(name.str(), table.name(i + 1));
+    }
+
+    EXPECT_EQ(NAME_NOT_FOUND, table.find(""));
+    EXPECT_EQ(1001u, table.insert(""));
+    EXPECT_EQ(1001u, table.find(""));
+}
@@ -0,0 +1,110 @@
+#include <stddef.h>
+#include <gtest/gtest.h>
+
+#include "phylopp/Domain/ITree.h"
+#include "phylopp/Domain/LocationAspect.h"
+#include "phylopp/DataSource/NewickReader.h"
+
+using namespace Domain;
+using ::testing::Test;
+
+typedef Locations::LocationAspect<Domain::Node> TestNode;
+
+static const std::string test_dir("./ref/");
+
+// Trees are handed one at a time, in file order
+TEST(NewickReaderTest, ReadTreesOneAtATime)
+{
+    Locations::LocationManager locationManager;
+    NewickReader<TestNode> reader(test_dir + "outTree.nwk", locationManager);
+
+    unsigned int count = 0;
+    ITree<TestNode>* tree = reader.next();
+    while (tree != NULL)
+    {
+        count++;
+        EXPECT_EQ(count, tree->getId());
+        EXPECT_FALSE(tree->getRoot()->isLeaf());
+        delete tree;
+        tree = reader.next();
+    }
+
+    EXPECT_EQ(8u, count);
+    EXPECT_FALSE(reader.hasNext());
+}
+
+// Trees can be read into trees supplied by the client
+TEST(NewickReaderTest, ReadIntoClientTree)
+{
+    Locations::LocationManager locationManager;
+    locationManager.addLocation("placeA", "A");
+    NewickReader<TestNode> reader(test_dir + "tree6.nwk", locationManager);
+
+    ASSERT_TRUE(reader.hasNext());
+    ITree<TestNode> tree;
+    reader.readTree(&tree);
+
+    ListIterator<TestNode, Domain::Node> it = tree.getRoot()->getChildrenIterator<TestNode>();
+    EXPECT_EQ("A", it.get()->getName());
+    EXPECT_FLOAT_EQ(0.1f, it.get()->getBranchLength());
+    EXPECT_EQ(locationManager.getLocationId("placeA"), it.get()->getLocationId());
+    EXPECT_FALSE(reader.hasNext());
+}
+
+// Errors are reported when the offending tree is reached
+TEST(NewickReaderTest, ReadMalformedTree)
+{
+    Locations::LocationManager locationManager;
+    NewickReader<TestNode> reader(test_dir + "tree10.nwk", locationManager);
+
+    ITree<TestNode>* first = reader.next();
+    ASSERT_TRUE(first != NULL);
+    delete first;
+
+    ASSERT_THROW(reader.next(), MalformedExpression);
+}
+
+TEST(NewickReaderTest, ReadMissingFile)
+{
+    Locations::LocationManager locationManager;
+    ASSERT_THROW(NewickReader<TestNode> reader(test_dir + "tree11.nwk", locationManager), TreeFileNotFound);
+}
+
+// Named internal nodes get their locations too
+TEST(NewickReaderTest, ReadInternalLocation)
+{
+    Locations::LocationManager locationManager;
+    locationManager.addLocation("placeA", "A");
+    locationManager.addLocation("placeE", "E");
+    locationManager.addDistance(3.0f, "placeA", "placeE");
+    NewickReader<TestNode> reader(test_dir + "tree14.nwk", locationManager);
+
+    ITree<TestNode>* const tree = reader.next();
+    ASSERT_TRUE(tree != NULL);
+
+    TestNode* const internal = tree->getRoot()->getChildrenIterator<TestNode>().get();
+    TestNode* const leaf = internal->getChildrenIterator<TestNode>().get();
+    EXPECT_EQ("E", internal->getName());
+    EXPECT_EQ(locationManager.getLocationId("placeE"), internal->getLocationId());
+    EXPECT_FLOAT_EQ(3.0f, locationManager.distanceByCachedId(leaf, internal));
+    EXPECT_EQ(Locations::LOCATION_NOT_FOUND, tree->getRoot()->getLocationId());
+    delete tree;
+}
+
+// Branch lengths may be written in exponent notation
+TEST(NewickReaderTest, ReadExponentBranchLengths)
+{
+    Locations::LocationManager locationManager;
+    NewickReader<TestNode> reader(test_dir + "tree15.nwk", locationManager);
+
+    ITree<TestNode>* const tree = reader.next();
+    ASSERT_TRUE(tree != NULL);
+
+    ListIterator<TestNode, Domain::Node> it = tree->getRoot()->getChildrenIterator<TestNode>();
+    EXPECT_FLOAT_EQ(1e-05f, it.get()->getBranchLength());
+    it.next();
+    EXPECT_FLOAT_EQ(2500.0f, it.get()->getBranchLength());
+    it.next();
+    EXPECT_FLOAT_EQ(-150.0f, it.get()->getBranchLength());
+    delete tree;
+}
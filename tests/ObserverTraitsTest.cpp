@@ -0,0 +1,99 @@
+#include <sstream>
+#include <gtest/gtest.h>
+
+#include "phylopp/Domain/ITreeCollection.h"
+#include "phylopp/Domain/LocationAspect.h"
+#include "phylopp/DataSource/NewickWriter.h"
+#include "phylopp/Consensor/ConsensorAspect.h"
+#include "phylopp/Consensor/StrictConsensor.h"
+#include "phylopp/Generator/TreeGenerator.h"
+#include "phylopp/Generator/LocationGenerator.h"
+#include "DummyObserver.h"
+
+using namespace Consensus;
+using namespace Domain;
+using ::testing::Test;
+
+typedef ConsensorAspect<Locations::LocationAspect<Node> > TraitsNode;
+
+// Observer with the default traits
+class CountingObserver
+{
+public:
+    CountingObserver() :
+        included(0),
+        excluded(0)
+    {}
+    void onStart(const ITreeCollection<TraitsNode>& /*trees*/)
+    {}
+    void onInclude(TraitsNode* /*node*/, const bitset& /*cluster*/)
+    {
+        included++;
+    }
+    void onExclude(TraitsNode* /*node*/, const bitset& /*cluster*/)
+    {
+        excluded++;
+    }
+    void onEnd(ITree<TraitsNode>* /*consensed*/)
+    {}
+
+    size_t included;
+    size_t excluded;
+};
+
+// Observer without cluster methods, which only compiles if they are not called
+class SilentObserver
+{
+public:
+    void onStart(const ITreeCollection<TraitsNode>& /*trees*/)
+    {}
+    void onEnd(ITree<TraitsNode>* /*consensed*/)
+    {}
+};
+
+namespace Consensus
+{
+template <>
+struct ObserverTraits<SilentObserver> : DefaultObserverTraits
+{
+    static const bool wants_cluster_events = false;
+};
+}
+
+template <class Observer>
+static std::string consensus(ITreeCollection<TraitsNode>& trees, Observer& observer,
+                             Locations::LocationManager& locationManager)
+{
+    StrictConsensor<TraitsNode, Observer> consensor;
+    ITree<TraitsNode>* const consensed = consensor.consensus(trees, observer, locationManager);
+
+    std::stringstream ss;
+    NewickWriter<TraitsNode> writer;
+    writer.saveNewickTree(ss, consensed);
+    delete consensed;
+    return ss.str();
+}
+
+// Observers that skip the cluster events get the same consensus
+TEST(ObserverTraitsTest, ClusterEventsTest)
+{
+    Locations::LocationManager locationManager;
+    Generator::LocationGenerator().generate(20, 2, locationManager);
+
+    ITreeCollection<TraitsNode> trees;
+    Generator::TreeGenerator<TraitsNode>().generateTrees(trees, Generator::YuleModel, 20, 3, 1);
+
+    EXPECT_TRUE(bool(ObserverTraits<CountingObserver>::wants_cluster_events));
+    EXPECT_FALSE(bool(ObserverTraits<DummyObserver<TraitsNode> >::wants_cluster_events));
+
+    CountingObserver counting;
+    const std::string expected = consensus(trees, counting, locationManager);
+    EXPECT_LE(39u, counting.included);
+    EXPECT_LT(0u, counting.excluded);
+
+    SilentObserver silent;
+    EXPECT_EQ(expected, consensus(trees, silent, locationManager));
+
+    DummyObserver<TraitsNode> dummy;
+    EXPECT_EQ(expected, consensus(trees, dummy, locationManager));
+}
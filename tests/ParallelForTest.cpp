@@ -0,0 +1,46 @@
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "phylopp/Domain/ParallelFor.h"
+
+using namespace Domain;
+using ::testing::Test;
+
+class CountCalls
+{
+public:
+    CountCalls(std::vector<unsigned int>& calls) :
+        calls(calls)
+    {}
+
+    void operator()(size_t begin, size_t end) const
+    {
+        for (size_t i = begin; i < end; i++)
+            calls[i]++;
+    }
+
+private:
+    std::vector<unsigned int>& calls;
+};
+
+// Every index is visited exactly once, whatever the amount of threads
+TEST(ParallelForTest, CoverageTest)
+{
+    const size_t threads[] = { 1, 2, 3, 7 };
+
+    for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); t++)
+    {
+        std::vector<unsigned int> calls(1000, 0);
+        parallelFor(10, 1000, CountCalls(calls), 100, threads[t]);
+
+        for (size_t i = 0; i < calls.size(); i++)
+            EXPECT_EQ(i < 10 ? 0u : 1u, calls[i]);
+    }
+}
+
+TEST(ParallelForTest, EmptyRangeTest)
+{
+    std::vector<unsigned int> calls(1, 0);
+    parallelFor(0, 0, CountCalls(calls), 100);
+    EXPECT_EQ(0u, calls[0]);
+}
@@ -0,0 +1,133 @@
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "phylopp/Searching/PatternSet.h"
+#include "phylopp/Searching/LeafSearch.h"
+
+using namespace Searching;
+using ::testing::Test;
+
+static std::vector<bool> matchAll(const PatternSet& patterns, const std::string& text, PatternTarget target = AnyTarget)
+{
+    std::vector<bool> matched(patterns.size(), false);
+    patterns.match(text, target, matched);
+    return matched;
+}
+
+// Overlapping literals are all found in one pass
+TEST(PatternSetTest, LiteralTest)
+{
+    PatternSet patterns;
+    patterns.add("he", LiteralPattern);
+    patterns.add("she", LiteralPattern);
+    patterns.add("hers", LiteralPattern);
+    patterns.add("his", LiteralPattern);
+    patterns.add("", LiteralPattern);
+
+    std::vector<bool> matched = matchAll(patterns, "ushers");
+    EXPECT_TRUE(matched[0]);
+    EXPECT_TRUE(matched[1]);
+    EXPECT_TRUE(matched[2]);
+    EXPECT_FALSE(matched[3]);
+    EXPECT_TRUE(matched[4]);
+
+    patterns.add("sh", LiteralPattern);
+    matched = matchAll(patterns, "hi");
+    EXPECT_FALSE(matched[0]);
+    EXPECT_FALSE(matched[5]);
+    EXPECT_TRUE(matched[4]);
+}
+
+TEST(PatternSetTest, GlobTest)
+{
+    PatternSet patterns;
+    patterns.add("Santa*", GlobPattern);
+    patterns.add("?alta", GlobPattern);
+    patterns.add("[!B]*s", GlobPattern);
+    patterns.add("a.b*", GlobPattern);
+
+    std::vector<bool> matched = matchAll(patterns, "Santa Fe");
+    EXPECT_TRUE(matched[0]);
+    EXPECT_FALSE(matched[1]);
+    EXPECT_FALSE(matched[2]);
+
+    matched = matchAll(patterns, "Salta");
+    EXPECT_FALSE(matched[0]);
+    EXPECT_TRUE(matched[1]);
+
+    EXPECT_TRUE(matchAll(patterns, "Corrientes")[2]);
+    EXPECT_FALSE(matchAll(patterns, "Bahia Blancas")[2]);
+    EXPECT_TRUE(matchAll(patterns, "a.bc")[3]);
+    EXPECT_FALSE(matchAll(patterns, "axbc")[3]);
+}
+
+TEST(PatternSetTest, RegexTest)
+{
+    PatternSet patterns;
+    patterns.add("^S(an|al)", RegexPattern);
+    patterns.add("[0-9]+$", RegexPattern);
+
+    std::vector<bool> matched = matchAll(patterns, "Salta 12");
+    EXPECT_TRUE(matched[0]);
+    EXPECT_TRUE(matched[1]);
+
+    matched = matchAll(patterns, "La Salta");
+    EXPECT_FALSE(matched[0]);
+    EXPECT_FALSE(matched[1]);
+
+    EXPECT_THROW(patterns.add("(unclosed", RegexPattern), InvalidPattern);
+    EXPECT_EQ(2u, patterns.size());
+}
+
+TEST(PatternSetTest, TargetTest)
+{
+    PatternSet patterns;
+    patterns.add("ant", LiteralPattern, LocationTarget);
+    patterns.add("ant", LiteralPattern, NodeNameTarget);
+    patterns.add("^ant", RegexPattern, NodeNameTarget);
+
+    std::vector<bool> matched = matchAll(patterns, "ant", LocationTarget);
+    EXPECT_TRUE(matched[0]);
+    EXPECT_FALSE(matched[1]);
+    EXPECT_FALSE(matched[2]);
+}
+
+// Leaves matching several searches are combined as bitsets
+TEST(PatternSetTest, SearchLeavesTest)
+{
+    Locations::LocationManager locationManager;
+    locationManager.addLocation("Santa Fe", "leaf1");
+    locationManager.addLocation("Salta", "leaf2");
+    locationManager.addLocation("Santa Fe", "other3");
+
+    Domain::ITree<Domain::Node> tree;
+    Domain::Node* const inner = tree.getRoot()->addChild<Domain::Node>();
+    inner->addChild<Domain::Node>()->setName("leaf1");
+    inner->addChild<Domain::Node>()->setName("leaf2");
+    tree.getRoot()->addChild<Domain::Node>()->setName("other3");
+    tree.getRoot()->addChild<Domain::Node>()->setName("leaf4");
+
+    PatternSet patterns;
+    patterns.add("Santa", LiteralPattern, LocationTarget);
+    patterns.add("leaf*", GlobPattern, NodeNameTarget);
+    patterns.add("a$", RegexPattern);
+
+    std::vector<Consensus::bitset> results;
+    searchLeaves(&tree, locationManager, patterns, results);
+    ASSERT_EQ(3u, results.size());
+
+    const bool santa[] = { true, false, true, false };
+    const bool leaf[] = { true, true, false, true };
+    const bool endsWithA[] = { false, true, false, false };
+    for (size_t i = 0; i < 4; i++)
+    {
+        EXPECT_EQ(santa[i], bool(results[0][i]));
+        EXPECT_EQ(leaf[i], bool(results[1][i]));
+        EXPECT_EQ(endsWithA[i], bool(results[2][i]));
+    }
+
+    Consensus::bitset both = results[0] & results[1];
+    EXPECT_TRUE(both[0]);
+    EXPECT_FALSE(both[1]);
+    EXPECT_FALSE(both[2]);
+}
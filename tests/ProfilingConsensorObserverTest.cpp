@@ -0,0 +1,176 @@
+#include <sstream>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "phylopp/Domain/ITreeCollection.h"
+#include "phylopp/Domain/LocationAspect.h"
+#include "phylopp/Domain/ParallelFor.h"
+#include "phylopp/Consensor/ConsensorAspect.h"
+#include "phylopp/Consensor/StrictConsensor.h"
+#include "phylopp/Consensor/ProfilingConsensorObserver.h"
+#include "phylopp/Generator/TreeGenerator.h"
+#include "phylopp/Generator/LocationGenerator.h"
+
+using namespace Consensus;
+using namespace Domain;
+using ::testing::Test;
+
+typedef ConsensorAspect<Locations::LocationAspect<Node> > ProfiledNode;
+typedef ProfilingConsensorObserver<ProfiledNode> Profiler;
+
+static const size_t LEAVES = 32;
+static const size_t TREES = 4;
+
+class ConsensusRuns
+{
+public:
+    ConsensusRuns(std::vector<ITreeCollection<ProfiledNode>*>& collections,
+                  Profiler& profiler, Locations::LocationManager& locationManager) :
+        collections(collections),
+        profiler(profiler),
+        locationManager(locationManager)
+    {}
+
+    void operator()(size_t begin, size_t end) const
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            StrictConsensor<ProfiledNode, Profiler> consensor;
+            delete consensor.consensus(*collections[i], profiler, locationManager);
+        }
+    }
+
+private:
+    std::vector<ITreeCollection<ProfiledNode>*>& collections;
+    Profiler& profiler;
+    Locations::LocationManager& locationManager;
+};
+
+// Counts the phases of a run
+class PhaseCounter
+{
+public:
+    PhaseCounter() :
+        begins(CONSENSUS_PHASES, 0),
+        ends(CONSENSUS_PHASES, 0)
+    {}
+    void onStart(const ITreeCollection<ProfiledNode>& /*trees*/)
+    {}
+    void onPhaseBegin(ConsensusPhase phase)
+    {
+        begins[phase]++;
+    }
+    void onPhaseEnd(ConsensusPhase phase, size_t /*clusters*/)
+    {
+        ends[phase]++;
+    }
+    void onEnd(ITree<ProfiledNode>* /*consensed*/)
+    {}
+
+    std::vector<size_t> begins;
+    std::vector<size_t> ends;
+};
+
+namespace Consensus
+{
+template <>
+struct ObserverTraits<PhaseCounter> : DefaultObserverTraits
+{
+    static const bool wants_cluster_events = false;
+    static const bool wants_phase_events = true;
+};
+}
+
+// Every tree is extracted, and intersected unless it is the first one
+TEST(ProfilingConsensorObserverTest, PhaseCountTest)
+{
+    Locations::LocationManager locationManager;
+    Generator::LocationGenerator().generate(LEAVES, 4, locationManager);
+
+    ITreeCollection<ProfiledNode> trees;
+    Generator::TreeGenerator<ProfiledNode>().generateTrees(trees, Generator::YuleModel, LEAVES, TREES, 2);
+
+    PhaseCounter counter;
+    StrictConsensor<ProfiledNode, PhaseCounter> consensor;
+    delete consensor.consensus(trees, counter, locationManager);
+
+    EXPECT_EQ(TREES, counter.begins[ClusterExtractionPhase]);
+    EXPECT_EQ(TREES - 1, counter.begins[IntersectionPhase]);
+    EXPECT_EQ(1u, counter.begins[SortPhase]);
+    EXPECT_EQ(1u, counter.begins[TreeBuildPhase]);
+    EXPECT_EQ(counter.begins, counter.ends);
+}
+
+// Every phase and cluster event of a run is accounted for
+TEST(ProfilingConsensorObserverTest, ConsensusTest)
+{
+    Locations::LocationManager locationManager;
+    Generator::LocationGenerator().generate(LEAVES, 4, locationManager);
+
+    ITreeCollection<ProfiledNode> trees;
+    Generator::TreeGenerator<ProfiledNode>().generateTrees(trees, Generator::YuleModel, LEAVES, TREES, 2);
+
+    Profiler profiler;
+    StrictConsensor<ProfiledNode, Profiler> consensor;
+    ITree<ProfiledNode>* const consensed = consensor.consensus(trees, profiler, locationManager);
+    delete consensed;
+
+    EXPECT_EQ(TREES, profiler.getTreeCount());
+    EXPECT_EQ(2 * LEAVES - 1, profiler.getPeakClusterCount());
+    EXPECT_LE(2 * LEAVES - 1, profiler.getIncludedCount());
+    EXPECT_LT(0u, profiler.getExcludedCount());
+
+    std::vector<double> extractionTimes;
+    profiler.getExtractionTimes(extractionTimes);
+    ASSERT_EQ(TREES, extractionTimes.size());
+
+    double extraction = 0.0;
+    for (size_t i = 0; i < extractionTimes.size(); i++)
+        extraction += extractionTimes[i];
+    EXPECT_DOUBLE_EQ(extraction, profiler.getPhaseTime(ClusterExtractionPhase));
+
+    double phases = 0.0;
+    for (size_t phase = 0; phase < CONSENSUS_PHASES; phase++)
+    {
+        EXPECT_LE(0.0, profiler.getPhaseTime(ConsensusPhase(phase)));
+        phases += profiler.getPhaseTime(ConsensusPhase(phase));
+    }
+    EXPECT_GE(profiler.getTotalTime(), phases);
+
+    std::stringstream report;
+    profiler.writeReport(report);
+    EXPECT_NE(std::string::npos, report.str().find("\"trees\": 4,"));
+    EXPECT_NE(std::string::npos, report.str().find("\"peak_clusters\": 63\n}"));
+    EXPECT_NE(std::string::npos, report.str().find("\"phases\": {\"extraction\": "));
+}
+
+// Runs in several threads share the observer
+TEST(ProfilingConsensorObserverTest, ThreadsTest)
+{
+    Locations::LocationManager locationManager;
+    Generator::LocationGenerator().generate(LEAVES, 4, locationManager);
+
+    Generator::TreeGenerator<ProfiledNode> generator;
+    ITreeCollection<ProfiledNode> generated[4];
+    std::vector<ITreeCollection<ProfiledNode>*> collections(4);
+    for (size_t i = 0; i < collections.size(); i++)
+    {
+        collections[i] = &generated[i];
+        generator.generateTrees(*collections[i], Generator::YuleModel, LEAVES, TREES, 2);
+    }
+
+    Profiler profiler;
+    parallelFor(0, collections.size(), ConsensusRuns(collections, profiler, locationManager), 1, 4);
+
+    EXPECT_EQ(collections.size() * TREES, profiler.getTreeCount());
+    EXPECT_EQ(2 * LEAVES - 1, profiler.getPeakClusterCount());
+
+    std::vector<double> extractionTimes;
+    profiler.getExtractionTimes(extractionTimes);
+    EXPECT_EQ(collections.size() * TREES, extractionTimes.size());
+
+    Profiler sequential;
+    ConsensusRuns(collections, sequential, locationManager)(0, collections.size());
+    EXPECT_EQ(sequential.getIncludedCount(), profiler.getIncludedCount());
+    EXPECT_EQ(sequential.getExcludedCount(), profiler.getExcludedCount());
+}
@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+
+#include "phylopp/Domain/ITreeCollection.h"
+#include "phylopp/Domain/LocationAspect.h"
+#include "phylopp/Comparison/RobinsonFoulds.h"
+#include "phylopp/Generator/TreeGenerator.h"
+#include "phylopp/Generator/LocationGenerator.h"
+
+using namespace Comparison;
+using namespace Domain;
+using ::testing::Test;
+
+typedef Locations::LocationAspect<Node> ComparedNode;
+
+static const size_t LEAVES = 64;
+static const size_t TREES = 40;
+
+static ComparedNode* addLeaf(ComparedNode* parent, const NodeName& name, BranchLength length)
+{
+    ComparedNode* const leaf = parent->addChild<ComparedNode>();
+    leaf->setName(name);
+    leaf->setBranchLength(length);
+    return leaf;
+}
+
+// Builds ((a,b):left,(c,d):right,E), with every leaf of length 1
+static void buildTree(ITree<ComparedNode>* tree, const NodeName& a, const NodeName& b, BranchLength left,
+                      const NodeName& c, const NodeName& d, BranchLength right)
+{
+    ComparedNode* const root = tree->getRoot();
+    ComparedNode* const leftChild = root->addChild<ComparedNode>();
+    ComparedNode* const rightChild = root->addChild<ComparedNode>();
+
+    leftChild->setBranchLength(left);
+    rightChild->setBranchLength(right);
+    addLeaf(leftChild, a, 1);
+    addLeaf(leftChild, b, 1);
+    addLeaf(rightChild, c, 1);
+    addLeaf(rightChild, d, 1);
+    addLeaf(root, "E", 1);
+}
+
+static void addLocations(Locations::LocationManager& locationManager)
+{
+    locationManager.addLocation("X", "A");
+    locationManager.addLocation("X", "B");
+    locationManager.addLocation("X", "C");
+    locationManager.addLocation("Y", "D");
+    locationManager.addLocation("Y", "E");
+}
+
+// Both sides of a split give the same canonical split
+TEST(RobinsonFouldsTest, CanonicalizeTest)
+{
+    Consensus::bitset leaves(70);
+    leaves.set();
+    leaves.reset(3);
+
+    Consensus::bitset small(70);
+    small.set(0);
+    small.set(65);
+    Consensus::bitset large(small);
+    large.flip();
+    large &= leaves;
+
+    canonicalize(small, leaves);
+    canonicalize(large, leaves);
+    EXPECT_TRUE(small == large);
+    EXPECT_EQ(2u, small.count());
+
+    //even splits keep the side without the lowest leaf
+    Consensus::bitset half(4);
+    Consensus::bitset other(4);
+    Consensus::bitset all(4);
+    all.set();
+    half.set(0);
+    half.set(2);
+    other.set(1);
+    other.set(3);
+    canonicalize(half, all);
+    canonicalize(other, all);
+    EXPECT_TRUE(half == other);
+    EXPECT_FALSE(half[0]);
+}
+
+// Distances between small trees, known by hand
+TEST(RobinsonFouldsTest, KnownTreesTest)
+{
+    Locations::LocationManager locationManager;
+    addLocations(locationManager);
+
+    ITreeCollection<ComparedNode> trees;
+    buildTree(trees.addTree(), "A", "B", 2, "C", "D", 3);
+    buildTree(trees.addTree(), "A", "C", 2, "B", "D", 3);
+    buildTree(trees.addTree(), "B", "A", 5, "D", "C", 3);
+
+    RobinsonFoulds<ComparedNode> comparer(locationManager);
+    comparer.setTrees(trees);
+    ASSERT_EQ(3u, comparer.getTreeCount());
+
+    EXPECT_EQ(0u, comparer.distance(0, 0));
+    EXPECT_EQ(4u, comparer.distance(0, 1));
+    EXPECT_EQ(0u, comparer.distance(0, 2));
+    EXPECT_FLOAT_EQ(10.0f, comparer.weightedDistance(0, 1));
+    EXPECT_FLOAT_EQ(3.0f, comparer.weightedDistance(0, 2));
+    EXPECT_FLOAT_EQ(13.0f, comparer.weightedDistance(1, 2));
+
+    Locations::DistanceMatrix unweighted;
+    Locations::DistanceMatrix weighted;
+    comparer.distances(unweighted, weighted);
+    ASSERT_EQ(3u, unweighted.size());
+    EXPECT_FLOAT_EQ(4.0f, unweighted(1, 2));
+    EXPECT_FLOAT_EQ(4.0f, unweighted(2, 1));
+    EXPECT_FLOAT_EQ(0.0f, unweighted(2, 2));
+    EXPECT_FLOAT_EQ(13.0f, weighted(2, 1));
+}
+
+// Leaves unknown by the location manager can not be compared
+TEST(RobinsonFouldsTest, UnknownTaxonTest)
+{
+    Locations::LocationManager locationManager;
+    addLocations(locationManager);
+
+    ITreeCollection<ComparedNode> trees;
+    buildTree(trees.addTree(), "A", "B", 1, "C", "Z", 1);
+
+    RobinsonFoulds<ComparedNode> comparer(locationManager);
+    EXPECT_THROW(comparer.setTrees(trees), ComparisonException);
+}
+
+// The tiled matrix matches the pairwise distances and is a metric
+TEST(RobinsonFouldsTest, GeneratedTreesTest)
+{
+    Locations::LocationManager locationManager;
+    Generator::LocationGenerator().generate(LEAVES, 8, locationManager);
+
+    ITreeCollection<ComparedNode> trees;
+    Generator::TreeGenerator<ComparedNode>(3).generateTrees(trees, Generator::YuleModel, LEAVES, TREES, 2);
+
+    RobinsonFoulds<ComparedNode> comparer(locationManager);
+    comparer.setTrees(trees);
+
+    Locations::DistanceMatrix unweighted;
+    Locations::DistanceMatrix weighted;
+    comparer.distances(unweighted, weighted);
+    ASSERT_EQ(TREES, unweighted.size());
+
+    size_t moved = 0;
+    for (size_t i = 0; i < TREES; i++)
+    {
+        EXPECT_FLOAT_EQ(0.0f, unweighted(i, i));
+        for (size_t j = 0; j < TREES; j++)
+        {
+            EXPECT_FLOAT_EQ(float(comparer.distance(i, j)), unweighted(i, j));
+            EXPECT_FLOAT_EQ(comparer.weightedDistance(i, j), weighted(i, j));
+            EXPECT_FLOAT_EQ(unweighted(i, j), unweighted(j, i));
+            EXPECT_LE(unweighted(i, j), float(2 * (LEAVES - 3)));
+            EXPECT_LE(unweighted(0, j), unweighted(0, i) + unweighted(i, j));
+        }
+        moved += unweighted(0, i) > 0.0f ? 1 : 0;
+    }
+    EXPECT_LT(0u, moved);
+}
+
+// Replicates without moves are all the same tree
+TEST(RobinsonFouldsTest, IdenticalTreesTest)
+{
+    Locations::LocationManager locationManager;
+    Generator::LocationGenerator().generate(LEAVES, 8, locationManager);
+
+    ITreeCollection<ComparedNode> trees;
+    Generator::TreeGenerator<ComparedNode>().generateTrees(trees, Generator::CoalescentModel, LEAVES, 5, 0);
+
+    RobinsonFoulds<ComparedNode> comparer(locationManager);
+    comparer.setTrees(trees);
+
+    for (size_t i = 0; i < 5; i++)
+    {
+        for (size_t j = 0; j < 5; j++)
+        {
+            EXPECT_EQ(0u, comparer.distance(i, j));
+            EXPECT_FLOAT_EQ(0.0f, comparer.weightedDistance(i, j));
+        }
+    }
+}
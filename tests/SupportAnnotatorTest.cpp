@@ -0,0 +1,178 @@
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <gtest/gtest.h>
+
+#include "phylopp/Domain/ITreeCollection.h"
+#include "phylopp/Domain/LocationAspect.h"
+#include "phylopp/Domain/SupportAspect.h"
+#include "phylopp/DataSource/NewickWriter.h"
+#include "phylopp/DataSource/NewickReader.h"
+#include "phylopp/Comparison/SupportAnnotator.h"
+#include "phylopp/Generator/TreeGenerator.h"
+#include "phylopp/Generator/LocationGenerator.h"
+
+using namespace Comparison;
+using namespace Domain;
+using ::testing::Test;
+
+typedef Locations::LocationAspect<Node> SampleNode;
+typedef SupportAspect<Node> SupportedNode;
+typedef SupportAspect<SampleNode> ReadNode;
+
+static const char NEWICK_FILE[] = "supports.nwk";
+
+template <class T>
+static void addLeaf(T* parent, const NodeName& name)
+{
+    T* const leaf = parent->template addChild<T>();
+    leaf->setName(name);
+    leaf->setBranchLength(1);
+}
+
+// Builds ((a,b):2,(c,d):3,E)
+template <class T>
+static void buildTree(ITree<T>* tree, const NodeName& a, const NodeName& b, const NodeName& c, const NodeName& d)
+{
+    T* const root = tree->getRoot();
+    T* const leftChild = root->template addChild<T>();
+    T* const rightChild = root->template addChild<T>();
+
+    leftChild->setBranchLength(2);
+    rightChild->setBranchLength(3);
+    addLeaf(leftChild, a);
+    addLeaf(leftChild, b);
+    addLeaf(rightChild, c);
+    addLeaf(rightChild, d);
+    addLeaf(root, "E");
+}
+
+class SupportAnnotatorTest : public Test
+{
+protected:
+    Locations::LocationManager locationManager;
+    ITreeCollection<SampleNode> trees;
+    ITree<SupportedNode> reference;
+
+    SupportAnnotatorTest() :
+        reference(1)
+    {}
+
+    virtual void SetUp()
+    {
+        const char* const names[] = { "A", "B", "C", "D", "E" };
+        for (size_t i = 0; i < 5; i++)
+            locationManager.addLocation("X", names[i]);
+
+        buildTree(trees.addTree(), "A", "B", "C", "D");
+        buildTree(trees.addTree(), "B", "A", "D", "C");
+        buildTree(trees.addTree(), "A", "C", "B", "D");
+        buildTree(trees.addTree(), "A", "D", "B", "C");
+        buildTree(&reference, "A", "B", "C", "D");
+    }
+
+    std::string referenceNewick()
+    {
+        std::stringstream ss;
+        NewickWriter<SupportedNode> writer;
+        writer.saveNewickTree(ss, &reference);
+        return ss.str();
+    }
+};
+
+// Supports of a small tree, known by hand, written as internal labels
+TEST_F(SupportAnnotatorTest, KnownTreesTest)
+{
+    EXPECT_EQ(std::string::npos, referenceNewick().find("0.5"));
+
+    SupportAnnotator<SupportedNode> annotator(locationManager);
+    annotator.annotate(&reference, trees);
+
+    ListIterator<SupportedNode, Node> it = reference.getRoot()->getChildrenIterator<SupportedNode>();
+    EXPECT_FLOAT_EQ(0.5f, it.get()->getSupport());
+    it.next();
+    EXPECT_FLOAT_EQ(0.5f, it.get()->getSupport());
+    EXPECT_FALSE(reference.getRoot()->hasSupport());
+
+    const std::string newick = referenceNewick();
+    EXPECT_NE(std::string::npos, newick.find("(A:1,B:1)0.5:2"));
+    EXPECT_NE(std::string::npos, newick.find("(C:1,D:1)0.5:3"));
+}
+
+// Named internal nodes keep their names
+TEST_F(SupportAnnotatorTest, NamedNodeTest)
+{
+    reference.getRoot()->getChildrenIterator<SupportedNode>().get()->setName("AB");
+
+    SupportAnnotator<SupportedNode> annotator(locationManager);
+    annotator.annotate(&reference, trees);
+
+    const std::string newick = referenceNewick();
+    EXPECT_NE(std::string::npos, newick.find("(A:1,B:1)AB:2"));
+    EXPECT_NE(std::string::npos, newick.find("(C:1,D:1)0.5:3"));
+}
+
+// Written supports are read back as the supports of the nodes
+TEST_F(SupportAnnotatorTest, RoundTripTest)
+{
+    SupportAnnotator<SupportedNode> annotator(locationManager);
+    annotator.annotate(&reference, trees);
+    const std::string newick = referenceNewick();
+    std::ofstream(NEWICK_FILE) << newick;
+
+    NewickReader<ReadNode> reader(NEWICK_FILE, locationManager);
+    ITree<ReadNode>* const read = reader.next();
+    remove(NEWICK_FILE);
+    ASSERT_TRUE(read != NULL);
+
+    ListIterator<ReadNode, Node> it = read->getRoot()->getChildrenIterator<ReadNode>();
+    EXPECT_FLOAT_EQ(0.5f, it.get()->getSupport());
+    EXPECT_TRUE(it.get()->getName().empty());
+    it.next();
+    EXPECT_FLOAT_EQ(0.5f, it.get()->getSupport());
+    EXPECT_FALSE(read->getRoot()->hasSupport());
+
+    std::stringstream ss;
+    NewickWriter<ReadNode> writer;
+    writer.saveNewickTree(ss, read);
+    EXPECT_EQ(newick, ss.str());
+    delete read;
+}
+
+// Streaming the trees and looking up a table give the same supports
+TEST(SupportAnnotatorGeneratedTest, TableTest)
+{
+    const size_t leaves = 64;
+
+    Locations::LocationManager locationManager;
+    Generator::LocationGenerator().generate(leaves, 8, locationManager);
+
+    ITreeCollection<SampleNode> trees;
+    Generator::TreeGenerator<SampleNode>(9).generateTrees(trees, Generator::YuleModel, leaves, 100, 4);
+
+    ITreeCollection<SupportedNode> references;
+    Generator::TreeGenerator<SupportedNode>(9).generateTrees(references, Generator::YuleModel, leaves, 2, 0);
+
+    SupportAnnotator<SupportedNode> annotator(locationManager);
+    annotator.annotate(references.elementAt(0), trees);
+
+    BipartitionTable table;
+    table.build(trees, locationManager);
+    annotator.annotate(references.elementAt(1), table);
+
+    std::vector<SupportedNode*> streamed;
+    std::vector<SupportedNode*> looked;
+    std::vector<Consensus::bitset> clusters;
+    getClusters<SupportedNode>(references.elementAt(0)->getRoot(), locationManager, streamed, clusters);
+    getClusters<SupportedNode>(references.elementAt(1)->getRoot(), locationManager, looked, clusters);
+    ASSERT_EQ(streamed.size(), looked.size());
+
+    size_t supported = 0;
+    for (size_t i = 1; i < streamed.size(); i++)
+    {
+        EXPECT_EQ(streamed[i]->getSupport(), looked[i]->getSupport());
+        EXPECT_EQ(!streamed[i]->isLeaf(), streamed[i]->hasSupport());
+        supported += streamed[i]->getSupport() > 0.0f ? 1 : 0;
+    }
+    EXPECT_LT(0u, supported);
+}
@@ -0,0 +1,134 @@
+#include <algorithm>
+#include <gtest/gtest.h>
+
+#include "phylopp/Domain/ITreeCollection.h"
+#include "phylopp/Domain/LocationAspect.h"
+#include "phylopp/Consensor/ConsensorAspect.h"
+#include "phylopp/Consensor/StrictConsensor.h"
+#include "phylopp/Consensor/TaxonIndex.h"
+#include "DummyObserver.h"
+
+using namespace Consensus;
+using namespace Domain;
+using ::testing::Test;
+
+typedef ConsensorAspect<Locations::LocationAspect<Node> > SubsetNode;
+typedef StrictConsensor<SubsetNode, DummyObserver<SubsetNode> > SubsetConsensor;
+
+static SubsetNode* addNode(SubsetNode* parent, const char* name)
+{
+    SubsetNode* const node = parent->addChild<SubsetNode>();
+    node->setName(name);
+    node->setBranchLength(1);
+    return node;
+}
+
+// Builds ((a,b),(c,d),e), leaving out the nodes named ""
+static void buildTree(ITree<SubsetNode>* tree, const char* a, const char* b, const char* c, const char* d, const char* e)
+{
+    SubsetNode* const left = addNode(tree->getRoot(), "");
+    SubsetNode* const right = addNode(tree->getRoot(), "");
+    const char* const leftNames[] = { a, b };
+    const char* const rightNames[] = { c, d };
+
+    for (size_t i = 0; i < 2; i++)
+    {
+        if (*leftNames[i] != '\0')
+            addNode(left, leftNames[i]);
+        if (*rightNames[i] != '\0')
+            addNode(right, rightNames[i]);
+    }
+    if (*e != '\0')
+        addNode(tree->getRoot(), e);
+}
+
+class TaxonIndexTest : public Test
+{
+protected:
+    Locations::LocationManager locationManager;
+    ITreeCollection<SubsetNode> trees;
+
+    virtual void SetUp()
+    {
+        const char* const names[] = { "A", "B", "C", "D", "E", "F", "G", "H", "I" };
+        for (size_t i = 0; i < 9; i++)
+            locationManager.addLocation("X", names[i]);
+
+        //only A, B, C and D are in every tree; H and I are in none
+        buildTree(trees.addTree(), "A", "B", "C", "D", "E");
+        buildTree(trees.addTree(), "A", "B", "C", "F", "D");
+        buildTree(trees.addTree(), "A", "G", "C", "", "D");
+        addNode(trees.elementAt(2)->getRoot()->getChildrenIterator<SubsetNode>().get(), "B");
+    }
+};
+
+TEST_F(TaxonIndexTest, MasksTest)
+{
+    TaxonIndex index;
+    index.build(trees, locationManager);
+
+    ASSERT_EQ(7u, index.getTaxonCount());
+    EXPECT_EQ(NO_TAXON, index.getTaxon(locationManager.getNodeNameId("H")));
+    const size_t g = index.getTaxon(locationManager.getNodeNameId("G"));
+    ASSERT_NE(NO_TAXON, g);
+    EXPECT_EQ(locationManager.getNodeNameId("G"), index.getNodeNameId(g));
+
+    EXPECT_EQ(5u, index.getLeafMask(0).count());
+    EXPECT_TRUE(index.getLeafMask(2)[g]);
+    EXPECT_FALSE(index.getLeafMask(0)[g]);
+
+    EXPECT_EQ(4u, index.getCommonLeaves().count());
+    EXPECT_FALSE(index.getCommonLeaves()[g]);
+    EXPECT_TRUE(index.getCommonLeaves()[index.getTaxon(locationManager.getNodeNameId("D"))]);
+}
+
+// The consensus of the common leaves is ((A,B),C,D)
+TEST_F(TaxonIndexTest, CommonLeavesConsensusTest)
+{
+    DummyObserver<SubsetNode> observer;
+    SubsetConsensor consensor;
+    EXPECT_THROW(delete consensor.consensus(trees, observer, locationManager), DisjointTerminalsException);
+
+    TaxonIndex index;
+    ITree<SubsetNode>* const consensed = consensor.commonLeavesConsensus(trees, observer, locationManager, index);
+    SubsetNode* const root = consensed->getRoot();
+
+    EXPECT_EQ(7u, root->cluster.size());
+    EXPECT_EQ(4u, root->cluster.count());
+
+    ListIterator<SubsetNode, Node> it = root->getChildrenIterator<SubsetNode>();
+    ASSERT_EQ(3u, it.count());
+    std::vector<std::string> names;
+    for (; !it.end(); it.next())
+    {
+        if (it.get()->isLeaf())
+        {
+            names.push_back(it.get()->getName());
+        }
+        else
+        {
+            EXPECT_EQ(2u, it.get()->cluster.count());
+            ListIterator<SubsetNode, Node> leaves = it.get()->getChildrenIterator<SubsetNode>();
+            for (; !leaves.end(); leaves.next())
+                names.push_back(leaves.get()->getName());
+        }
+    }
+    std::sort(names.begin(), names.end());
+    ASSERT_EQ(4u, names.size());
+    EXPECT_EQ("A", names[0]);
+    EXPECT_EQ("B", names[1]);
+    EXPECT_EQ("C", names[2]);
+    EXPECT_EQ("D", names[3]);
+
+    delete consensed;
+}
+
+TEST_F(TaxonIndexTest, DisjointTreesTest)
+{
+    buildTree(trees.addTree(), "H", "I", "", "", "");
+
+    DummyObserver<SubsetNode> observer;
+    SubsetConsensor consensor;
+    TaxonIndex index;
+    EXPECT_THROW(consensor.commonLeavesConsensus(trees, observer, locationManager, index), DisjointTerminalsException);
+}
@@ -174,3 +174,80 @@ TEST(bitsetTest, classBooleanOpTests)
     EXPECT_TRUE(b == b);
     EXPECT_FALSE(b != b);
 }
+
+// Compares against a vector<bool> model, across word boundaries
+TEST(bitsetTest, wordBoundaryTest)
+{
+    const size_t size = 150;
+    bitset b(size);
+    std::vector<bool> model(size, false);
+
+    for (size_t i = 0; i < size; i += 7)
+    {
+        b.set(i);
+        model[i] = true;
+    }
+    b.set(60, 70);
+    b.flip(120, 149);
+    b.reset(62, 63);
+    for (size_t i = 60; i <= 70; i++)
+        model[i] = true;
+    for (size_t i = 120; i <= 149; i++)
+        model[i] = !model[i];
+    model[62] = model[63] = false;
+
+    size_t expectedCount = 0;
+    for (size_t i = 0; i < size; i++)
+    {
+        EXPECT_EQ(model[i], bool(b[i]));
+        expectedCount += model[i] ? 1 : 0;
+    }
+    EXPECT_EQ(expectedCount, b.count());
+
+    const size_t shifts[] = {1, 63, 64, 65, 130};
+    for (size_t s = 0; s < 5; s++)
+    {
+        const bitset left = b << shifts[s];
+        const bitset right = b >> shifts[s];
+        for (size_t i = 0; i < size; i++)
+        {
+            EXPECT_EQ(i + shifts[s] < size && model[i + shifts[s]], bool(left[i]));
+            EXPECT_EQ(i >= shifts[s] && model[i - shifts[s]], bool(right[i]));
+        }
+    }
+
+    EXPECT_EQ(size - expectedCount, (~b).count());
+    EXPECT_EQ(size, bitset(b).set().count());
+}
+
+TEST(bitsetTest, countHashOrderTest)
+{
+    bitset a(100);
+    bitset b(100);
+    a.set(3);
+    a.set(90);
+    b.set(3);
+    b.set(90);
+
+    EXPECT_EQ(2u, a.count());
+    EXPECT_EQ(a.hash(), b.hash());
+    EXPECT_FALSE(a < b);
+
+    b.set(89);
+    EXPECT_NE(a.hash(), b.hash());
+    EXPECT_TRUE(a.isSubsetOf(b));
+    EXPECT_FALSE(b.isSubsetOf(a));
+    //index 0 is the most significant bit
+    EXPECT_TRUE(a < b);
+    a.set(0);
+    EXPECT_TRUE(b < a);
+
+    bitset c(70);
+    EXPECT_ANY_THROW(a == c);
+    EXPECT_ANY_THROW(a.isSubsetOf(c));
+
+    c.resize(130, bitset::bit::true_bit);
+    EXPECT_EQ(60u, c.count());
+    c.resize(100);
+    EXPECT_EQ(30u, c.count());
+}
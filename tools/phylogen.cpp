@@ -0,0 +1,141 @@
+/*
+    Copyright (C) 2011 Emmanuel Teisaire, Nicolás Bombau, Carlos Castro, Damián Domé, FuDePAN
+
+    This file is part of the Phyloloc project.
+
+    Phyloloc is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Phyloloc is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Phyloloc.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <string>
+#include <iostream>
+#include "phylopp/Domain/INode.h"
+#include "phylopp/Generator/TreeGenerator.h"
+#include "phylopp/Generator/LocationGenerator.h"
+
+/**
+* phylogen: writes a synthetic dataset for scale testing.
+* Given an output prefix, it writes prefix.nwk with the trees,
+* prefix.locations with the location of every leaf and prefix.distances
+* with the distances between locations.
+*/
+
+static void usage()
+{
+    std::cerr << "usage: phylogen [-m model] [-n leaves] [-t replicates] [-k moves]"
+              << " [-l locations] [-s seed] prefix\n"
+              << "  -m  yule, coalescent, caterpillar or balanced (default yule)\n"
+              << "  -n  leaves per tree (default 100)\n"
+              << "  -t  trees, each perturbed by its own SPR moves (default 1)\n"
+              << "  -k  random SPR moves per tree (default 0)\n"
+              << "  -l  locations (default 10)\n"
+              << "  -s  random seed (default 1)\n";
+}
+
+static bool parseModel(const std::string& name, Generator::TreeModel& model)
+{
+    bool valid = true;
+
+    if (name == "yule")
+        model = Generator::YuleModel;
+    else if (name == "coalescent")
+        model = Generator::CoalescentModel;
+    else if (name == "caterpillar")
+        model = Generator::CaterpillarModel;
+    else if (name == "balanced")
+        model = Generator::BalancedModel;
+    else
+        valid = false;
+
+    return valid;
+}
+
+static bool parseSize(const char* text, size_t& value)
+{
+    char* end;
+    const unsigned long parsed = strtoul(text, &end, 10);
+    value = parsed;
+    return *text != '\0' && *end == '\0';
+}
+
+int main(int argc, char* argv[])
+{
+    Generator::TreeModel model = Generator::YuleModel;
+    size_t leaves = 100;
+    size_t replicates = 1;
+    size_t sprMoves = 0;
+    size_t locations = 10;
+    size_t seed = Generator::DEFAULT_SEED;
+    bool valid = true;
+    int option;
+
+    while ((option = getopt(argc, argv, "m:n:t:k:l:s:")) != -1)
+    {
+        switch (option)
+        {
+            case 'm':
+                valid = valid && parseModel(optarg, model);
+                break;
+            case 'n':
+                valid = valid && parseSize(optarg, leaves);
+                break;
+            case 't':
+                valid = valid && parseSize(optarg, replicates);
+                break;
+            case 'k':
+                valid = valid && parseSize(optarg, sprMoves);
+                break;
+            case 'l':
+                valid = valid && parseSize(optarg, locations);
+                break;
+            case 's':
+                valid = valid && parseSize(optarg, seed);
+                break;
+            default:
+                valid = false;
+                break;
+        }
+    }
+
+    int status = EXIT_SUCCESS;
+
+    if (!valid || optind + 1 != argc)
+    {
+        usage();
+        status = EXIT_FAILURE;
+    }
+    else
+    {
+        const std::string prefix = argv[optind];
+
+        try
+        {
+            //trees and locations draw from separate generators, so
+            //the locations do not depend on the tree options
+            Generator::LocationGenerator locationGenerator(seed);
+            locationGenerator.saveFiles(prefix + ".locations", prefix + ".distances", leaves, locations);
+
+            Generator::TreeGenerator<Domain::Node> treeGenerator(seed);
+            treeGenerator.saveTrees(prefix + ".nwk", model, leaves, replicates, sprMoves);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "phylogen: " << e.what() << "\n";
+            status = EXIT_FAILURE;
+        }
+    }
+
+    return status;
+}